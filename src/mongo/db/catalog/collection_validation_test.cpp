@@ -33,10 +33,13 @@
 
 #include "mongo/db/catalog/catalog_test_fixture.h"
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/max_validate_mb_per_sec_gen.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_descriptor.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -255,6 +258,70 @@ TEST_F(BackgroundCollectionValidationTest, BackgroundValidateError) {
                        /*runForegroundAsWell*/ true);
 }
 
+// Verify that validate() agrees with itself whether or not the document keys of different indexes
+// are added on several threads.
+TEST_F(CollectionValidationTest, ValidateWithIndexThreads) {
+    auto opCtx = operationContext();
+    {
+        AutoGetCollection autoColl(opCtx, kNss, MODE_X);
+        auto indexCatalog = autoColl.getCollection()->getIndexCatalog();
+        WriteUnitOfWork wuow(opCtx);
+        for (auto&& [name, key] : std::vector<std::pair<std::string, BSONObj>>{
+                 {"a_1", BSON("a" << 1)},
+                 {"b_-1", BSON("b" << -1)},
+                 {"a_1_c_1", BSON("a" << 1 << "c" << 1)},
+                 {"c_hashed", BSON("c"
+                                   << "hashed")}}) {
+            auto spec = BSON("v" << int(IndexDescriptor::kLatestIndexVersion) << "key" << key
+                                 << "name" << name);
+            ASSERT_OK(indexCatalog->createIndexOnEmptyCollection(opCtx, spec).getStatus());
+        }
+        wuow.commit();
+    }
+
+    // Insert more documents than fit in one batch, with an array to make a_1 multikey.
+    const int numRecords = 2500;
+    {
+        AutoGetCollection autoColl(opCtx, kNss, MODE_IX);
+        std::vector<InsertStatement> inserts;
+        for (int i = 0; i < numRecords; ++i) {
+            inserts.push_back(InsertStatement(BSON("_id" << i << "a" << BSON_ARRAY(i << i + 1)
+                                                         << "b" << -i << "c"
+                                                         << std::to_string(i))));
+        }
+        WriteUnitOfWork wuow(opCtx);
+        ASSERT_OK(autoColl.getCollection()->insertDocuments(
+            opCtx, inserts.begin(), inserts.end(), nullptr, false));
+        wuow.commit();
+    }
+
+    const int originalThreads = gMaxValidateIndexThreads.load();
+    ON_BLOCK_EXIT([&] { gMaxValidateIndexThreads.store(originalThreads); });
+
+    std::vector<BSONObj> keysPerIndex;
+    for (int threads : {1, 4}) {
+        gMaxValidateIndexThreads.store(threads);
+        foregroundValidate(opCtx,
+                           /*valid*/ true,
+                           /*numRecords*/ numRecords,
+                           /*numInvalidDocuments*/ 0,
+                           /*numErrors*/ 0);
+
+        ValidateResults validateResults;
+        BSONObjBuilder output;
+        ASSERT_OK(
+            CollectionValidation::validate(opCtx,
+                                           kNss,
+                                           CollectionValidation::ValidateOptions::kFullValidation,
+                                           /*background*/ false,
+                                           &validateResults,
+                                           &output));
+        keysPerIndex.push_back(output.obj()["keysPerIndex"].Obj().getOwned());
+    }
+    ASSERT_BSONOBJ_EQ(keysPerIndex[0], keysPerIndex[1]);
+    ASSERT_EQ(keysPerIndex[0]["a_1"].numberLong(), 2 * numRecords);
+}
+
 /**
  * Waits for a parallel running collection validation operation to start and then hang at a
  * failpoint.
@@ -1370,6 +1370,10 @@ Status IndexCatalogImpl::_indexFilteredRecords(OperationContext* opCtx,
     InsertDeleteOptions options;
     prepareInsertDeleteOptions(opCtx, index->descriptor(), &options);
 
+    if (bsonRecords.size() > 1 && !index->isHybridBuilding() && !index->descriptor()->unique()) {
+        return _indexFilteredRecordsBatched(opCtx, index, bsonRecords, options, keysInsertedOut);
+    }
+
     for (auto bsonRecord : bsonRecords) {
         invariant(bsonRecord.id != RecordId());
 
@@ -1409,6 +1413,46 @@ Status IndexCatalogImpl::_indexFilteredRecords(OperationContext* opCtx,
     return Status::OK();
 }
 
+Status IndexCatalogImpl::_indexFilteredRecordsBatched(OperationContext* opCtx,
+                                                      IndexCatalogEntry* index,
+                                                      const std::vector<BsonRecord>& bsonRecords,
+                                                      const InsertDeleteOptions& options,
+                                                      int64_t* keysInsertedOut) {
+    // Records inserted at different timestamps cannot share a write, so batch each run of records
+    // with the same timestamp. Only a multi-document insert on a primary assigns every record its
+    // own timestamp.
+    auto groupBegin = bsonRecords.begin();
+    while (groupBegin != bsonRecords.end()) {
+        auto groupEnd = std::find_if(groupBegin, bsonRecords.end(), [&](const BsonRecord& record) {
+            return record.ts != groupBegin->ts;
+        });
+
+        if (!groupBegin->ts.isNull()) {
+            Status status = opCtx->recoveryUnit()->setTimestamp(groupBegin->ts);
+            if (!status.isOK())
+                return status;
+        }
+
+        std::vector<BsonRecord> group(groupBegin, groupEnd);
+        for (const auto& bsonRecord : group) {
+            invariant(bsonRecord.id != RecordId());
+        }
+
+        int64_t numInserted = 0;
+        Status status = index->accessMethod()->insertRecords(opCtx, group, options, &numInserted);
+        if (!status.isOK()) {
+            return status;
+        }
+        if (keysInsertedOut) {
+            *keysInsertedOut += numInserted;
+        }
+
+        groupBegin = groupEnd;
+    }
+
+    return Status::OK();
+}
+
 Status IndexCatalogImpl::_indexRecords(OperationContext* opCtx,
                                        IndexCatalogEntry* index,
                                        const std::vector<BsonRecord>& bsonRecords,
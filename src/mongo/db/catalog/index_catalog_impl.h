@@ -321,6 +321,16 @@ private:
                                  const std::vector<BsonRecord>& bsonRecords,
                                  int64_t* keysInsertedOut);
 
+    /**
+     * Inserts the keys of 'bsonRecords' into a non-unique index which is not being built, sorting
+     * the keys of records sharing a timestamp and inserting them together.
+     */
+    Status _indexFilteredRecordsBatched(OperationContext* opCtx,
+                                        IndexCatalogEntry* index,
+                                        const std::vector<BsonRecord>& bsonRecords,
+                                        const InsertDeleteOptions& options,
+                                        int64_t* keysInsertedOut);
+
     Status _indexRecords(OperationContext* opCtx,
                          IndexCatalogEntry* index,
                          const std::vector<BsonRecord>& bsonRecords,
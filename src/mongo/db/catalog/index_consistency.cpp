@@ -273,6 +273,21 @@ void IndexConsistency::addIndexKey(const KeyString::Value& ks,
     }
 }
 
+void IndexConsistency::addDocKeyDeferred(const KeyString::Value& ks,
+                                         IndexInfo* indexInfo,
+                                         std::vector<uint32_t>* buckets) {
+    invariant(_firstPhase);
+    buckets->push_back(_hashKeyString(ks, indexInfo->indexNameHash));
+    indexInfo->numRecords++;
+}
+
+void IndexConsistency::incrementBuckets(const std::vector<uint32_t>& buckets) {
+    invariant(_firstPhase);
+    for (auto bucket : buckets) {
+        _indexKeyCount[bucket]++;
+    }
+}
+
 BSONObj IndexConsistency::_generateInfo(const IndexInfo& indexInfo,
                                         RecordId recordId,
                                         const BSONObj& indexKey,
@@ -93,6 +93,21 @@ public:
      */
     void addIndexKey(const KeyString::Value& ks, IndexInfo* indexInfo, RecordId recordId);
 
+    /**
+     * First phase only. Like addDocKey(), but instead of incrementing the document key's hash
+     * bucket, appends the bucket to 'buckets' for a later call to incrementBuckets(). Document keys
+     * for different indexes may be added this way from several threads at once, as long as no two
+     * threads add keys for the same index.
+     */
+    void addDocKeyDeferred(const KeyString::Value& ks,
+                           IndexInfo* indexInfo,
+                           std::vector<uint32_t>* buckets);
+
+    /**
+     * Increments the hash buckets collected by addDocKeyDeferred().
+     */
+    void incrementBuckets(const std::vector<uint32_t>& buckets);
+
     /**
      * To validate $** multikey metadata paths, we first scan the collection and add a hash of all
      * multikey paths encountered to a set. We then scan the index for multikey metadata path
@@ -125,6 +140,10 @@ public:
      */
     void setSecondPhase();
 
+    bool isFirstPhase() const {
+        return _firstPhase;
+    }
+
     /**
      * Records the errors gathered from the second phase of index validation into the provided
      * ValidateResultsMap and ValidateResults.
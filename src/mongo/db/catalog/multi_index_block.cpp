@@ -454,6 +454,39 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
         _method != IndexBuildMethod::kBackground && useReadOnceCursorsForIndexBuilds.load();
     opCtx->recoveryUnit()->setReadOnce(readOnce);
 
+    // Foreground and hybrid builds write keys to the external sorter rather than to the index, so
+    // they cannot write conflict. They buffer documents and generate keys for a batch of them on
+    // several threads.
+    const bool useBatches =
+        _method != IndexBuildMethod::kBackground && indexBuildKeyGenerationThreads.load() > 1;
+    std::vector<std::pair<RecordId, BSONObj>> batch;
+    size_t batchBytes = 0;
+    auto flushBatch = [&]() -> Status {
+        if (batch.empty()) {
+            return Status::OK();
+        }
+
+        std::vector<BsonRecord> records;
+        records.reserve(batch.size());
+        for (const auto& [id, obj] : batch) {
+            records.push_back({id, Timestamp(), &obj});
+        }
+
+        WriteUnitOfWork wunit(opCtx);
+        Status ret = _insertBatch(opCtx, records);
+        if (!ret.isOK()) {
+            return ret;
+        }
+        wunit.commit();
+
+        for (const auto& [id, obj] : batch) {
+            failPointHangDuringBuild(&hangAfterIndexBuildOf, "after", obj);
+        }
+        batch.clear();
+        batchBytes = 0;
+        return Status::OK();
+    };
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -483,6 +516,26 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
 
             failPointHangDuringBuild(&hangBeforeIndexBuildOf, "before", objToIndex.value());
 
+            if (useBatches) {
+                batchBytes += objToIndex.value().objsize();
+                batch.emplace_back(loc, objToIndex.value().getOwned());
+                // While 'hangAfterIndexBuildOf' is enabled, flush after every document so that the
+                // build hangs before the next document is scanned, as it does without batching.
+                if (batch.size() >= IndexAccessMethod::kMaxKeyGenerationBatchDocs ||
+                    batchBytes >= IndexAccessMethod::kMaxKeyGenerationBatchBytes ||
+                    MONGO_unlikely(hangAfterIndexBuildOf.shouldFail())) {
+                    Status ret = flushBatch();
+                    if (!ret.isOK()) {
+                        return ret;
+                    }
+                }
+
+                progress->hit();
+                n++;
+                retries = 0;
+                continue;
+            }
+
             WriteUnitOfWork wunit(opCtx);
             Status ret = insert(opCtx, objToIndex.value(), loc);
             if (_method == IndexBuildMethod::kBackground)
@@ -531,6 +584,13 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
         return exec->getMemberObjectStatus(objToIndex.value());
     }
 
+    {
+        Status ret = flushBatch();
+        if (!ret.isOK()) {
+            return ret;
+        }
+    }
+
     if (MONGO_unlikely(leaveIndexBuildUnfinishedForShutdown.shouldFail())) {
         LOGV2(20389,
               "Index build interrupted due to 'leaveIndexBuildUnfinishedForShutdown' failpoint. "
@@ -605,6 +665,50 @@ Status MultiIndexBlock::insert(OperationContext* opCtx, const BSONObj& doc, cons
     return Status::OK();
 }
 
+Status MultiIndexBlock::_insertBatch(OperationContext* opCtx,
+                                     const std::vector<BsonRecord>& records) {
+    if (State::kAborted == _getState()) {
+        return {ErrorCodes::IndexBuildAborted,
+                str::stream() << "Index build aborted: " << _abortReason};
+    }
+
+    const size_t numThreads = indexBuildKeyGenerationThreads.load();
+    for (size_t i = 0; i < _indexes.size(); i++) {
+        std::vector<BsonRecord> filtered;
+        const std::vector<BsonRecord>* toInsert = &records;
+        if (_indexes[i].filterExpression) {
+            for (const auto& record : records) {
+                if (_indexes[i].filterExpression->matchesBSON(*record.docPtr)) {
+                    filtered.push_back(record);
+                }
+            }
+            toInsert = &filtered;
+        }
+
+        if (_indexes[i].bulk) {
+            // Key generation may throw on a helper thread, and the Sorter may throw on file I/O.
+            try {
+                Status idxStatus = _indexes[i].bulk->insertBatch(
+                    opCtx, *toInsert, _indexes[i].options, numThreads);
+                if (!idxStatus.isOK())
+                    return idxStatus;
+            } catch (...) {
+                return exceptionToStatus();
+            }
+            continue;
+        }
+
+        for (const auto& record : *toInsert) {
+            InsertResult result;
+            Status idxStatus = _indexes[i].real->insert(
+                opCtx, *record.docPtr, record.id, _indexes[i].options, &result);
+            if (!idxStatus.isOK())
+                return idxStatus;
+        }
+    }
+    return Status::OK();
+}
+
 Status MultiIndexBlock::dumpInsertsFromBulk(OperationContext* opCtx) {
     return dumpInsertsFromBulk(opCtx, nullptr);
 }
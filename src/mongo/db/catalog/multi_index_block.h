@@ -338,6 +338,14 @@ private:
         InsertDeleteOptions options;
     };
 
+    /**
+     * Inserts a batch of documents into the indexes being built. Bulk builders generate the keys
+     * for the batch on up to 'indexBuildKeyGenerationThreads' threads.
+     *
+     * Should be called inside of a WriteUnitOfWork.
+     */
+    Status _insertBatch(OperationContext* opCtx, const std::vector<BsonRecord>& records);
+
     /**
      * Returns the current state.
      */
@@ -31,12 +31,21 @@
 
 #include "mongo/db/catalog/multi_index_block.h"
 
+#include "mongo/db/catalog/catalog_test_fixture.h"
 #include "mongo/db/catalog/collection_mock.h"
+#include "mongo/db/catalog/collection_validation.h"
+#include "mongo/db/catalog/index_build_block.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog/index_catalog_noop.h"
+#include "mongo/db/catalog/multi_index_block_gen.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/service_context_test_fixture.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -258,5 +267,181 @@ TEST_F(MultiIndexBlockTest, CommitFailsAfterAbort) {
     ASSERT_FALSE(indexer->isCommitted());
 }
 
+/**
+ * Test fixture for building indexes on a real collection with the ephemeralForTest storage engine.
+ */
+class MultiIndexBlockCollectionTest : public CatalogTestFixture {
+protected:
+    const NamespaceString kNss = NamespaceString("test.t");
+
+    void setUp() override {
+        CatalogTestFixture::setUp();
+        ASSERT_OK(storageInterface()->createCollection(operationContext(), kNss, {}));
+    }
+
+    /**
+     * Inserts 'numRecords' documents, each with an array in 'a' so that indexes on 'a' are
+     * multikey.
+     */
+    void insertDocuments(int numRecords) {
+        AutoGetCollection autoColl(operationContext(), kNss, MODE_IX);
+        std::vector<InsertStatement> inserts;
+        for (int i = 0; i < numRecords; ++i) {
+            inserts.push_back(InsertStatement(BSON("_id" << i << "a" << BSON_ARRAY(i << i + 1))));
+        }
+        WriteUnitOfWork wuow(operationContext());
+        ASSERT_OK(autoColl.getCollection()->insertDocuments(
+            operationContext(), inserts.begin(), inserts.end(), nullptr, false));
+        wuow.commit();
+    }
+
+    /**
+     * Builds the index described by 'spec' with a collection scan.
+     */
+    void buildIndex(const BSONObj& spec) {
+        auto opCtx = operationContext();
+        AutoGetCollection autoColl(opCtx, kNss, MODE_X);
+        auto collection = autoColl.getCollection();
+
+        MultiIndexBlock indexer;
+        ON_BLOCK_EXIT([&] {
+            indexer.cleanUpAfterBuild(opCtx, collection, MultiIndexBlock::kNoopOnCleanUpFn);
+        });
+
+        ASSERT_OK(
+            indexer.init(opCtx, collection, spec, MultiIndexBlock::kNoopOnInitFn).getStatus());
+        ASSERT_OK(indexer.insertAllDocumentsInCollection(opCtx, collection));
+        ASSERT_OK(indexer.checkConstraints(opCtx));
+
+        WriteUnitOfWork wunit(opCtx);
+        ASSERT_OK(indexer.commit(opCtx,
+                                 collection,
+                                 MultiIndexBlock::kNoopOnCreateEachFn,
+                                 MultiIndexBlock::kNoopOnCommitFn));
+        wunit.commit();
+    }
+};
+
+/**
+ * Drains the keys added to 'bulk', in sorted order.
+ */
+std::vector<KeyString::Value> drainKeys(IndexAccessMethod::BulkBuilder* bulk) {
+    std::unique_ptr<IndexAccessMethod::BulkBuilder::Sorter::Iterator> it(bulk->done());
+    std::vector<KeyString::Value> keys;
+    while (it->more()) {
+        keys.push_back(it->next().first);
+    }
+    return keys;
+}
+
+TEST_F(MultiIndexBlockCollectionTest, InsertBatchGeneratesTheSameKeysAsInsert) {
+    auto opCtx = operationContext();
+    AutoGetCollection autoColl(opCtx, kNss, MODE_X);
+    auto collection = autoColl.getCollection();
+    auto indexCatalog = collection->getIndexCatalog();
+
+    for (auto&& [name, key] :
+         std::vector<std::pair<std::string, BSONObj>>{{"a_1", BSON("a" << 1)},
+                                                      {"_id_hashed",
+                                                       BSON("_id"
+                                                            << "hashed")}}) {
+        auto spec = BSON("v" << int(IndexDescriptor::kLatestIndexVersion) << "key" << key << "name"
+                             << name);
+        IndexBuildBlock indexBuildBlock(
+            indexCatalog, collection->ns(), spec, IndexBuildMethod::kHybrid, UUID::gen());
+        {
+            WriteUnitOfWork wuow(opCtx);
+            ASSERT_OK(indexBuildBlock.init(opCtx, collection));
+            wuow.commit();
+        }
+        ON_BLOCK_EXIT([&] {
+            WriteUnitOfWork wuow(opCtx);
+            indexBuildBlock.fail(opCtx, collection);
+            wuow.commit();
+            indexBuildBlock.deleteTemporaryTables(opCtx);
+        });
+
+        auto accessMethod = indexBuildBlock.getEntry()->accessMethod();
+        ASSERT(accessMethod->canGenerateKeysConcurrently());
+
+        InsertDeleteOptions options;
+        indexCatalog->prepareInsertDeleteOptions(
+            opCtx, indexBuildBlock.getEntry()->descriptor(), &options);
+
+        // More documents than threads, in a number that does not divide evenly between them.
+        std::vector<BSONObj> docs;
+        std::vector<BsonRecord> records;
+        for (int i = 0; i < 103; ++i) {
+            docs.push_back(BSON("_id" << i << "a" << BSON_ARRAY(i << i + 1)));
+        }
+        for (size_t i = 0; i < docs.size(); ++i) {
+            records.push_back({RecordId(i + 1), Timestamp(), &docs[i]});
+        }
+
+        const size_t memoryUsageBytes = 1024 * 1024;
+        auto serial = accessMethod->initiateBulk(memoryUsageBytes);
+        for (const auto& record : records) {
+            ASSERT_OK(serial->insert(opCtx, *record.docPtr, record.id, options));
+        }
+
+        auto batched = accessMethod->initiateBulk(memoryUsageBytes);
+        ASSERT_OK(batched->insertBatch(opCtx, records, options, 4));
+
+        ASSERT_EQ(serial->isMultikey(), batched->isMultikey());
+        ASSERT(serial->getMultikeyPaths() == batched->getMultikeyPaths());
+        ASSERT_EQ(serial->getKeysInserted(), batched->getKeysInserted());
+
+        auto serialKeys = drainKeys(serial.get());
+        auto batchedKeys = drainKeys(batched.get());
+        ASSERT_EQ(serialKeys.size(), batchedKeys.size());
+        for (size_t i = 0; i < serialKeys.size(); ++i) {
+            ASSERT_EQ(0, serialKeys[i].compare(batchedKeys[i])) << name << " key " << i;
+        }
+    }
+}
+
+// Verify that an index built by scanning the collection in batches, with keys generated on several
+// threads, has the same keys as one built a document at a time.
+TEST_F(MultiIndexBlockCollectionTest, InsertAllDocumentsInBatchesBuildsTheSameIndex) {
+    // More documents than fit in one batch.
+    const int numRecords = 2500;
+    insertDocuments(numRecords);
+
+    const int originalThreads = indexBuildKeyGenerationThreads.load();
+    ON_BLOCK_EXIT([&] { indexBuildKeyGenerationThreads.store(originalThreads); });
+
+    indexBuildKeyGenerationThreads.store(1);
+    buildIndex(BSON("v" << int(IndexDescriptor::kLatestIndexVersion) << "key" << BSON("a" << 1)
+                        << "name"
+                        << "a_1"));
+
+    indexBuildKeyGenerationThreads.store(4);
+    buildIndex(BSON("v" << int(IndexDescriptor::kLatestIndexVersion) << "key" << BSON("a" << -1)
+                        << "name"
+                        << "a_-1"));
+
+    ValidateResults validateResults;
+    BSONObjBuilder output;
+    ASSERT_OK(CollectionValidation::validate(operationContext(),
+                                             kNss,
+                                             CollectionValidation::ValidateOptions::kFullValidation,
+                                             /*background*/ false,
+                                             &validateResults,
+                                             &output));
+    ASSERT(validateResults.valid);
+
+    auto keysPerIndex = output.obj()["keysPerIndex"].Obj();
+    ASSERT_EQ(keysPerIndex["a_1"].numberLong(), 2 * numRecords);
+    ASSERT_EQ(keysPerIndex["a_-1"].numberLong(), 2 * numRecords);
+
+    AutoGetCollection autoColl(operationContext(), kNss, MODE_IS);
+    auto indexCatalog = autoColl.getCollection()->getIndexCatalog();
+    for (auto name : {"a_1", "a_-1"}) {
+        auto descriptor = indexCatalog->findIndexByName(operationContext(), name);
+        ASSERT(descriptor);
+        ASSERT(indexCatalog->isMultikey(descriptor)) << name;
+    }
+}
+
 }  // namespace
 }  // namespace mongo
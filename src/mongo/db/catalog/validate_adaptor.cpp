@@ -37,6 +37,7 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog/index_consistency.h"
+#include "mongo/db/catalog/max_validate_mb_per_sec_gen.h"
 #include "mongo/db/catalog/throttle_cursor.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/index/index_access_method.h"
@@ -64,17 +65,8 @@ Status ValidateAdaptor::validateRecord(OperationContext* opCtx,
                                        const RecordData& record,
                                        size_t* dataSize) {
     BSONObj recordBson;
-    try {
-        recordBson = record.toBson();
-    } catch (...) {
-        return exceptionToStatus();
-    }
-
-    const Status status = validateBSON(
-        recordBson.objdata(), recordBson.objsize(), Validator<BSONObj>::enabledBSONVersion());
-    if (status.isOK()) {
-        *dataSize = recordBson.objsize();
-    } else {
+    Status status = _validateBSON(record, &recordBson, dataSize);
+    if (!status.isOK()) {
         return status;
     }
 
@@ -84,60 +76,164 @@ Status ValidateAdaptor::validateRecord(OperationContext* opCtx,
     }
 
     for (const auto& index : _validateState->getIndexes()) {
-        const IndexDescriptor* descriptor = index->descriptor();
-        const IndexAccessMethod* iam = index->accessMethod();
-
-        if (descriptor->isPartial()) {
-            const IndexCatalogEntry* ice = indexCatalog->getEntry(descriptor);
-            if (!ice->getFilterExpression()->matchesBSON(recordBson)) {
-                continue;
-            }
+        status = _addDocKeys(opCtx, index.get(), recordId, recordBson, nullptr);
+        if (!status.isOK()) {
+            return status;
         }
+    }
+    return status;
+}
+
+Status ValidateAdaptor::_validateBSON(const RecordData& record,
+                                      BSONObj* recordBson,
+                                      size_t* dataSize) {
+    try {
+        *recordBson = record.toBson();
+    } catch (...) {
+        return exceptionToStatus();
+    }
+
+    const Status status = validateBSON(
+        recordBson->objdata(), recordBson->objsize(), Validator<BSONObj>::enabledBSONVersion());
+    if (status.isOK()) {
+        *dataSize = recordBson->objsize();
+    }
+    return status;
+}
+
+Status ValidateAdaptor::_addDocKeys(OperationContext* opCtx,
+                                    const IndexCatalogEntry* index,
+                                    const RecordId& recordId,
+                                    const BSONObj& recordBson,
+                                    DeferredIndexUpdates* deferred) {
+    const IndexDescriptor* descriptor = index->descriptor();
+    const IndexAccessMethod* iam = index->accessMethod();
+
+    if (descriptor->isPartial() && !index->getFilterExpression()->matchesBSON(recordBson)) {
+        return Status::OK();
+    }
 
-        KeyStringSet documentKeySet;
-        KeyStringSet multikeyMetadataKeys;
-        MultikeyPaths multikeyPaths;
-        iam->getKeys(recordBson,
-                     IndexAccessMethod::GetKeysMode::kEnforceConstraints,
-                     IndexAccessMethod::GetKeysContext::kReadOrAddKeys,
-                     &documentKeySet,
-                     &multikeyMetadataKeys,
-                     &multikeyPaths,
-                     recordId,
-                     IndexAccessMethod::kNoopOnSuppressedErrorFn);
-
-        if (!descriptor->isMultikey() &&
-            iam->shouldMarkIndexAsMultikey(
-                documentKeySet.size(),
-                {multikeyMetadataKeys.begin(), multikeyMetadataKeys.end()},
-                multikeyPaths)) {
-            std::string msg = str::stream()
-                << "Index " << descriptor->indexName() << " is not multi-key but has more than one"
-                << " key in document " << recordId;
+    KeyStringSet documentKeySet;
+    KeyStringSet multikeyMetadataKeys;
+    MultikeyPaths multikeyPaths;
+    iam->getKeys(recordBson,
+                 IndexAccessMethod::GetKeysMode::kEnforceConstraints,
+                 IndexAccessMethod::GetKeysContext::kReadOrAddKeys,
+                 &documentKeySet,
+                 &multikeyMetadataKeys,
+                 &multikeyPaths,
+                 recordId,
+                 IndexAccessMethod::kNoopOnSuppressedErrorFn);
+
+    if (!descriptor->isMultikey() &&
+        iam->shouldMarkIndexAsMultikey(documentKeySet.size(),
+                                       {multikeyMetadataKeys.begin(), multikeyMetadataKeys.end()},
+                                       multikeyPaths)) {
+        std::string msg = str::stream()
+            << "Index " << descriptor->indexName() << " is not multi-key but has more than one"
+            << " key in document " << recordId;
+        if (deferred) {
+            deferred->errors.push_back(msg);
+        } else {
             ValidateResults& curRecordResults = (*_indexNsResultsMap)[descriptor->indexName()];
             curRecordResults.errors.push_back(msg);
             curRecordResults.valid = false;
         }
+    }
 
-        IndexInfo& indexInfo = _indexConsistency->getIndexInfo(descriptor->indexName());
-        for (const auto& keyString : multikeyMetadataKeys) {
-            try {
-                _indexConsistency->addMultikeyMetadataPath(keyString, &indexInfo);
-            } catch (...) {
-                return exceptionToStatus();
-            }
+    IndexInfo& indexInfo = _indexConsistency->getIndexInfo(descriptor->indexName());
+    for (const auto& keyString : multikeyMetadataKeys) {
+        try {
+            _indexConsistency->addMultikeyMetadataPath(keyString, &indexInfo);
+        } catch (...) {
+            return exceptionToStatus();
         }
+    }
 
-        for (const auto& keyString : documentKeySet) {
-            try {
+    for (const auto& keyString : documentKeySet) {
+        try {
+            if (deferred) {
+                deferred->numKeys++;
+                _indexConsistency->addDocKeyDeferred(keyString, &indexInfo, &deferred->buckets);
+            } else {
                 _totalIndexKeys++;
                 _indexConsistency->addDocKey(opCtx, keyString, &indexInfo, recordId);
-            } catch (...) {
-                return exceptionToStatus();
             }
+        } catch (...) {
+            return exceptionToStatus();
         }
     }
-    return status;
+    return Status::OK();
+}
+
+std::vector<Status> ValidateAdaptor::_addDocKeysBatch(OperationContext* opCtx,
+                                                      const std::vector<BatchedRecord>& batch,
+                                                      size_t numThreads) {
+    const auto& indexes = _validateState->getIndexes();
+    std::vector<DeferredIndexUpdates> updates(indexes.size());
+
+    // Each index is processed by exactly one thread. Indexes whose key generation is not known to
+    // be thread-safe all stay on this thread.
+    std::vector<std::vector<size_t>> assignments(numThreads);
+    size_t nextThread = 0;
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        if (indexes[i]->accessMethod()->canGenerateKeysConcurrently()) {
+            assignments[nextThread++ % numThreads].push_back(i);
+        } else {
+            assignments[0].push_back(i);
+        }
+    }
+
+    auto addKeysForIndexes = [&](const std::vector<size_t>& indexPositions) {
+        for (auto i : indexPositions) {
+            auto& out = updates[i];
+            for (size_t r = 0; r < batch.size(); ++r) {
+                try {
+                    Status status =
+                        _addDocKeys(nullptr, indexes[i].get(), batch[r].id, batch[r].obj, &out);
+                    if (!status.isOK()) {
+                        out.failures.emplace_back(r, std::move(status));
+                    }
+                } catch (...) {
+                    out.keyGenerationStatus = exceptionToStatus();
+                    break;
+                }
+            }
+        }
+    };
+
+    // The indexes assigned to the first thread stay on this thread.
+    std::vector<std::function<void()>> tasks;
+    for (size_t t = 0; t < numThreads; ++t) {
+        if (t == 0 || !assignments[t].empty()) {
+            tasks.push_back([&, t] { addKeysForIndexes(assignments[t]); });
+        }
+    }
+    IndexAccessMethod::runKeyGenerationTasks(opCtx, tasks);
+
+    std::vector<Status> statuses(batch.size(), Status::OK());
+    for (size_t i = 0; i < indexes.size(); ++i) {
+        auto& out = updates[i];
+        uassertStatusOK(out.keyGenerationStatus);
+
+        _indexConsistency->incrementBuckets(out.buckets);
+        _totalIndexKeys += out.numKeys;
+
+        if (!out.errors.empty()) {
+            ValidateResults& curRecordResults =
+                (*_indexNsResultsMap)[indexes[i]->descriptor()->indexName()];
+            curRecordResults.errors.insert(
+                curRecordResults.errors.end(), out.errors.begin(), out.errors.end());
+            curRecordResults.valid = false;
+        }
+
+        for (auto&& [position, status] : out.failures) {
+            if (statuses[position].isOK()) {
+                statuses[position] = std::move(status);
+            }
+        }
+    }
+    return statuses;
 }
 
 void ValidateAdaptor::traverseIndex(OperationContext* opCtx,
@@ -246,30 +342,15 @@ void ValidateAdaptor::traverseRecordStore(OperationContext* opCtx,
         _progress.set(CurOp::get(opCtx)->setProgress_inlock(curopMessage, totalRecords));
     }
 
-    const std::unique_ptr<SeekableRecordThrottleCursor>& traverseRecordStoreCursor =
-        _validateState->getTraverseRecordStoreCursor();
-    for (auto record =
-             traverseRecordStoreCursor->seekExact(opCtx, _validateState->getFirstRecordId());
-         record;
-         record = traverseRecordStoreCursor->next(opCtx)) {
-        _progress->hit();
-        ++_numRecords;
-        auto dataSize = record->data.size();
-        interruptIntervalNumBytes += dataSize;
-        dataSizeTotal += dataSize;
-        size_t validatedSize = 0;
-        Status status = validateRecord(opCtx, record->id, record->data, &validatedSize);
-
-        // Checks to ensure isInRecordIdOrder() is being used properly.
-        if (prevRecordId.isValid()) {
-            invariant(prevRecordId < record->id);
-        }
-
+    auto reportRecord = [&](const RecordId& id,
+                            long long dataSize,
+                            const Status& status,
+                            size_t validatedSize) {
         // validatedSize = dataSize is not a general requirement as some storage engines may use
         // padding, but we still require that they return the unpadded record data.
         if (!status.isOK() || validatedSize != static_cast<size_t>(dataSize)) {
             str::stream ss;
-            ss << "Document with RecordId " << record->id << " is corrupted. ";
+            ss << "Document with RecordId " << id << " is corrupted. ";
             if (!status.isOK() && validatedSize != static_cast<size_t>(dataSize)) {
                 ss << "Reasons: (1) " << status << "; (2) Validated size of " << validatedSize
                    << " bytes does not equal the record size of " << dataSize << " bytes";
@@ -288,12 +369,74 @@ void ValidateAdaptor::traverseRecordStore(OperationContext* opCtx,
             }
             nInvalid++;
         }
+    };
+
+    // While counting keys in the first phase, the document keys of different indexes are added on
+    // several threads for batches of records. The second phase looks records up through this
+    // operation's cursors and stays on this thread.
+    size_t numIndexThreads = 1;
+    if (_indexConsistency->isFirstPhase()) {
+        numIndexThreads = std::min(static_cast<size_t>(gMaxValidateIndexThreads.load()),
+                                   _validateState->getIndexes().size());
+    }
+
+    std::vector<BatchedRecord> batch;
+    long long batchNumBytes = 0;
+    auto flushBatch = [&] {
+        if (batch.empty()) {
+            return;
+        }
+        auto statuses = _addDocKeysBatch(opCtx, batch, numIndexThreads);
+        for (size_t i = 0; i < batch.size(); ++i) {
+            reportRecord(batch[i].id, batch[i].dataSize, statuses[i], batch[i].validatedSize);
+        }
+        batch.clear();
+        batchNumBytes = 0;
+    };
+
+    const std::unique_ptr<SeekableRecordThrottleCursor>& traverseRecordStoreCursor =
+        _validateState->getTraverseRecordStoreCursor();
+    for (auto record =
+             traverseRecordStoreCursor->seekExact(opCtx, _validateState->getFirstRecordId());
+         record;
+         record = traverseRecordStoreCursor->next(opCtx)) {
+        _progress->hit();
+        ++_numRecords;
+        auto dataSize = record->data.size();
+        interruptIntervalNumBytes += dataSize;
+        dataSizeTotal += dataSize;
+        size_t validatedSize = 0;
+
+        // Checks to ensure isInRecordIdOrder() is being used properly.
+        if (prevRecordId.isValid()) {
+            invariant(prevRecordId < record->id);
+        }
+
+        if (numIndexThreads > 1) {
+            BSONObj recordBson;
+            Status status = _validateBSON(record->data, &recordBson, &validatedSize);
+            if (status.isOK()) {
+                batch.push_back({record->id, recordBson.getOwned(), dataSize, validatedSize});
+                batchNumBytes += dataSize;
+                if (batch.size() >= IndexAccessMethod::kMaxKeyGenerationBatchDocs ||
+                    batchNumBytes >=
+                        static_cast<long long>(IndexAccessMethod::kMaxKeyGenerationBatchBytes)) {
+                    flushBatch();
+                }
+            } else {
+                reportRecord(record->id, dataSize, status, validatedSize);
+            }
+        } else {
+            Status status = validateRecord(opCtx, record->id, record->data, &validatedSize);
+            reportRecord(record->id, dataSize, status, validatedSize);
+        }
 
         prevRecordId = record->id;
 
         if (_numRecords % kInterruptIntervalNumRecords == 0 ||
             interruptIntervalNumBytes >= kInterruptIntervalNumBytes) {
             // Periodically checks for interrupts and yields.
+            flushBatch();
             opCtx->checkForInterrupt();
             _validateState->yield(opCtx);
 
@@ -302,6 +445,7 @@ void ValidateAdaptor::traverseRecordStore(OperationContext* opCtx,
             }
         }
     }
+    flushBatch();
 
     // Do not update the record store stats if we're in the background as we've validated a
     // checkpoint and it may not have the most up-to-date changes.
@@ -87,6 +87,50 @@ public:
     void validateIndexKeyCount(const IndexDescriptor* idx, ValidateResults& results);
 
 private:
+    // A record whose BSON has been validated, waiting for its document keys to be added.
+    struct BatchedRecord {
+        RecordId id;
+        BSONObj obj;
+        long long dataSize;
+        size_t validatedSize;
+    };
+
+    // Index consistency updates for one index that are applied once every thread adding document
+    // keys for a batch of records has finished.
+    struct DeferredIndexUpdates {
+        std::vector<uint32_t> buckets;
+        std::vector<std::string> errors;
+        uint64_t numKeys = 0;
+        // Records whose keys could not be added, by position in the batch.
+        std::vector<std::pair<size_t, Status>> failures;
+        // Set if generating keys threw, which ends the validation.
+        Status keyGenerationStatus = Status::OK();
+    };
+
+    /**
+     * Validates the BSON of 'record'. On success, sets 'recordBson' and 'dataSize'.
+     */
+    Status _validateBSON(const RecordData& record, BSONObj* recordBson, size_t* dataSize);
+
+    /**
+     * Generates the document keys 'recordBson' has in 'index' and adds them to the index
+     * consistency. If 'deferred' is set, hash bucket increments and index errors are collected
+     * there instead of being applied, so that several indexes can be processed concurrently.
+     */
+    Status _addDocKeys(OperationContext* opCtx,
+                       const IndexCatalogEntry* index,
+                       const RecordId& recordId,
+                       const BSONObj& recordBson,
+                       DeferredIndexUpdates* deferred);
+
+    /**
+     * Adds the document keys of every record in 'batch', spreading the indexes over up to
+     * 'numThreads' key generation threads. Returns the status of each record's key generation.
+     */
+    std::vector<Status> _addDocKeysBatch(OperationContext* opCtx,
+                                         const std::vector<BatchedRecord>& batch,
+                                         size_t numThreads);
+
     IndexConsistency* _indexConsistency;
     CollectionValidation::ValidateState* _validateState;
     ValidateResultsMap* _indexNsResultsMap;
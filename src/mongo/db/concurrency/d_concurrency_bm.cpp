@@ -40,7 +40,8 @@
 namespace mongo {
 namespace {
 
-const int kMaxPerfThreads = 16;  // max number of threads to use for lock perf
+const int kMaxPerfThreads = 16;              // max number of threads to use for lock perf
+const int kMaxLockManagerPerfThreads = 128;  // max number of threads to use for bucket scaling
 
 
 class DConcurrencyTest : public benchmark::Fixture {
@@ -166,6 +167,37 @@ BENCHMARK_DEFINE_F(DConcurrencyTest, BM_MMAPv1CollectionExclusiveLock)(benchmark
     }
 }
 
+/**
+ * Each thread repeatedly locks and unlocks its own collection in MODE_X directly through
+ * 'lockMgr', so threads never conflict on a resource and only contend on the lock manager's
+ * bucket mutexes.
+ */
+void lockDistinctCollections(benchmark::State& state, LockManager* lockMgr) {
+    const ResourceId resId(RESOURCE_COLLECTION,
+                           std::string(str::stream() << "test.coll" << state.thread_index));
+    LockerImpl locker;
+    TrackingLockGrantNotification notify;
+
+    for (auto keepRunning : state) {
+        LockRequest request;
+        request.initNew(&locker, &notify);
+        invariant(LOCK_OK == lockMgr->lock(resId, &request, MODE_X));
+        lockMgr->unlock(&request);
+    }
+}
+
+BENCHMARK_DEFINE_F(DConcurrencyTest, BM_LockManagerSingleBucket)(benchmark::State& state) {
+    // Every resource collides in the one bucket.
+    static LockManager lockMgr(1, 1);
+    lockDistinctCollections(state, &lockMgr);
+}
+
+BENCHMARK_DEFINE_F(DConcurrencyTest, BM_LockManagerDefaultBuckets)(benchmark::State& state) {
+    // Sized from the number of cores, like the global lock manager.
+    static LockManager lockMgr;
+    lockDistinctCollections(state, &lockMgr);
+}
+
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_StdMutex)->ThreadRange(1, kMaxPerfThreads);
 
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_ResourceMutexShared)->ThreadRange(1, kMaxPerfThreads);
@@ -181,5 +213,10 @@ BENCHMARK_REGISTER_F(DConcurrencyTest, BM_MMAPv1CollectionSharedLock)
 BENCHMARK_REGISTER_F(DConcurrencyTest, BM_MMAPv1CollectionExclusiveLock)
     ->ThreadRange(1, kMaxPerfThreads);
 
+BENCHMARK_REGISTER_F(DConcurrencyTest, BM_LockManagerSingleBucket)
+    ->ThreadRange(1, kMaxLockManagerPerfThreads);
+BENCHMARK_REGISTER_F(DConcurrencyTest, BM_LockManagerDefaultBuckets)
+    ->ThreadRange(1, kMaxLockManagerPerfThreads);
+
 }  // namespace
 }  // namespace mongo
@@ -33,6 +33,8 @@
 
 #include "mongo/db/concurrency/lock_manager.h"
 
+#include <algorithm>
+
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/data_view.h"
 #include "mongo/base/static_assert.h"
@@ -42,6 +44,7 @@
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/locker.h"
 #include "mongo/logv2/log.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/str.h"
@@ -366,7 +369,7 @@ void LockHead::migratePartitionedLockHeads() {
     // Migration time: lock each partition in turn and transfer its requests, if any
     while (partitioned()) {
         LockManager::Partition* partition = partitions.back();
-        stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
+        stdx::lock_guard<LockManager::InstrumentedMutex> scopedLock(partition->mutex);
 
         LockManager::Partition::Map::iterator it = partition->data.find(resourceId);
         if (it != partition->data.end()) {
@@ -394,12 +397,35 @@ void LockHead::migratePartitionedLockHeads() {
 // LockManager
 //
 
+namespace {
+
+unsigned nextPowerOfTwo(unsigned n) {
+    unsigned result = 1;
+    while (result < n) {
+        result <<= 1;
+    }
+    return result;
+}
+
 // Have more buckets than CPUs to reduce contention on lock and caches
-const unsigned LockManager::_numLockBuckets(128);
+unsigned defaultNumLockBuckets() {
+    return std::clamp(nextPowerOfTwo(4 * stdx::thread::hardware_concurrency()), 128U, 4096U);
+}
 
 // Balance scalability of intent locks against potential added cost of conflicting locks.
 // The exact value doesn't appear very important, but should be power of two
-const unsigned LockManager::_numPartitions = 32;
+unsigned defaultNumPartitions() {
+    return std::clamp(nextPowerOfTwo(stdx::thread::hardware_concurrency()), 32U, 1024U);
+}
+
+}  // namespace
+
+void LockManager::InstrumentedMutex::lock() {
+    if (!mutex.try_lock()) {
+        contended.fetchAndAddRelaxed(1);
+        mutex.lock();
+    }
+}
 
 // static
 std::map<LockerId, BSONObj> LockManager::getLockToClientMap(ServiceContext* serviceContext) {
@@ -427,7 +453,11 @@ std::map<LockerId, BSONObj> LockManager::getLockToClientMap(ServiceContext* serv
     return lockToClientMap;
 }
 
-LockManager::LockManager() {
+LockManager::LockManager() : LockManager(defaultNumLockBuckets(), defaultNumPartitions()) {}
+
+LockManager::LockManager(unsigned numLockBuckets, unsigned numPartitions)
+    : _numLockBuckets(numLockBuckets), _numPartitions(numPartitions) {
+    invariant(_numLockBuckets > 0 && _numPartitions > 0);
     _lockBuckets = new LockBucket[_numLockBuckets];
     _partitions = new Partition[_numPartitions];
 }
@@ -455,7 +485,7 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
     // For intent modes, try the PartitionedLockHead
     if (request->partitioned) {
         Partition* partition = _getPartition(request);
-        stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
+        stdx::lock_guard<InstrumentedMutex> scopedLock(partition->mutex);
 
         // Fast path for intent locks
         PartitionedLockHead* partitionedLock = partition->find(resId);
@@ -471,14 +501,14 @@ LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mo
 
     // Use regular LockHead, maybe start partitioning
     LockBucket* bucket = _getBucket(resId);
-    stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+    stdx::lock_guard<InstrumentedMutex> scopedLock(bucket->mutex);
 
     LockHead* lock = bucket->findOrInsert(resId);
 
     // Start a partitioned lock if possible
     if (request->partitioned && !(lock->grantedModes & (~intentModes)) && !lock->conflictModes) {
         Partition* partition = _getPartition(request);
-        stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
+        stdx::lock_guard<InstrumentedMutex> scopedLock(partition->mutex);
         PartitionedLockHead* partitionedLock = partition->findOrInsert(resId);
         invariant(partitionedLock);
         lock->partitions.push_back(partition);
@@ -519,7 +549,7 @@ LockResult LockManager::convert(ResourceId resId, LockRequest* request, LockMode
               LockConflictsTable[newMode]);
 
     LockBucket* bucket = _getBucket(resId);
-    stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+    stdx::lock_guard<InstrumentedMutex> scopedLock(bucket->mutex);
 
     LockBucket::Map::iterator it = bucket->data.find(resId);
     invariant(it != bucket->data.end());
@@ -587,7 +617,7 @@ bool LockManager::unlock(LockRequest* request) {
         invariant(request->status == LockRequest::STATUS_GRANTED ||
                   request->status == LockRequest::STATUS_CONVERTING);
         Partition* partition = _getPartition(request);
-        stdx::lock_guard<SimpleMutex> scopedLock(partition->mutex);
+        stdx::lock_guard<InstrumentedMutex> scopedLock(partition->mutex);
         //  Fast path: still partitioned.
         if (request->partitionedLock) {
             request->partitionedLock->grantedList.remove(request);
@@ -600,7 +630,7 @@ bool LockManager::unlock(LockRequest* request) {
 
     LockHead* lock = request->lock;
     LockBucket* bucket = _getBucket(lock->resourceId);
-    stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+    stdx::lock_guard<InstrumentedMutex> scopedLock(bucket->mutex);
 
     if (request->status == LockRequest::STATUS_GRANTED) {
         // This releases a currently held lock and is the most common path, so it should be
@@ -662,7 +692,7 @@ void LockManager::downgrade(LockRequest* request, LockMode newMode) {
     LockHead* lock = request->lock;
 
     LockBucket* bucket = _getBucket(lock->resourceId);
-    stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+    stdx::lock_guard<InstrumentedMutex> scopedLock(bucket->mutex);
 
     lock->incGrantedModeCount(newMode);
     lock->decGrantedModeCount(request->mode);
@@ -674,11 +704,61 @@ void LockManager::downgrade(LockRequest* request, LockMode newMode) {
 void LockManager::cleanupUnusedLocks() {
     for (unsigned i = 0; i < _numLockBuckets; i++) {
         LockBucket* bucket = &_lockBuckets[i];
-        stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+        stdx::lock_guard<InstrumentedMutex> scopedLock(bucket->mutex);
         _cleanupUnusedLocksInBucket(bucket);
     }
 }
 
+void LockManager::appendContentionStats(BSONObjBuilder* result,
+                                        size_t maxHotBuckets,
+                                        size_t maxResourcesPerBucket) const {
+    long long bucketContended = 0;
+    std::vector<std::pair<long long, unsigned>> contendedBuckets;
+    for (unsigned i = 0; i < _numLockBuckets; i++) {
+        const InstrumentedMutex& mutex = _lockBuckets[i].mutex;
+        const long long contended = mutex.contended.loadRelaxed();
+        bucketContended += contended;
+        if (contended > 0) {
+            contendedBuckets.emplace_back(contended, i);
+        }
+    }
+
+    long long partitionContended = 0;
+    for (unsigned i = 0; i < _numPartitions; i++) {
+        partitionContended += _partitions[i].mutex.contended.loadRelaxed();
+    }
+
+    result->append("numLockBuckets", static_cast<int>(_numLockBuckets));
+    result->append("numPartitions", static_cast<int>(_numPartitions));
+    result->append("bucketContended", bucketContended);
+    result->append("partitionContended", partitionContended);
+
+    const size_t numHotBuckets = std::min(maxHotBuckets, contendedBuckets.size());
+    std::partial_sort(contendedBuckets.begin(),
+                      contendedBuckets.begin() + numHotBuckets,
+                      contendedBuckets.end(),
+                      std::greater<>());
+
+    BSONArrayBuilder hotBuckets(result->subarrayStart("hotBuckets"));
+    for (size_t i = 0; i < numHotBuckets; i++) {
+        LockBucket* bucket = &_lockBuckets[contendedBuckets[i].second];
+
+        BSONObjBuilder bucketBuilder(hotBuckets.subobjStart());
+        bucketBuilder.append("bucket", static_cast<int>(contendedBuckets[i].second));
+        bucketBuilder.append("contended", contendedBuckets[i].first);
+
+        stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex.mutex);
+        bucketBuilder.append("numResources", static_cast<long long>(bucket->data.size()));
+        BSONArrayBuilder resources(bucketBuilder.subarrayStart("resources"));
+        for (const auto& entry : bucket->data) {
+            if (static_cast<size_t>(resources.arrSize()) >= maxResourcesPerBucket) {
+                break;
+            }
+            resources.append(entry.first.toString());
+        }
+    }
+}
+
 void LockManager::_cleanupUnusedLocksInBucket(LockBucket* bucket) {
     LockBucket::Map::iterator it = bucket->data.begin();
     size_t deletedLockHeads = 0;
@@ -834,7 +914,7 @@ void LockManager::dump() const {
     auto lockToClientMap = getLockToClientMap(getGlobalServiceContext());
     for (unsigned i = 0; i < _numLockBuckets; i++) {
         LockBucket* bucket = &_lockBuckets[i];
-        stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+        stdx::lock_guard<InstrumentedMutex> scopedLock(bucket->mutex);
 
         if (!bucket->data.empty()) {
             _dumpBucket(lockToClientMap, bucket);
@@ -895,7 +975,7 @@ void LockManager::getLockInfoBSON(const std::map<LockerId, BSONObj>& lockToClien
     BSONArrayBuilder lockInfo;
     for (unsigned i = 0; i < _numLockBuckets; i++) {
         LockBucket* bucket = &_lockBuckets[i];
-        stdx::lock_guard<SimpleMutex> scopedLock(bucket->mutex);
+        stdx::lock_guard<InstrumentedMutex> scopedLock(bucket->mutex);
 
         _cleanupUnusedLocksInBucket(bucket);
         if (!bucket->data.empty()) {
@@ -64,7 +64,12 @@ public:
      */
     static std::map<LockerId, BSONObj> getLockToClientMap(ServiceContext* serviceContext);
 
+    /**
+     * Sizes the lock buckets and intent lock partitions from the number of cores on the machine,
+     * but never below 128 buckets and 32 partitions.
+     */
     LockManager();
+    LockManager(unsigned numLockBuckets, unsigned numPartitions);
     ~LockManager();
 
     /**
@@ -141,14 +146,38 @@ public:
     void getLockInfoBSON(const std::map<LockerId, BSONObj>& lockToClientMap,
                          BSONObjBuilder* result);
 
+    /**
+     * Reports how often the mutexes of the lock buckets and intent lock partitions were already
+     * held by another thread when acquired. The total number of lock acquisitions is reported by
+     * the lock stats, so it is not counted again here to keep uncontended acquisitions cheap.
+     * Also lists up to 'maxResourcesPerBucket' resources in each of the (at most) 'maxHotBuckets'
+     * buckets whose mutexes were contended most, since resources which hash to the same bucket
+     * contend with each other.
+     */
+    void appendContentionStats(BSONObjBuilder* result,
+                               size_t maxHotBuckets,
+                               size_t maxResourcesPerBucket) const;
+
 private:
     // The lockheads need access to the partitions
     friend struct LockHead;
 
+    // A mutex which counts how often it was held by another thread when acquired. Uncontended
+    // acquisitions do not touch the counter.
+    struct InstrumentedMutex {
+        void lock();
+        void unlock() {
+            mutex.unlock();
+        }
+
+        SimpleMutex mutex;
+        AtomicWord<long long> contended{0};
+    };
+
     // These types describe the locks hash table
 
     struct LockBucket {
-        SimpleMutex mutex;
+        InstrumentedMutex mutex;
         typedef stdx::unordered_map<ResourceId, LockHead*> Map;
         Map data;
         LockHead* findOrInsert(ResourceId resId);
@@ -161,7 +190,7 @@ private:
         PartitionedLockHead* find(ResourceId resId);
         PartitionedLockHead* findOrInsert(ResourceId resId);
         typedef stdx::unordered_map<ResourceId, PartitionedLockHead*> Map;
-        SimpleMutex mutex;
+        InstrumentedMutex mutex;
         Map data;
     };
 
@@ -219,10 +248,10 @@ private:
      */
     void _cleanupUnusedLocksInBucket(LockBucket* bucket);
 
-    static const unsigned _numLockBuckets;
+    const unsigned _numLockBuckets;
     LockBucket* _lockBuckets;
 
-    static const unsigned _numPartitions;
+    const unsigned _numPartitions;
     Partition* _partitions;
 };
 }  // namespace mongo
@@ -100,6 +100,29 @@ TEST(LockManager, Grant) {
     ASSERT(request.recursiveCount == 0);
 }
 
+TEST(LockManager, ContentionStats) {
+    LockManager lockMgr(1, 1);
+    const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
+
+    LockerImpl locker;
+    TrackingLockGrantNotification notify;
+
+    LockRequest request;
+    request.initNew(&locker, &notify);
+    ASSERT(LOCK_OK == lockMgr.lock(resId, &request, MODE_X));
+    lockMgr.unlock(&request);
+
+    BSONObjBuilder builder;
+    lockMgr.appendContentionStats(&builder, 5, 10);
+    BSONObj stats = builder.obj();
+    ASSERT_EQ(stats["numLockBuckets"].numberInt(), 1);
+    ASSERT_EQ(stats["numPartitions"].numberInt(), 1);
+    // Uncontended acquisitions of the mutexes are not counted.
+    ASSERT_EQ(stats["bucketContended"].numberLong(), 0);
+    ASSERT_EQ(stats["partitionContended"].numberLong(), 0);
+    ASSERT(stats["hotBuckets"].Obj().isEmpty());
+}
+
 TEST(LockManager, GrantMultipleNoConflict) {
     LockManager lockMgr;
     const ResourceId resId(RESOURCE_COLLECTION, std::string("TestDB.collection"));
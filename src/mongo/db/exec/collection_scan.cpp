@@ -86,6 +86,14 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
         invariant(params.direction == CollectionScanParams::FORWARD);
     }
 
+    if (params.minRecord || params.maxRecord) {
+        // Scans over a range of RecordIds are only supported in the forward direction.
+        invariant(params.direction == CollectionScanParams::FORWARD);
+        invariant(!params.tailable);
+        invariant(!params.minTs);
+        invariant(!params.resumeAfterRecordId);
+    }
+
     // Set early stop condition.
     if (params.maxTs) {
         _endConditionBSON = BSON("$gte"_sd << *(params.maxTs));
@@ -167,6 +175,15 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
             return PlanStage::NEED_TIME;
         }
 
+        if (_lastSeenId.isNull() && _params.minRecord) {
+            // Seek to the start of the range. If there is no record at or after it, the scan is
+            // already at EOF.
+            record = _cursor->seek(*_params.minRecord);
+            if (!record) {
+                return processRecord(record, out);
+            }
+        }
+
         if (_lastSeenId.isNull() && _params.minTs) {
             // See if the RecordStore supports the oplogStartHack.
             StatusWith<RecordId> goal = oploghack::keyForOptime(*_params.minTs);
@@ -191,6 +208,60 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         return PlanStage::NEED_YIELD;
     }
 
+    return processRecord(record, out);
+}
+
+PlanStage::StageState CollectionScan::doWorkBatch(size_t maxWorks,
+                                                  std::vector<WorkingSetID>* results,
+                                                  WorkingSetID* out,
+                                                  size_t* works) {
+    // Creating the cursor, seeking to the oplog start and reporting resume tokens or oplog
+    // timestamps all depend on the scan not running ahead of the results handed out so far, so
+    // those cases go through doWork() one result at a time.
+    if (!_cursor || _commonStats.isEOF || (_lastSeenId.isNull() && _params.minTs) ||
+        (_lastSeenId.isNull() && _params.minRecord) ||
+        _params.requestResumeToken || _params.shouldTrackLatestOplogTimestamp) {
+        return PlanStage::doWorkBatch(maxWorks, results, out, works);
+    }
+
+    // Unless the record data stays valid until the cursor is saved, each result must be made
+    // owned before the cursor moves past it.
+    const bool ownEachResult = !_cursor->unownedDataValidUntilSave();
+    const size_t numResultsBefore = results->size();
+    while (*works < maxWorks) {
+        if (ownEachResult && results->size() > numResultsBefore) {
+            _workingSet->get(results->back())->makeObjOwnedIfNeeded();
+        }
+
+        ++(*works);
+        boost::optional<Record> record;
+        try {
+            record = _cursor->next();
+        } catch (const WriteConflictException&) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState state = processRecord(record, &id);
+        if (PlanStage::ADVANCED == state) {
+            results->push_back(id);
+        } else if (PlanStage::NEED_TIME != state) {
+            *out = id;
+            return state;
+        }
+    }
+
+    return results->size() > numResultsBefore ? PlanStage::ADVANCED : PlanStage::NEED_TIME;
+}
+
+PlanStage::StageState CollectionScan::processRecord(boost::optional<Record>& record,
+                                                    WorkingSetID* out) {
+    if (record && _params.maxRecord && record->id >= *_params.maxRecord) {
+        // The scan has moved past the end of its range.
+        record = boost::none;
+    }
+
     if (!record) {
         // We just hit EOF. If we are tailable and have already returned data, leave us in a
         // state to pick up where we left off on the next call to work(). Otherwise EOF is
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <memory>
 
 #include "mongo/db/exec/collection_scan_common.h"
@@ -60,6 +61,10 @@ public:
                    const MatchExpression* filter);
 
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks,
+                           std::vector<WorkingSetID>* results,
+                           WorkingSetID* out,
+                           size_t* works) final;
     bool isEOF() final;
 
     void doDetachFromOperationContext() final;
@@ -87,6 +92,13 @@ protected:
     void doRestoreStateRequiresCollection() final;
 
 private:
+    /**
+     * Turns the result of advancing '_cursor' into this stage's output: IS_EOF if 'record' is
+     * boost::none, otherwise a new WorkingSetMember for the record which is returned through
+     * returnIfMatches().
+     */
+    StageState processRecord(boost::optional<Record>& record, WorkingSetID* out);
+
     /**
      * If the member (with id memberID) passes our filter, set *out to memberID and return that
      * ADVANCED.  Otherwise, free memberID and return NEED_TIME.
@@ -61,6 +61,14 @@ struct CollectionScanParams {
     // This field cannot be used in conjunction with 'minTs' or 'maxTs'.
     boost::optional<RecordId> resumeAfterRecordId;
 
+    // If present, the collection scan will seek to the first record whose RecordId is at least
+    // 'minRecord', and return EOF at the first record whose RecordId is at least 'maxRecord'. This
+    // restricts the scan to the half-open range ['minRecord', 'maxRecord'), which allows several
+    // scans to split a collection between them. Must only be set on forward, non-tailable scans.
+    // These fields cannot be used in conjunction with 'minTs' or 'resumeAfterRecordId'.
+    boost::optional<RecordId> minRecord;
+    boost::optional<RecordId> maxRecord;
+
     Direction direction = FORWARD;
 
     // Do we want the scan to be 'tailable'?  Only meaningful if the collection is capped.
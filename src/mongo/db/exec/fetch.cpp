@@ -38,6 +38,7 @@
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/str.h"
 
@@ -69,6 +70,11 @@ bool FetchStage::isEOF() {
         return false;
     }
 
+    if (_childBatchPos < _childBatch.size() || NEED_TIME != _childBatchState) {
+        // We still have results from a batch to fetch, or the state which ended it to report.
+        return false;
+    }
+
     return child()->isEOF();
 }
 
@@ -77,6 +83,9 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    // Results batched up by doWorkBatch() must be drained through doWorkBatch().
+    invariant(_childBatchPos == _childBatch.size() && NEED_TIME == _childBatchState);
+
     // Either retry the last WSM we worked on or get a new one from our child.
     WorkingSetID id;
     StageState status;
@@ -89,35 +98,7 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     }
 
     if (PlanStage::ADVANCED == status) {
-        WorkingSetMember* member = _ws->get(id);
-
-        // If there's an obj there, there is no fetching to perform.
-        if (member->hasObj()) {
-            ++_specificStats.alreadyHasObj;
-        } else {
-            // We need a valid RecordId to fetch from and this is the only state that has one.
-            verify(WorkingSetMember::RID_AND_IDX == member->getState());
-            verify(member->hasRecordId());
-
-            try {
-                if (!_cursor)
-                    _cursor = collection()->getCursor(getOpCtx());
-
-                if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, _cursor, collection()->ns())) {
-                    _ws->free(id);
-                    return NEED_TIME;
-                }
-            } catch (const WriteConflictException&) {
-                // Ensure that the BSONObj underlying the WorkingSetMember is owned because it may
-                // be freed when we yield.
-                member->makeObjOwnedIfNeeded();
-                _idRetrying = id;
-                *out = WorkingSet::INVALID_ID;
-                return NEED_YIELD;
-            }
-        }
-
-        return returnIfMatches(member, id, out);
+        return fetchAndFilter(id, out);
     } else if (PlanStage::FAILURE == status) {
         // The stage which produces a failure is responsible for allocating a working set member
         // with error details.
@@ -131,10 +112,133 @@ PlanStage::StageState FetchStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState FetchStage::doWorkBatch(size_t maxWorks,
+                                              std::vector<WorkingSetID>* results,
+                                              WorkingSetID* out,
+                                              size_t* works) {
+    if (_idRetrying == WorkingSet::INVALID_ID && _childBatchPos == _childBatch.size() &&
+        _childBatchState == NEED_TIME) {
+        if (child()->isEOF()) {
+            return PlanStage::IS_EOF;
+        }
+
+        _childBatch.clear();
+        _childBatchPos = 0;
+        _childBatchOut = WorkingSet::INVALID_ID;
+        _childBatchState = child()->workBatch(maxWorks, &_childBatch, &_childBatchOut);
+        if (PlanStage::ADVANCED == _childBatchState) {
+            _childBatchState = NEED_TIME;
+        }
+        prefetchChildBatch();
+    }
+
+    const size_t numResultsBefore = results->size();
+    for (;;) {
+        WorkingSetID id;
+        if (_idRetrying != WorkingSet::INVALID_ID) {
+            id = _idRetrying;
+            _idRetrying = WorkingSet::INVALID_ID;
+        } else if (_childBatchPos < _childBatch.size()) {
+            id = _childBatch[_childBatchPos++];
+        } else {
+            break;
+        }
+
+        if (results->size() > numResultsBefore && _cursor &&
+            !_cursor->unownedDataValidUntilSave()) {
+            // The previous result may point into '_cursor', which is about to be repositioned.
+            _ws->get(results->back())->makeObjOwnedIfNeeded();
+        }
+
+        ++(*works);
+        WorkingSetID resultId = WorkingSet::INVALID_ID;
+        StageState state = fetchAndFilter(id, &resultId);
+        if (PlanStage::ADVANCED == state) {
+            results->push_back(resultId);
+        } else if (PlanStage::NEED_YIELD == state) {
+            *out = resultId;
+            return state;
+        }
+    }
+
+    // Everything our child produced has been fetched, so report how its batch ended.
+    if (NEED_TIME != _childBatchState) {
+        ++(*works);
+        StageState state = _childBatchState;
+        *out = _childBatchOut;
+        _childBatchState = NEED_TIME;
+        _childBatchOut = WorkingSet::INVALID_ID;
+        return state;
+    }
+
+    return results->size() > numResultsBefore ? PlanStage::ADVANCED : PlanStage::NEED_TIME;
+}
+
+PlanStage::StageState FetchStage::fetchAndFilter(WorkingSetID id, WorkingSetID* out) {
+    WorkingSetMember* member = _ws->get(id);
+
+    // If there's an obj there, there is no fetching to perform.
+    if (member->hasObj()) {
+        ++_specificStats.alreadyHasObj;
+    } else {
+        // We need a valid RecordId to fetch from and this is the only state that has one.
+        verify(WorkingSetMember::RID_AND_IDX == member->getState());
+        verify(member->hasRecordId());
+
+        try {
+            if (!_cursor)
+                _cursor = collection()->getCursor(getOpCtx());
+
+            if (!WorkingSetCommon::fetch(getOpCtx(), _ws, id, _cursor, collection()->ns())) {
+                _ws->free(id);
+                return NEED_TIME;
+            }
+        } catch (const WriteConflictException&) {
+            // Ensure that the BSONObj underlying the WorkingSetMember is owned because it may
+            // be freed when we yield.
+            member->makeObjOwnedIfNeeded();
+            _idRetrying = id;
+            *out = WorkingSet::INVALID_ID;
+            return NEED_YIELD;
+        }
+    }
+
+    return returnIfMatches(member, id, out);
+}
+
+void FetchStage::prefetchChildBatch() {
+    const int minRecords = internalQueryFetchPrefetchMinRecords.load();
+    if (minRecords <= 0 || _childBatch.size() < static_cast<size_t>(minRecords)) {
+        // Too few results to be worth the round trip to the prefetch threads.
+        return;
+    }
+
+    std::vector<RecordId> ids;
+    ids.reserve(_childBatch.size());
+    for (auto id : _childBatch) {
+        WorkingSetMember* member = _ws->get(id);
+        if (!member->hasObj() && member->hasRecordId()) {
+            ids.push_back(member->recordId);
+        }
+    }
+    if (ids.size() < static_cast<size_t>(minRecords)) {
+        return;
+    }
+
+    if (!_cursor)
+        _cursor = collection()->getCursor(getOpCtx());
+    _cursor->prefetch(ids);
+}
+
 void FetchStage::doSaveStateRequiresCollection() {
     if (_cursor) {
         _cursor->saveUnpositioned();
     }
+
+    // Members from our child's batch which are yet to be fetched must survive the yield.
+    for (size_t i = _childBatchPos; i < _childBatch.size(); ++i) {
+        _ws->get(_childBatch[i])->makeObjOwnedIfNeeded();
+    }
 }
 
 void FetchStage::doRestoreStateRequiresCollection() {
@@ -60,6 +60,10 @@ public:
 
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks,
+                           std::vector<WorkingSetID>* results,
+                           WorkingSetID* out,
+                           size_t* works) final;
 
     void doDetachFromOperationContext() final;
     void doReattachToOperationContext() final;
@@ -80,6 +84,19 @@ protected:
     void doRestoreStateRequiresCollection() final;
 
 private:
+    /**
+     * Fetches the document for the member with id 'id' if it does not already have one, then
+     * passes it through returnIfMatches(). Returns NEED_YIELD and arranges for 'id' to be retried
+     * if the storage engine reports a write conflict.
+     */
+    StageState fetchAndFilter(WorkingSetID id, WorkingSetID* out);
+
+    /**
+     * Hints to the storage engine that the records of the members in '_childBatch' which still
+     * need fetching will soon be read, if there are enough of them.
+     */
+    void prefetchChildBatch();
+
     /**
      * If the member (with id memberID) passes our filter, set *out to memberID and return that
      * ADVANCED.  Otherwise, free memberID and return NEED_TIME.
@@ -98,6 +115,14 @@ private:
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
+    // Results of our child's last workBatch() call, of which the first '_childBatchPos' have been
+    // fetched, along with the state and WSID which ended that batch. '_childBatchState' is reset to
+    // NEED_TIME once the state has been passed on to our parent.
+    std::vector<WorkingSetID> _childBatch;
+    size_t _childBatchPos = 0;
+    StageState _childBatchState = NEED_TIME;
+    WorkingSetID _childBatchOut = WorkingSet::INVALID_ID;
+
     // Stats
     FetchStats _specificStats;
 };
@@ -29,6 +29,7 @@
 
 #include "mongo/db/exec/limit.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/db/exec/scoped_timer.h"
@@ -82,6 +83,24 @@ PlanStage::StageState LimitStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState LimitStage::doWorkBatch(size_t maxWorks,
+                                              std::vector<WorkingSetID>* results,
+                                              WorkingSetID* out,
+                                              size_t* works) {
+    if (0 == _numToReturn) {
+        // We've returned as many results as we're limited to.
+        return PlanStage::IS_EOF;
+    }
+
+    // Never ask our child for more results than we are still allowed to return.
+    const size_t numResultsBefore = results->size();
+    StageState status = child()->workBatch(
+        std::min(maxWorks, static_cast<size_t>(_numToReturn)), results, out);
+    _numToReturn -= results->size() - numResultsBefore;
+
+    return status;
+}
+
 unique_ptr<PlanStageStats> LimitStage::getStats() {
     _commonStats.isEOF = isEOF();
     unique_ptr<PlanStageStats> ret = std::make_unique<PlanStageStats>(_commonStats, STAGE_LIMIT);
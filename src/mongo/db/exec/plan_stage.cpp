@@ -33,6 +33,8 @@
 
 #include "mongo/db/exec/plan_stage.h"
 
+#include <algorithm>
+
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/service_context.h"
@@ -59,6 +61,60 @@ PlanStage::StageState PlanStage::work(WorkingSetID* out) {
     return workResult;
 }
 
+PlanStage::StageState PlanStage::workBatch(size_t maxWorks,
+                                           std::vector<WorkingSetID>* results,
+                                           WorkingSetID* out) {
+    invariant(_opCtx);
+    invariant(maxWorks > 0);
+    ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
+
+    const size_t numResultsBefore = results->size();
+    size_t works = 0;
+    StageState workResult = doWorkBatch(maxWorks, results, out, &works);
+
+    const size_t advanced = results->size() - numResultsBefore;
+    const bool endedEarly = (NEED_TIME != workResult && ADVANCED != workResult);
+    works = std::max(works, advanced + (endedEarly ? 1 : 0));
+    if (works == 0) {
+        // A batch that produced nothing still counts as one NEED_TIME.
+        works = 1;
+    }
+
+    _commonStats.works += works;
+    _commonStats.advanced += advanced;
+    _commonStats.needTime += works - advanced - (endedEarly ? 1 : 0);
+    if (StageState::NEED_YIELD == workResult) {
+        ++_commonStats.needYield;
+    } else if (StageState::FAILURE == workResult) {
+        _commonStats.failed = true;
+    }
+
+    return workResult;
+}
+
+PlanStage::StageState PlanStage::doWorkBatch(size_t maxWorks,
+                                             std::vector<WorkingSetID>* results,
+                                             WorkingSetID* out,
+                                             size_t* works) {
+    // Stages which have not been taught to batch may hand out results that reference storage
+    // engine memory which is only valid until their next unit of work, so stop at the first one.
+    while (*works < maxWorks) {
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        StageState state = doWork(&id);
+        ++(*works);
+
+        if (ADVANCED == state) {
+            results->push_back(id);
+            return ADVANCED;
+        } else if (NEED_TIME != state) {
+            *out = id;
+            return state;
+        }
+    }
+
+    return NEED_TIME;
+}
+
 void PlanStage::saveState() {
     ++_commonStats.yields;
     for (auto&& child : _children) {
@@ -193,6 +193,24 @@ public:
      */
     StageState work(WorkingSetID* out);
 
+    /**
+     * Performs up to 'maxWorks' units of work, appending every result produced along the way to
+     * 'results'. This is equivalent to calling work() repeatedly, but lets stages which support it
+     * produce a run of results with a single virtual call per stage rather than one per result.
+     * Stages that do not support batching produce at most one result per call.
+     *
+     * Returns ADVANCED if at least one result was appended and NEED_TIME if none was. Any other
+     * state (IS_EOF, NEED_YIELD, FAILURE) ends the batch early and is returned with '*out' set
+     * exactly as work() would set it. Results appended before such a state are still valid and
+     * must be consumed by the caller before it acts on the state.
+     *
+     * Results may point into storage-engine owned memory. Like the result of work(), they stay
+     * valid until the next call to work() or workBatch(), and storage engines whose cursors keep
+     * record data valid until they are saved extend that to the next saveState(). Callers which
+     * hold results across a yield must make them owned first.
+     */
+    StageState workBatch(size_t maxWorks, std::vector<WorkingSetID>* results, WorkingSetID* out);
+
     /**
      * Returns true if no more work can be done on the query / out of results.
      */
@@ -341,6 +359,21 @@ protected:
      */
     virtual StageState doWork(WorkingSetID* out) = 0;
 
+    /**
+     * Performs up to 'maxWorks' units of work. See comment at workBatch() above.
+     *
+     * Implementations add the number of units of work they performed to '*works'. Stages which
+     * simply pass through the results of a child's workBatch() may leave it untouched, in which
+     * case every result and every state which ended the batch counts as one unit of work.
+     *
+     * The default implementation calls doWork() until it produces a result, returns a state other
+     * than NEED_TIME, or has been called 'maxWorks' times.
+     */
+    virtual StageState doWorkBatch(size_t maxWorks,
+                                   std::vector<WorkingSetID>* results,
+                                   WorkingSetID* out,
+                                   size_t* works);
+
     /**
      * Saves any stage-specific state required to resume where it was if the underlying data
      * changes.
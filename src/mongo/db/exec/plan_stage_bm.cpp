@@ -0,0 +1,298 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/catalog/catalog_test_fixture.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/catalog_raii.h"
+#include "mongo/db/client.h"
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/index_scan.h"
+#include "mongo/db/exec/limit.h"
+#include "mongo/db/exec/projection.h"
+#include "mongo/db/exec/skip.h"
+#include "mongo/db/exec/sort.h"
+#include "mongo/db/exec/sort_key_generator.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/query/projection_parser.h"
+#include "mongo/db/query/query_bm_documents.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.plan_stage_bm");
+const BSONObj kSortPattern = BSON("a" << 1);
+const BSONObj kIndexKeyPattern = BSON("a" << 1);
+const uint64_t kMaxMemoryUsageBytes = 100 * 1024 * 1024;
+
+/**
+ * Holds the input documents in a collection of the ephemeralForTest storage engine, with an index
+ * on 'a', so that the stages which read them can be benchmarked against a real record store and
+ * index. Also owns the ExpressionContext shared by the stages of one benchmark.
+ */
+class PlanStageBenchmarkFixture : public CatalogTestFixture {
+public:
+    explicit PlanStageBenchmarkFixture(const benchmark::State& state) : _numDocs(state.range(0)) {
+        setUp();
+
+        ASSERT_OK(
+            storageInterface()->createCollection(operationContext(), kNss, CollectionOptions()));
+        {
+            AutoGetCollection autoColl(operationContext(), kNss, MODE_X);
+            WriteUnitOfWork wuow(operationContext());
+            ASSERT_OK(autoColl.getCollection()
+                          ->getIndexCatalog()
+                          ->createIndexOnEmptyCollection(
+                              operationContext(),
+                              BSON("v" << int(IndexDescriptor::kLatestIndexVersion) << "key"
+                                       << kIndexKeyPattern << "name"
+                                       << "a_1"))
+                          .getStatus());
+            wuow.commit();
+        }
+
+        std::vector<InsertStatement> inserts;
+        for (auto&& doc : makeBenchmarkDocuments(_numDocs, state.range(1))) {
+            inserts.emplace_back(doc);
+        }
+        ASSERT_OK(storageInterface()->insertDocuments(operationContext(), kNss, inserts));
+
+        _autoColl.emplace(operationContext(), kNss, MODE_IS);
+        _expCtx = make_intrusive<ExpressionContext>(operationContext(), nullptr, kNss);
+    }
+
+    ~PlanStageBenchmarkFixture() {
+        _expCtx.reset();
+        _autoColl.reset();
+        tearDown();
+    }
+
+    OperationContext* opCtx() {
+        return operationContext();
+    }
+
+    const boost::intrusive_ptr<ExpressionContext>& expCtx() const {
+        return _expCtx;
+    }
+
+    size_t numDocs() const {
+        return _numDocs;
+    }
+
+    std::unique_ptr<CollectionScan> makeCollectionScan(WorkingSet* ws) {
+        return std::make_unique<CollectionScan>(
+            opCtx(), _autoColl->getCollection(), CollectionScanParams(), ws, nullptr);
+    }
+
+    /**
+     * Returns an IndexScan over every key of the index on 'a'.
+     */
+    std::unique_ptr<IndexScan> makeIndexScan(WorkingSet* ws) {
+        std::vector<const IndexDescriptor*> indexes;
+        _autoColl->getCollection()->getIndexCatalog()->findIndexesByKeyPattern(
+            opCtx(), kIndexKeyPattern, false, &indexes);
+        invariant(indexes.size() == 1);
+
+        IndexScanParams params(opCtx(), indexes[0]);
+        params.bounds.isSimpleRange = true;
+        params.bounds.startKey = BSON("" << MINKEY);
+        params.bounds.endKey = BSON("" << MAXKEY);
+        params.bounds.boundInclusion = BoundInclusion::kIncludeBothStartAndEndKeys;
+        return std::make_unique<IndexScan>(opCtx(), std::move(params), ws, nullptr);
+    }
+
+    std::unique_ptr<FetchStage> makeFetch(WorkingSet* ws) {
+        return std::make_unique<FetchStage>(
+            opCtx(), ws, makeIndexScan(ws), nullptr, _autoColl->getCollection());
+    }
+
+private:
+    void _doTest() final {}
+
+    const size_t _numDocs;
+    boost::optional<AutoGetCollection> _autoColl;
+    boost::intrusive_ptr<ExpressionContext> _expCtx;
+};
+
+/**
+ * Works 'root' until EOF, freeing each result, and returns the number of results it produced.
+ */
+size_t drain(PlanStage* root, WorkingSet* ws) {
+    size_t numResults = 0;
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    for (auto state = root->work(&id); state != PlanStage::IS_EOF; state = root->work(&id)) {
+        if (state == PlanStage::ADVANCED) {
+            ws->free(id);
+            ++numResults;
+        }
+    }
+    return numResults;
+}
+
+/**
+ * Like drain(), but asks 'root' for up to 'batchSize' units of work at a time through
+ * PlanStage::workBatch().
+ */
+size_t drainBatches(PlanStage* root, WorkingSet* ws, size_t batchSize) {
+    size_t numResults = 0;
+    std::vector<WorkingSetID> results;
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    for (;;) {
+        results.clear();
+        auto state = root->workBatch(batchSize, &results, &id);
+        for (auto result : results) {
+            ws->free(result);
+        }
+        numResults += results.size();
+        if (state == PlanStage::IS_EOF) {
+            return numResults;
+        }
+    }
+}
+
+/**
+ * Runs the plan built by 'makePlan' once per iteration and reports how many documents of the
+ * collection per second it consumed. The plan is drained one result at a time when 'batchSize' is
+ * 0, and in batches of that many units of work otherwise.
+ */
+template <typename MakePlan>
+void runPlan(benchmark::State& state, MakePlan makePlan, size_t batchSize = 0) {
+    PlanStageBenchmarkFixture fixture(state);
+    for (auto _ : state) {
+        WorkingSet ws;
+        auto root = makePlan(fixture, &ws);
+        benchmark::DoNotOptimize(batchSize ? drainBatches(root.get(), &ws, batchSize)
+                                           : drain(root.get(), &ws));
+    }
+    state.SetItemsProcessed(state.iterations() * fixture.numDocs());
+}
+
+// Scanning the collection alone, as a baseline for the benchmarks below. Batched results are only
+// copied when the record store cannot keep them valid until the scan is saved.
+void BM_CollectionScan(benchmark::State& state) {
+    runPlan(state,
+            [](PlanStageBenchmarkFixture& fixture, WorkingSet* ws) {
+                return fixture.makeCollectionScan(ws);
+            },
+            state.range(2));
+}
+
+void BM_IndexScan(benchmark::State& state) {
+    runPlan(state,
+            [](PlanStageBenchmarkFixture& fixture, WorkingSet* ws) {
+                return fixture.makeIndexScan(ws);
+            },
+            state.range(2));
+}
+
+// Fetches the document of every key of the index scan, in the order of the index.
+void BM_Fetch(benchmark::State& state) {
+    runPlan(state,
+            [](PlanStageBenchmarkFixture& fixture, WorkingSet* ws) {
+                return fixture.makeFetch(ws);
+            },
+            state.range(2));
+}
+
+void BM_Limit(benchmark::State& state) {
+    runPlan(state, [](PlanStageBenchmarkFixture& fixture, WorkingSet* ws) {
+        return std::make_unique<LimitStage>(
+            fixture.opCtx(), fixture.numDocs() / 2, ws, fixture.makeCollectionScan(ws));
+    });
+}
+
+void BM_Skip(benchmark::State& state) {
+    runPlan(state, [](PlanStageBenchmarkFixture& fixture, WorkingSet* ws) {
+        return std::make_unique<SkipStage>(
+            fixture.opCtx(), fixture.numDocs() / 2, ws, fixture.makeCollectionScan(ws));
+    });
+}
+
+void BM_Projection(benchmark::State& state) {
+    const BSONObj projObj = BSON("_id" << 0 << "a" << 1 << "f0" << 1);
+    runPlan(state, [&](PlanStageBenchmarkFixture& fixture, WorkingSet* ws) {
+        auto projection = projection_ast::parse(
+            fixture.expCtx(), projObj, ProjectionPolicies::findProjectionPolicies());
+        return std::make_unique<ProjectionStageDefault>(
+            fixture.expCtx(), projObj, &projection, ws, fixture.makeCollectionScan(ws));
+    });
+}
+
+// A blocking sort of the whole collection when the limit is 0, and a top-k sort otherwise.
+void runSort(benchmark::State& state, uint64_t limit) {
+    runPlan(state, [&](PlanStageBenchmarkFixture& fixture, WorkingSet* ws) {
+        auto sortKeyGen = std::make_unique<SortKeyGeneratorStage>(
+            fixture.expCtx(), fixture.makeCollectionScan(ws), ws, kSortPattern);
+        return std::make_unique<SortStageDefault>(fixture.expCtx(),
+                                                  ws,
+                                                  SortPattern{kSortPattern, fixture.expCtx()},
+                                                  limit,
+                                                  kMaxMemoryUsageBytes,
+                                                  false,  // addSortKeyMetadata
+                                                  std::move(sortKeyGen));
+    });
+}
+
+void BM_Sort(benchmark::State& state) {
+    runSort(state, 0);
+}
+
+void BM_SortWithLimit(benchmark::State& state) {
+    runSort(state, 10);
+}
+
+// Arguments are the number of documents and the number of additional fields per document, followed
+// by the number of units of work asked for per call to workBatch(), or 0 to call work() instead.
+void documentShapesAndBatchSizes(benchmark::internal::Benchmark* bm) {
+    for (int64_t numFields : {0, 10, 50}) {
+        for (int64_t batchSize : {0, 16, 128}) {
+            bm->Args({10 * 1000, numFields, batchSize});
+        }
+    }
+}
+
+BENCHMARK(BM_CollectionScan)->Apply(documentShapesAndBatchSizes);
+BENCHMARK(BM_IndexScan)->Apply(documentShapesAndBatchSizes);
+BENCHMARK(BM_Fetch)->Apply(documentShapesAndBatchSizes);
+BENCHMARK(BM_Limit)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_Skip)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_Projection)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_Sort)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_SortWithLimit)->Apply(benchmarkDocumentShapes);
+
+}  // namespace
+}  // namespace mongo
@@ -162,6 +162,36 @@ PlanStage::StageState ProjectionStage::doWork(WorkingSetID* out) {
     return status;
 }
 
+PlanStage::StageState ProjectionStage::doWorkBatch(size_t maxWorks,
+                                                  std::vector<WorkingSetID>* results,
+                                                  WorkingSetID* out,
+                                                  size_t* works) {
+    const size_t numResultsBefore = results->size();
+    StageState status = child()->workBatch(maxWorks, results, out);
+
+    for (size_t i = numResultsBefore; i < results->size(); ++i) {
+        Status projStatus = transform(_ws.get((*results)[i]));
+        if (!projStatus.isOK()) {
+            LOGV2_WARNING(4765000,
+                          "Couldn't execute projection, status = {projStatus}",
+                          "projStatus"_attr = redact(projStatus));
+            // Results from this one onwards will never be returned, nor will the state which
+            // ended our child's batch.
+            for (size_t j = i; j < results->size(); ++j) {
+                _ws.free((*results)[j]);
+            }
+            if (PlanStage::FAILURE == status) {
+                _ws.free(*out);
+            }
+            results->resize(i);
+            *out = WorkingSetCommon::allocateStatusMember(&_ws, projStatus);
+            return PlanStage::FAILURE;
+        }
+    }
+
+    return status;
+}
+
 std::unique_ptr<PlanStageStats> ProjectionStage::getStats() {
     _commonStats.isEOF = isEOF();
     auto ret = std::make_unique<PlanStageStats>(_commonStats, stageType());
@@ -52,6 +52,10 @@ protected:
 public:
     bool isEOF() final;
     StageState doWork(WorkingSetID* out) final;
+    StageState doWorkBatch(size_t maxWorks,
+                           std::vector<WorkingSetID>* results,
+                           WorkingSetID* out,
+                           size_t* works) final;
 
     std::unique_ptr<PlanStageStats> getStats() final;
 
@@ -73,7 +77,7 @@ private:
      */
     virtual Status transform(WorkingSetMember* member) const = 0;
 
-    // Used to retrieve a WorkingSetMember as part of 'doWork()'.
+    // Used to retrieve a WorkingSetMember as part of 'doWork()' and 'doWorkBatch()'.
     WorkingSet& _ws;
 
     // Populated by 'getStats()'.
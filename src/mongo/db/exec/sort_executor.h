@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/db/exec/document_value/document.h"
+#include "mongo/db/exec/document_value/value_comparator.h"
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/exec/sort_key_comparator.h"
 #include "mongo/db/exec/working_set.h"
@@ -131,6 +132,33 @@ public:
         _stats.totalDataSizeBytes += data.memUsageForSorter();
     }
 
+    /**
+     * Returns true if any data item whose sort key starts with 'leadingKeyComponent', the sort key
+     * component for the first part of the sort pattern, would be discarded by 'add()' as it cannot
+     * be part of the results of a top-k sort. This lets callers skip computing the rest of the
+     * sort key. Should only be called before 'loadingDone()' is called.
+     */
+    bool isWorseThanCutoff(const Value& leadingKeyComponent) const {
+        if (!_sorter) {
+            return false;
+        }
+
+        const Value* cutoffKey = _sorter->cutoffKey();
+        if (!cutoffKey) {
+            return false;
+        }
+
+        // Data is discarded if its whole sort key is not better than the cutoff key, so when only
+        // the first component is known, it needs to be strictly worse.
+        const bool isSingleElementKey = _sortPattern.isSingleElementKey();
+        int cmp = ValueComparator().compare(leadingKeyComponent,
+                                            isSingleElementKey ? *cutoffKey : (*cutoffKey)[0]);
+        if (!_sortPattern[0].isAscending) {
+            cmp = -cmp;
+        }
+        return isSingleElementKey ? cmp >= 0 : cmp > 0;
+    }
+
     /**
      * Signals to the sort executor that there will be no more input documents.
      */
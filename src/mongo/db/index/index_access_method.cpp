@@ -45,6 +45,7 @@
 #include "mongo/db/curop.h"
 #include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/operation_context.h"
@@ -53,7 +54,11 @@
 #include "mongo/db/storage/durable_catalog.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/logv2/log.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/scopeguard.h"
 
@@ -86,8 +91,59 @@ bool isMultikeyFromPaths(const MultikeyPaths& multikeyPaths) {
 std::vector<KeyString::Value> asVector(const KeyStringSet& keySet) {
     return {keySet.begin(), keySet.end()};
 }
+
+// The threads on which index builds and validation generate keys. The pool is started on first use
+// and shut down with the ServiceContext.
+struct KeyGenerationThreads {
+    Mutex mutex = MONGO_MAKE_LATCH("KeyGenerationThreads::mutex");
+    std::unique_ptr<ThreadPool> pool;
+};
+
+const auto getKeyGenerationThreads = ServiceContext::declareDecoration<KeyGenerationThreads>();
+
+ThreadPool* getKeyGenerationPool(ServiceContext* serviceContext) {
+    auto& threads = getKeyGenerationThreads(serviceContext);
+    stdx::lock_guard<Latch> lk(threads.mutex);
+    if (!threads.pool) {
+        ThreadPool::Options options;
+        options.poolName = "IndexKeyGenerationThreadPool";
+        options.threadNamePrefix = "IndexKeyGeneration-";
+        options.minThreads = 0;
+        options.maxThreads = std::max(1u, ProcessInfo::getNumCores());
+        threads.pool = std::make_unique<ThreadPool>(std::move(options));
+        threads.pool->startup();
+    }
+    return threads.pool.get();
+}
 }  // namespace
 
+void IndexAccessMethod::runKeyGenerationTasks(OperationContext* opCtx,
+                                              const std::vector<std::function<void()>>& tasks) {
+    if (tasks.empty()) {
+        return;
+    }
+
+    auto pool = getKeyGenerationPool(opCtx->getServiceContext());
+    auto mutex = MONGO_MAKE_LATCH("IndexAccessMethod::runKeyGenerationTasks");
+    stdx::condition_variable finishedCV;
+    size_t numRunning = tasks.size() - 1;
+    for (size_t i = 1; i < tasks.size(); ++i) {
+        // If the pool is shutting down, the task runs here instead.
+        pool->schedule([&, i](Status) {
+            tasks[i]();
+            stdx::lock_guard<Latch> lk(mutex);
+            if (--numRunning == 0) {
+                finishedCV.notify_all();
+            }
+        });
+    }
+    tasks[0]();
+
+    // The tasks refer to this stack frame, so wait for them even if the operation is interrupted.
+    stdx::unique_lock<Latch> lk(mutex);
+    finishedCV.wait(lk, [&] { return numRunning == 0; });
+}
+
 struct BtreeExternalSortComparison {
     typedef std::pair<KeyString::Value, mongo::NullValue> Data;
     int operator()(const Data& l, const Data& r) const {
@@ -196,6 +252,66 @@ Status AbstractIndexAccessMethod::insertKeys(OperationContext* opCtx,
     return Status::OK();
 }
 
+Status AbstractIndexAccessMethod::insertRecords(OperationContext* opCtx,
+                                                const std::vector<BsonRecord>& records,
+                                                const InsertDeleteOptions& options,
+                                                int64_t* numInserted) {
+    invariant(options.fromIndexBuilder || !_indexCatalogEntry->isHybridBuilding());
+    invariant(!_descriptor->unique());
+
+    std::vector<KeyString::Value> keys;
+    KeyStringSet multikeyMetadataKeys;
+    std::vector<MultikeyPaths> multikeyPathsToSet;
+    int64_t numKeys = 0;
+    for (const auto& record : records) {
+        KeyStringSet recordKeys;
+        KeyStringSet recordMultikeyMetadataKeys;
+        MultikeyPaths multikeyPaths;
+
+        getKeys(*record.docPtr,
+                options.getKeysMode,
+                GetKeysContext::kReadOrAddKeys,
+                &recordKeys,
+                &recordMultikeyMetadataKeys,
+                &multikeyPaths,
+                record.id,
+                kNoopOnSuppressedErrorFn);
+
+        if (shouldMarkIndexAsMultikey(
+                recordKeys.size(),
+                {recordMultikeyMetadataKeys.begin(), recordMultikeyMetadataKeys.end()},
+                multikeyPaths)) {
+            multikeyPathsToSet.push_back(std::move(multikeyPaths));
+        }
+        numKeys += recordKeys.size() + recordMultikeyMetadataKeys.size();
+        keys.insert(keys.end(), recordKeys.begin(), recordKeys.end());
+        multikeyMetadataKeys.insert(recordMultikeyMetadataKeys.begin(),
+                                    recordMultikeyMetadataKeys.end());
+    }
+
+    // Each record's keys are already sorted, but inserting the keys of all the records in order
+    // means neighbouring inserts land on the same leaf pages.
+    std::sort(keys.begin(), keys.end());
+
+    // Multikey metadata keys all point to 'kMultikeyMetadataKeyId', so records generating the same
+    // metadata key share one entry.
+    Status status = _newInterface->insertBatch(opCtx, keys, true /* dupsAllowed */);
+    if (status.isOK()) {
+        status = _newInterface->insertBatch(
+            opCtx, {multikeyMetadataKeys.begin(), multikeyMetadataKeys.end()}, true);
+    }
+    if (!status.isOK()) {
+        return status;
+    }
+
+    *numInserted += numKeys;
+
+    for (const auto& multikeyPaths : multikeyPathsToSet) {
+        _indexCatalogEntry->setMultikey(opCtx, multikeyPaths);
+    }
+    return Status::OK();
+}
+
 void AbstractIndexAccessMethod::removeOneKey(OperationContext* opCtx,
                                              const KeyString::Value& keyString,
                                              const RecordId& loc,
@@ -463,6 +579,11 @@ public:
                   const RecordId& loc,
                   const InsertDeleteOptions& options) final;
 
+    Status insertBatch(OperationContext* opCtx,
+                       const std::vector<BsonRecord>& records,
+                       const InsertDeleteOptions& options,
+                       size_t numThreads) final;
+
     const MultikeyPaths& getMultikeyPaths() const final;
 
     bool isMultikey() const final;
@@ -476,6 +597,20 @@ public:
     int64_t getKeysInserted() const final;
 
 private:
+    /**
+     * Records a document whose key generation error was suppressed as "skipped", so the index
+     * builder can retry it at a point when data is consistent.
+     */
+    void _recordSuppressedError(OperationContext* opCtx,
+                                const Status& status,
+                                const BSONObj& obj,
+                                const RecordId& loc);
+
+    /**
+     * Adds the keys generated for one document to the Sorter and updates the multikey state.
+     */
+    void _addKeys(const KeyStringSet& keys, const MultikeyPaths& multikeyPaths);
+
     std::unique_ptr<Sorter> _sorter;
     IndexCatalogEntry* _indexCatalogEntry;
     int64_t _keysInserted = 0;
@@ -493,6 +628,14 @@ private:
     KeyStringSet _multikeyMetadataKeys;
 };
 
+bool AbstractIndexAccessMethod::canGenerateKeysConcurrently() const {
+    // Other index types, and collators, rely on libraries that are not known to be safe to call
+    // from several threads at once.
+    const auto& accessMethodName = _descriptor->getAccessMethodName();
+    return (accessMethodName == IndexNames::BTREE || accessMethodName == IndexNames::HASHED) &&
+        !_indexCatalogEntry->getCollator();
+}
+
 std::unique_ptr<IndexAccessMethod::BulkBuilder> AbstractIndexAccessMethod::initiateBulk(
     size_t maxMemoryUsageBytes) {
     return std::make_unique<BulkBuilderImpl>(_indexCatalogEntry, _descriptor, maxMemoryUsageBytes);
@@ -529,24 +672,103 @@ Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCt
             &multikeyPaths,
             loc,
             [&](Status status, const BSONObj&, boost::optional<RecordId>) {
-                // If a key generation error was suppressed, record the document as "skipped" so the
-                // index builder can retry at a point when data is consistent.
-                auto interceptor = _indexCatalogEntry->indexBuildInterceptor();
-                if (interceptor && interceptor->getSkippedRecordTracker()) {
-                    LOGV2_DEBUG(20684,
-                                1,
-                                "Recording suppressed key generation error to retry later: "
-                                "{status} on {loc}: {obj}",
-                                "status"_attr = status,
-                                "loc"_attr = loc,
-                                "obj"_attr = redact(obj));
-                    interceptor->getSkippedRecordTracker()->record(opCtx, loc);
-                }
+                _recordSuppressedError(opCtx, status, obj, loc);
             });
     } catch (...) {
         return exceptionToStatus();
     }
 
+    _addKeys(keys, multikeyPaths);
+    return Status::OK();
+}
+
+Status AbstractIndexAccessMethod::BulkBuilderImpl::insertBatch(
+    OperationContext* opCtx,
+    const std::vector<BsonRecord>& records,
+    const InsertDeleteOptions& options,
+    size_t numThreads) {
+    // The output of key generation for one document. Suppressed errors are only remembered here,
+    // since recording them writes to storage and must happen on this operation's thread.
+    struct GeneratedKeys {
+        KeyStringSet keys;
+        KeyStringSet multikeyMetadataKeys;
+        MultikeyPaths multikeyPaths;
+        boost::optional<Status> suppressedError;
+        Status status = Status::OK();
+    };
+    std::vector<GeneratedKeys> generated(records.size());
+
+    auto generateKeys = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            auto& out = generated[i];
+            try {
+                _indexCatalogEntry->accessMethod()->getKeys(
+                    *records[i].docPtr,
+                    options.getKeysMode,
+                    GetKeysContext::kReadOrAddKeys,
+                    &out.keys,
+                    &out.multikeyMetadataKeys,
+                    &out.multikeyPaths,
+                    records[i].id,
+                    [&](Status status, const BSONObj&, boost::optional<RecordId>) {
+                        out.suppressedError = std::move(status);
+                    });
+            } catch (...) {
+                out.status = exceptionToStatus();
+            }
+        }
+    };
+
+    if (!_indexCatalogEntry->accessMethod()->canGenerateKeysConcurrently()) {
+        numThreads = 1;
+    }
+    numThreads = std::max(size_t(1), std::min(numThreads, records.size()));
+    const size_t chunkSize = (records.size() + numThreads - 1) / numThreads;
+
+    std::vector<std::function<void()>> tasks;
+    for (size_t begin = 0; begin < records.size(); begin += chunkSize) {
+        tasks.push_back([&, begin] {
+            generateKeys(begin, std::min(begin + chunkSize, records.size()));
+        });
+    }
+    runKeyGenerationTasks(opCtx, tasks);
+
+    for (size_t i = 0; i < records.size(); ++i) {
+        auto& out = generated[i];
+        if (!out.status.isOK()) {
+            return out.status;
+        }
+        if (out.suppressedError) {
+            _recordSuppressedError(opCtx, *out.suppressedError, *records[i].docPtr, records[i].id);
+        }
+        _multikeyMetadataKeys.insert(out.multikeyMetadataKeys.begin(),
+                                     out.multikeyMetadataKeys.end());
+        _addKeys(out.keys, out.multikeyPaths);
+    }
+    return Status::OK();
+}
+
+void AbstractIndexAccessMethod::BulkBuilderImpl::_recordSuppressedError(OperationContext* opCtx,
+                                                                        const Status& status,
+                                                                        const BSONObj& obj,
+                                                                        const RecordId& loc) {
+    // If a key generation error was suppressed, record the document as "skipped" so the index
+    // builder can retry at a point when data is consistent.
+    auto interceptor = _indexCatalogEntry->indexBuildInterceptor();
+    if (interceptor && interceptor->getSkippedRecordTracker()) {
+        LOGV2_DEBUG(20684,
+                    1,
+                    "Recording suppressed key generation error to retry later: "
+                    "{status} on {loc}: {obj}",
+                    "status"_attr = status,
+                    "loc"_attr = loc,
+                    "obj"_attr = redact(obj));
+        interceptor->getSkippedRecordTracker()->record(opCtx, loc);
+    }
+}
+
+void AbstractIndexAccessMethod::BulkBuilderImpl::_addKeys(const KeyStringSet& keys,
+                                                          const MultikeyPaths& multikeyPaths) {
     if (!multikeyPaths.empty()) {
         if (_indexMultikeyPaths.empty()) {
             _indexMultikeyPaths = multikeyPaths;
@@ -568,8 +790,6 @@ Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCt
             keys.size(),
             {_multikeyMetadataKeys.begin(), _multikeyMetadataKeys.end()},
             multikeyPaths);
-
-    return Status::OK();
 }
 
 const MultikeyPaths& AbstractIndexAccessMethod::BulkBuilderImpl::getMultikeyPaths() const {
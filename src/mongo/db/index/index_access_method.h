@@ -47,6 +47,7 @@ namespace mongo {
 
 class BSONObjBuilder;
 class MatchExpression;
+struct BsonRecord;
 struct UpdateTicket;
 struct InsertResult;
 struct InsertDeleteOptions;
@@ -98,6 +99,17 @@ public:
                               const InsertDeleteOptions& options,
                               InsertResult* result) = 0;
 
+    /**
+     * Equivalent to calling insert() on each of 'records', except that the keys of all the
+     * records are sorted and inserted in a single pass over the index. Only supported for indexes
+     * which allow duplicates. The caller is responsible for setting the timestamp shared by all of
+     * 'records', if any. Adds the number of keys inserted to 'numInserted'.
+     */
+    virtual Status insertRecords(OperationContext* opCtx,
+                                 const std::vector<BsonRecord>& records,
+                                 const InsertDeleteOptions& options,
+                                 int64_t* numInserted) = 0;
+
     /**
      * Analogous to insertKeys above, but remove the keys instead of inserting them.
      * 'numDeleted' will be set to the number of keys removed from the index for the provided keys.
@@ -210,6 +222,16 @@ public:
                               const RecordId& loc,
                               const InsertDeleteOptions& options) = 0;
 
+        /**
+         * Equivalent to calling insert() on each of 'records' in order, except that keys for the
+         * batch may be generated on up to 'numThreads' threads when the index type allows it.
+         * Keys are still added to the Sorter in the order of 'records'.
+         */
+        virtual Status insertBatch(OperationContext* opCtx,
+                                   const std::vector<BsonRecord>& records,
+                                   const InsertDeleteOptions& options,
+                                   size_t numThreads) = 0;
+
         virtual const MultikeyPaths& getMultikeyPaths() const = 0;
 
         virtual bool isMultikey() const = 0;
@@ -351,6 +373,28 @@ public:
      * documents into an index, except for testing purposes.
      */
     virtual SortedDataInterface* getSortedDataInterface() const = 0;
+
+    //
+    // Key generation on several threads
+    //
+
+    // Limits on the number of documents, and on their total size, buffered so that their keys can
+    // be generated as a batch on several threads.
+    static constexpr size_t kMaxKeyGenerationBatchDocs = 1024;
+    static constexpr size_t kMaxKeyGenerationBatchBytes = 16 * 1024 * 1024;
+
+    /**
+     * Returns true if getKeys() may be called for this index on several threads at once.
+     */
+    virtual bool canGenerateKeysConcurrently() const = 0;
+
+    /**
+     * Runs each of 'tasks' and returns once all of them have finished. The first task runs on this
+     * thread, and the others on a pool of key generation threads shared by every operation. The
+     * tasks must not throw.
+     */
+    static void runKeyGenerationTasks(OperationContext* opCtx,
+                                      const std::vector<std::function<void()>>& tasks);
 };
 
 /**
@@ -463,6 +507,11 @@ public:
                       const InsertDeleteOptions& options,
                       InsertResult* result) final;
 
+    Status insertRecords(OperationContext* opCtx,
+                         const std::vector<BsonRecord>& records,
+                         const InsertDeleteOptions& options,
+                         int64_t* numInserted) final;
+
     Status removeKeys(OperationContext* opCtx,
                       const std::vector<KeyString::Value>& keys,
                       const RecordId& loc,
@@ -506,6 +555,8 @@ public:
 
     std::unique_ptr<BulkBuilder> initiateBulk(size_t maxMemoryUsageBytes) final;
 
+    bool canGenerateKeysConcurrently() const final;
+
     Status commitBulk(OperationContext* opCtx,
                       BulkBuilder* bulk,
                       bool dupsAllowed,
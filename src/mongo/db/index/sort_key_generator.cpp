@@ -238,6 +238,15 @@ StatusWith<Value> SortKeyGenerator::extractKeyPart(
     return plainKey.missing() ? Value{BSONNULL} : getCollationComparisonKey(plainKey);
 }
 
+boost::optional<Value> SortKeyGenerator::computeLeadingSortKeyComponent(
+    const Document& doc) const {
+    auto key = extractKeyPart(doc, doc.metadata(), _sortPattern[0]);
+    if (!key.isOK()) {
+        return boost::none;
+    }
+    return std::move(key.getValue());
+}
+
 StatusWith<Value> SortKeyGenerator::extractKeyFast(const Document& doc,
                                                    const DocumentMetadataFields& metadata) const {
     if (_sortPattern.isSingleElementKey()) {
@@ -71,6 +71,13 @@ public:
         return computeSortKeyFromDocument(doc, doc.metadata());
     }
 
+    /**
+     * Returns the component of the sort key for 'doc' which corresponds to the first part of the
+     * sort pattern, or boost::none if it cannot be computed on its own because 'doc' has an array
+     * along its path. When the sort pattern has just one component, this is the whole sort key.
+     */
+    boost::optional<Value> computeLeadingSortKeyComponent(const Document& doc) const;
+
     bool isSingleElementKey() const {
         return _sortPattern.isSingleElementKey();
     }
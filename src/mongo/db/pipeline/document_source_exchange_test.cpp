@@ -34,7 +34,10 @@
 #include "mongo/db/hasher.h"
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/document_source_exchange.h"
+#include "mongo/db/pipeline/document_source_local_exchange.h"
 #include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/parallel_pipeline_workers.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/executor/network_interface_factory.h"
 #include "mongo/executor/thread_pool_task_executor.h"
@@ -45,6 +48,7 @@
 #include "mongo/util/clock_source_mock.h"
 #include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/system_clock_source.h"
 #include "mongo/util/time_support.h"
 
@@ -632,6 +636,76 @@ TEST_F(DocumentSourceExchangeTest, RangeRandomHashExchangeNConsumer) {
     ASSERT_EQ(nDocs, processedDocs.load());
 }
 
+TEST_F(DocumentSourceExchangeTest, LocalExchangeRunsConsumerPipelinesInParallel) {
+    const size_t nDocs = 500;
+    const size_t nKeys = 10;
+    const size_t nConsumers = 3;
+
+    auto source = DocumentSourceMock::createForTest();
+    for (size_t i = 0; i < nDocs; ++i) {
+        source->emplace_back(Document{{"a", static_cast<int>(i % nKeys)}});
+    }
+
+    ExchangeSpec spec;
+    spec.setPolicy(ExchangePolicyEnum::kKeyRange);
+    spec.setKey(BSON("a"
+                     << "hashed"));
+    spec.setBoundaries(std::vector<BSONObj>{BSON("a" << MINKEY),
+                                            BSON("a" << -(1LL << 62)),
+                                            BSON("a" << (1LL << 62)),
+                                            BSON("a" << MAXKEY)});
+    spec.setConsumers(nConsumers);
+    spec.setBufferSize(1024);
+
+    // The exchange input needs an ExpressionContext of its own, as the exchange detaches it from
+    // its OperationContext.
+    boost::intrusive_ptr<Exchange> ex = new Exchange(
+        std::move(spec), Pipeline::create({source}, getExpCtx()->copyWith(kTestNss)));
+    auto reservation = ParallelPipelineWorkers::tryReserveThreads(getServiceContext(), nConsumers);
+    ASSERT(reservation);
+    auto localExchange =
+        DocumentSourceLocalExchange::create(getExpCtx(),
+                                            ex,
+                                            {fromjson("{$group: {_id: '$a', count: {$sum: 1}}}")},
+                                            std::move(*reservation));
+
+    // Every group is computed by a single consumer, and therefore returned exactly once.
+    std::map<int, long long> counts;
+    for (auto next = localExchange->getNext(); next.isAdvanced();
+         next = localExchange->getNext()) {
+        auto doc = next.releaseDocument();
+        ASSERT(counts.emplace(doc["_id"].getInt(), doc["count"].coerceToLong()).second);
+    }
+    localExchange->dispose();
+
+    ASSERT_EQ(nKeys, counts.size());
+    for (auto&& [key, count] : counts) {
+        ASSERT_EQ(static_cast<long long>(nDocs / nKeys), count);
+    }
+}
+
+TEST_F(DocumentSourceExchangeTest, PipelineWorkerThreadsAreNotOverReserved) {
+    const int originalMaxThreads = internalQueryMaxPipelineWorkerThreads.load();
+    internalQueryMaxPipelineWorkerThreads.store(4);
+    ON_BLOCK_EXIT([&] { internalQueryMaxPipelineWorkerThreads.store(originalMaxThreads); });
+
+    auto first = ParallelPipelineWorkers::tryReserveThreads(getServiceContext(), 3);
+    ASSERT(first);
+    ASSERT_EQ(3U, first->numThreads());
+
+    // Only one thread is left, so a stage needing two of them must run without workers.
+    ASSERT_FALSE(ParallelPipelineWorkers::tryReserveThreads(getServiceContext(), 2));
+    {
+        auto second = ParallelPipelineWorkers::tryReserveThreads(getServiceContext(), 1);
+        ASSERT(second);
+        ASSERT_FALSE(ParallelPipelineWorkers::tryReserveThreads(getServiceContext(), 1));
+    }
+
+    // Destroying a reservation gives its threads back.
+    first.reset();
+    ASSERT(ParallelPipelineWorkers::tryReserveThreads(getServiceContext(), 4));
+}
+
 TEST_F(DocumentSourceExchangeTest, RejectNoConsumers) {
     BSONObj spec = BSON("policy"
                         << "broadcast"
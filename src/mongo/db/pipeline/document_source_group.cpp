@@ -144,6 +144,12 @@ DocumentSource::GetNextResult DocumentSourceGroup::doGetNext() {
         accum->reset();  // Prep accumulators for a new group.
     }
 
+    // With hash-partitioned spilling, the groups which stayed in memory are returned first, then
+    // each spilled partition is re-aggregated and returned in turn.
+    while (currentGroupsExhausted() && !_spilledPartitions.empty()) {
+        loadNextSpilledPartition();
+    }
+
     if (_spilled) {
         return getNextSpilled();
     } else {
@@ -157,25 +163,13 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
         return GetNextResult::makeEOF();
 
     _currentId = _firstPartOfNextGroup.first;
-    const size_t numAccumulators = _accumulatedFields.size();
     while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
         // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
         // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
-            case 1:                 // Single accumulators serialize as a single Value.
-                _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
-            case 0:  // No accumulators so no Values.
-                break;
-            default: {  // Multiple accumulators serialize as an array of Values.
-                const vector<Value>& accumulatorStates = _firstPartOfNextGroup.second.getArray();
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators[i]->process(accumulatorStates[i], true);
-                }
-            }
-        }
+        processSpilledState(_firstPartOfNextGroup.second, &_currentAccumulators);
 
         if (!_sorterIterator->more()) {
-            dispose();
+            doneWithCurrentGroups();
             break;
         }
 
@@ -193,15 +187,32 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
     Document out = makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
 
     if (++groupsIterator == _groups->end())
-        dispose();
+        doneWithCurrentGroups();
 
     return std::move(out);
 }
 
+bool DocumentSourceGroup::currentGroupsExhausted() const {
+    return _spilled ? !_sorterIterator : _groups->empty();
+}
+
+void DocumentSourceGroup::doneWithCurrentGroups() {
+    if (_spilledPartitions.empty()) {
+        dispose();
+        return;
+    }
+
+    // Free the groups we have returned, but keep the spilled partitions which are still to come.
+    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    groupsIterator = _groups->end();
+    _sorterIterator.reset();
+}
+
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    _spilledPartitions.clear();
 
     // Make us look done.
     groupsIterator = _groups->end();
@@ -332,17 +343,23 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _initialized(false),
       _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
       _spilled(false),
-      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
+      _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos),
+      _numSpillPartitions(_allowDiskUse ? internalDocumentSourceGroupHashSpillPartitions.load()
+                                        : 0) {
     if (!pExpCtx->inMongos && (pExpCtx->allowDiskUse || kDebugBuild)) {
         // We spill to disk in debug mode, regardless of allowDiskUse, to stress the system.
         _fileName = pExpCtx->tempDir + "/" + nextFileName();
     }
+    _partitionMemoryUsageBytes.resize(_numSpillPartitions);
 }
 
 DocumentSourceGroup::~DocumentSourceGroup() {
     if (_ownsFileDeletion) {
         DESTRUCTOR_GUARD(boost::filesystem::remove(_fileName));
     }
+    if (!_partitionFileName.empty()) {
+        DESTRUCTOR_GUARD(boost::filesystem::remove(_partitionFileName));
+    }
 }
 
 void DocumentSourceGroup::addAccumulator(AccumulationStatement accumulationStatement) {
@@ -472,8 +489,12 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
                     "Exceeded memory limit for $group, but didn't allow external sort."
                     " Pass allowDiskUse:true to opt in.",
                     _allowDiskUse);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
+            if (_numSpillPartitions > 0) {
+                spillPartitions();
+            } else {
+                _sortedFiles.push_back(spill());
+                _memoryUsageBytes = 0;
+            }
         }
 
         // We release the result document here so that it does not outlive the end of this loop
@@ -481,27 +502,9 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         auto rootDocument = input.releaseDocument();
         Value id = computeId(rootDocument);
 
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                group.push_back(accumulatedField.makeAccumulator());
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
-        }
+        const size_t oldMemoryUsageBytes = _memoryUsageBytes;
+        bool inserted;
+        Accumulators& group = findOrCreateGroup(id, &inserted);
 
         /* tickle all the accumulators for the group we found */
         dassert(numAccumulators == group.size());
@@ -514,6 +517,12 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
             _memoryUsageBytes += group[i]->memUsageForSorter();
         }
 
+        if (_numSpillPartitions > 0) {
+            // Charge the net change in memory usage for this group to its partition as well.
+            _partitionMemoryUsageBytes[partitionFor(id)] +=
+                _memoryUsageBytes - oldMemoryUsageBytes;
+        }
+
         if (kDebugBuild && !storageGlobalParams.readOnly) {
             // In debug mode, spill every time we have a duplicate id to stress merge logic.
             if (!inserted &&                 // is a dup
@@ -536,30 +545,18 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
             if (!_sortedFiles.empty()) {
-                _spilled = true;
-                if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
-                }
-
-                // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles,
-                    _fileName,
-                    SortOptions(),
-                    SorterComparator(pExpCtx->getValueComparator())));
-                _ownsFileDeletion = false;
-
-                // prepare current to accumulate data
-                _currentAccumulators.reserve(numAccumulators);
-                for (auto&& accumulatedField : _accumulatedFields) {
-                    _currentAccumulators.push_back(accumulatedField.makeAccumulator());
+                mergeSortedFiles(_fileName, &_nextSortedFileWriterOffset);
+            } else {
+                if (!_spilledPartitions.empty()) {
+                    // Leave only the partitions which never spilled in memory. The others are
+                    // re-aggregated from disk once these have been returned.
+                    std::set<size_t> spilled;
+                    for (auto&& partition : _spilledPartitions) {
+                        spilled.insert(partition.first);
+                    }
+                    spillGroupsInPartitions(spilled);
                 }
 
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
-            } else {
                 // start the group iterator
                 groupsIterator = _groups->begin();
             }
@@ -577,7 +574,8 @@ bool DocumentSourceGroup::usedDisk() {
     return _usedDisk;
 }
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
+shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill(const std::string& fileName,
+                                                                    std::streampos* fileOffset) {
     _usedDisk = true;
     vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
     ptrs.reserve(_groups->size());
@@ -588,37 +586,227 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
     stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
 
     SortedFileWriter<Value, Value> writer(
-        SortOptions().TempDir(pExpCtx->tempDir), _fileName, _nextSortedFileWriterOffset);
-    switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
-        case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
+        SortOptions().TempDir(pExpCtx->tempDir), fileName, *fileOffset);
+    for (size_t i = 0; i < ptrs.size(); i++) {
+        writer.addAlreadySorted(ptrs[i]->first, serializeForSpill(ptrs[i]->second));
+    }
+
+    _groups->clear();
+
+    Sorter<Value, Value>::Iterator* iteratorPtr = writer.done();
+    *fileOffset = writer.getFileEndOffset();
+    return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
+}
+
+void DocumentSourceGroup::mergeSortedFiles(const std::string& fileName,
+                                           std::streampos* fileOffset) {
+    _spilled = true;
+    if (!_groups->empty()) {
+        _sortedFiles.push_back(spill(fileName, fileOffset));
+    }
+
+    // We won't be using groups again so free its memory.
+    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+
+    _sorterIterator.reset(
+        Sorter<Value, Value>::Iterator::merge(_sortedFiles,
+                                              fileName,
+                                              SortOptions(),
+                                              SorterComparator(pExpCtx->getValueComparator())));
+    _sortedFiles.clear();
+    if (fileName == _fileName) {
+        _ownsFileDeletion = false;
+    }
+
+    // prepare current to accumulate data
+    if (_currentAccumulators.empty()) {
+        _currentAccumulators.reserve(_accumulatedFields.size());
+        for (auto&& accumulatedField : _accumulatedFields) {
+            _currentAccumulators.push_back(accumulatedField.makeAccumulator());
+        }
+    }
+
+    verify(_sorterIterator->more());  // we put data in, we should get something out.
+    _firstPartOfNextGroup = _sorterIterator->next();
+}
+
+DocumentSourceGroup::Accumulators& DocumentSourceGroup::findOrCreateGroup(const Value& id,
+                                                                         bool* inserted) {
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    Accumulators& group = (*_groups)[id];
+    *inserted = _groups->size() != oldSize;
+
+    if (*inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
+
+        // Add the accumulators
+        group.reserve(_accumulatedFields.size());
+        for (auto&& accumulatedField : _accumulatedFields) {
+            group.push_back(accumulatedField.makeAccumulator());
+        }
+    } else {
+        for (auto&& groupObj : group) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= groupObj->memUsageForSorter();
+        }
+    }
+
+    return group;
+}
+
+Value DocumentSourceGroup::serializeForSpill(const Accumulators& accums) const {
+    switch (accums.size()) {
+        case 0:  // no values, essentially a distinct
+            return Value();
+
+        case 1:  // just one value, use optimized serialization as single Value
+            return accums[0]->getValue(/*toBeMerged=*/true);
+
+        default: {  // multiple values, serialize as array-typed Value
+            vector<Value> states;
+            states.reserve(accums.size());
+            for (auto&& accum : accums) {
+                states.push_back(accum->getValue(/*toBeMerged=*/true));
             }
+            return Value(std::move(states));
+        }
+    }
+}
+
+void DocumentSourceGroup::processSpilledState(const Value& state, Accumulators* accums) const {
+    switch (accums->size()) {  // mirrors switch in serializeForSpill()
+        case 0:                // No accumulators so no Values.
             break;
 
-        case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+        case 1:  // Single accumulators serialize as a single Value.
+            (*accums)[0]->process(state, true);
+            break;
+
+        default: {  // Multiple accumulators serialize as an array of Values.
+            const vector<Value>& accumulatorStates = state.getArray();
+            for (size_t i = 0; i < accums->size(); i++) {
+                (*accums)[i]->process(accumulatorStates[i], true);
+            }
+        }
+    }
+}
+
+size_t DocumentSourceGroup::partitionFor(const Value& id) const {
+    return pExpCtx->getValueComparator().hash(id) % _numSpillPartitions;
+}
+
+void DocumentSourceGroup::spillPartitions() {
+    // Groups of partitions which are already on disk are written out first, since they will be
+    // re-aggregated from disk anyway. Only if that does not free enough memory do we give up on
+    // keeping another partition in memory, picking the largest ones first. We free up to half of
+    // the memory limit so that we do not immediately have to spill again.
+    std::set<size_t> partitions;
+    size_t remainingBytes = _memoryUsageBytes;
+    for (auto&& partition : _spilledPartitions) {
+        partitions.insert(partition.first);
+        remainingBytes -= _partitionMemoryUsageBytes[partition.first];
+    }
+
+    while (remainingBytes > _maxMemoryUsageBytes / 2) {
+        boost::optional<size_t> largest;
+        for (size_t partition = 0; partition < _numSpillPartitions; ++partition) {
+            if (!partitions.count(partition) && _partitionMemoryUsageBytes[partition] > 0 &&
+                (!largest ||
+                 _partitionMemoryUsageBytes[partition] > _partitionMemoryUsageBytes[*largest])) {
+                largest = partition;
             }
+        }
+
+        if (!largest) {
             break;
+        }
+        partitions.insert(*largest);
+        remainingBytes -= _partitionMemoryUsageBytes[*largest];
+    }
+
+    spillGroupsInPartitions(partitions);
+}
+
+void DocumentSourceGroup::spillGroupsInPartitions(const std::set<size_t>& partitions) {
+    _usedDisk = true;
+
+    // Collect the groups of each partition in a single pass, since only one file writer can be
+    // appending to '_fileName' at a time.
+    vector<vector<GroupsMap::iterator>> groupsByPartition(_numSpillPartitions);
+    for (auto it = _groups->begin(); it != _groups->end(); ++it) {
+        const size_t partition = partitionFor(it->first);
+        if (partitions.count(partition)) {
+            groupsByPartition[partition].push_back(it);
+        }
+    }
+
+    for (auto&& partition : partitions) {
+        auto& groups = groupsByPartition[partition];
+        if (groups.empty()) {
+            continue;
+        }
 
-        default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+        // The runs of a partition are re-aggregated rather than merged, so they need not be
+        // sorted.
+        SortedFileWriter<Value, Value> writer(
+            SortOptions().TempDir(pExpCtx->tempDir), _fileName, _nextSortedFileWriterOffset);
+        for (auto&& it : groups) {
+            writer.addAlreadySorted(it->first, serializeForSpill(it->second));
+        }
+        _spilledPartitions[partition].emplace_back(writer.done());
+        _nextSortedFileWriterOffset = writer.getFileEndOffset();
+
+        for (auto&& it : groups) {
+            _groups->erase(it);
+        }
+        _memoryUsageBytes -= _partitionMemoryUsageBytes[partition];
+        _partitionMemoryUsageBytes[partition] = 0;
+    }
+}
+
+void DocumentSourceGroup::loadNextSpilledPartition() {
+    auto runs = std::move(_spilledPartitions.begin()->second);
+    _spilledPartitions.erase(_spilledPartitions.begin());
+
+    _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    _memoryUsageBytes = 0;
+    _spilled = false;
+
+    for (auto&& run : runs) {
+        run->openSource();
+        while (run->more()) {
+            if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+                // This partition does not fit in memory on its own, so sort and merge it instead.
+                if (_partitionFileName.empty()) {
+                    _partitionFileName = pExpCtx->tempDir + "/" + nextFileName();
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+                _sortedFiles.push_back(spill(_partitionFileName, &_nextPartitionFileWriterOffset));
+                _memoryUsageBytes = 0;
             }
-            break;
+
+            auto spilledGroup = run->next();
+            bool inserted;
+            Accumulators& group = findOrCreateGroup(spilledGroup.first, &inserted);
+            processSpilledState(spilledGroup.second, &group);
+            for (auto&& accum : group) {
+                _memoryUsageBytes += accum->memUsageForSorter();
+            }
+        }
+        run->closeSource();
     }
 
-    _groups->clear();
+    if (!_sortedFiles.empty()) {
+        mergeSortedFiles(_partitionFileName, &_nextPartitionFileWriterOffset);
 
-    Sorter<Value, Value>::Iterator* iteratorPtr = writer.done();
-    _nextSortedFileWriterOffset = writer.getFileEndOffset();
-    return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
+        // The merge iterator deletes the file once it is done with it.
+        _partitionFileName.clear();
+        _nextPartitionFileWriterOffset = 0;
+    } else {
+        groupsIterator = _groups->begin();
+    }
 }
 
 Value DocumentSourceGroup::computeId(const Document& root) {
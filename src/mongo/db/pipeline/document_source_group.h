@@ -29,8 +29,11 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
+#include <set>
 #include <utility>
+#include <vector>
 
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -212,7 +215,55 @@ private:
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
      * store of documents at any one time, only an unsorted group can spill to disk.
      */
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    std::shared_ptr<Sorter<Value, Value>::Iterator> spill() {
+        return spill(_fileName, &_nextSortedFileWriterOffset);
+    }
+    std::shared_ptr<Sorter<Value, Value>::Iterator> spill(const std::string& fileName,
+                                                          std::streampos* fileOffset);
+
+    /**
+     * Spills whatever is left in '_groups' and sets up '_sorterIterator' to merge-sort
+     * '_sortedFiles', all of which must have been written to 'fileName'. The merge iterator takes
+     * over deleting 'fileName'.
+     */
+    void mergeSortedFiles(const std::string& fileName, std::streampos* fileOffset);
+
+    /**
+     * Looks up 'id' in '_groups', adding a new entry with fresh accumulators if it is not there,
+     * and updates '_memoryUsageBytes' to no longer include the current size of the accumulators.
+     * Callers must add back the memory used by the accumulators once they have processed input.
+     */
+    Accumulators& findOrCreateGroup(const Value& id, bool* inserted);
+
+    /**
+     * Serializes the state of 'accums' for spilling, and feeds such a state back into 'accums'.
+     */
+    Value serializeForSpill(const Accumulators& accums) const;
+    void processSpilledState(const Value& state, Accumulators* accums) const;
+
+    /**
+     * Hash-partitioned spilling. When '_numSpillPartitions' is non-zero, every group belongs to
+     * the partition given by the hash of its key. Running out of memory writes out whole
+     * partitions, largest first, so that the remaining partitions can be aggregated entirely in
+     * memory. Each spilled partition is later read back and re-aggregated on its own, falling back
+     * to a sort-based merge only if that single partition does not fit in memory.
+     */
+    size_t partitionFor(const Value& id) const;
+    void spillPartitions();
+    void spillGroupsInPartitions(const std::set<size_t>& partitions);
+    void loadNextSpilledPartition();
+
+    /**
+     * Returns true if the groups currently being returned, either from '_groups' or from
+     * '_sorterIterator', have all been returned.
+     */
+    bool currentGroupsExhausted() const;
+
+    /**
+     * Releases the groups which have just been returned. Disposes of this stage if there are no
+     * spilled partitions left to return.
+     */
+    void doneWithCurrentGroups();
 
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
@@ -266,6 +317,19 @@ private:
     const bool _allowDiskUse;
 
     std::pair<Value, Value> _firstPartOfNextGroup;
+
+    // Only used when '_numSpillPartitions' is non-zero, see spillPartitions(). Partitions which
+    // have been written to disk are keys of '_spilledPartitions', mapped to the runs holding their
+    // groups. The memory usage of each partition's groups in '_groups' sums to '_memoryUsageBytes'.
+    const size_t _numSpillPartitions;
+    std::vector<size_t> _partitionMemoryUsageBytes;
+    std::map<size_t, std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>>>
+        _spilledPartitions;
+
+    // Separate file for sorting a spilled partition which is too large to re-aggregate in memory,
+    // since merging it hands deletion of the file to the merge iterator.
+    std::string _partitionFileName;
+    std::streampos _nextPartitionFileWriterOffset = 0;
 };
 
 }  // namespace mongo
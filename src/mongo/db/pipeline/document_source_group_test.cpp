@@ -49,11 +49,13 @@
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -147,6 +149,62 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldReaggregateHashPartitionsSpilledToDisk) {
+    auto expCtx = getExpCtx();
+
+    // Allow the $group stage to spill to disk, partitioning its groups by hash.
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+    const int originalNumPartitions = internalDocumentSourceGroupHashSpillPartitions.load();
+    internalDocumentSourceGroupHashSpillPartitions.store(4);
+    ON_BLOCK_EXIT(
+        [&] { internalDocumentSourceGroupHashSpillPartitions.store(originalNumPartitions); });
+
+    auto makeStatement = [&](StringData fieldName, StringData accumulator, BSONObj arg) {
+        auto&& parser = AccumulationStatement::getParser(accumulator);
+        auto [expression, factory] =
+            parser(expCtx, arg.firstElement(), expCtx->variablesParseState);
+        return AccumulationStatement{fieldName.toString(), expression, factory};
+    };
+    auto groupByExpression =
+        ExpressionFieldPath::parse(expCtx, "$_id", expCtx->variablesParseState);
+    auto group = DocumentSourceGroup::create(expCtx,
+                                             groupByExpression,
+                                             {makeStatement("spaceHog",
+                                                            "$push",
+                                                            BSON(""
+                                                                 << "$largeStr")),
+                                              makeStatement("count", "$sum", BSON("" << 1))},
+                                             maxMemoryUsageBytes);
+
+    // Every group is seen three times, in between which the group has been spilled. Each
+    // partition ends up larger than the memory limit, so re-aggregating them also has to spill.
+    const int numGroups = 20;
+    const int numRepetitions = 3;
+    string largeStr(100, 'x');
+    std::deque<DocumentSource::GetNextResult> inputs;
+    for (int repetition = 0; repetition < numRepetitions; ++repetition) {
+        for (int id = 0; id < numGroups; ++id) {
+            inputs.emplace_back(Document{{"_id", id}, {"largeStr", largeStr}});
+        }
+    }
+    auto mock = DocumentSourceMock::createForTest(std::move(inputs));
+    group->setSource(mock.get());
+
+    stdx::unordered_set<int> idSet;
+    for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+        auto doc = result.releaseDocument();
+        ASSERT_EQ(doc["count"].coerceToInt(), numRepetitions);
+        ASSERT_EQ(doc["spaceHog"].getArrayLength(), static_cast<size_t>(numRepetitions));
+        ASSERT_TRUE(idSet.insert(doc["_id"].coerceToInt()).second);
+    }
+    ASSERT_TRUE(group->getNext().isEOF());
+    ASSERT_TRUE(group->usedDisk());
+    ASSERT_EQ(idSet.size(), static_cast<size_t>(numGroups));
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
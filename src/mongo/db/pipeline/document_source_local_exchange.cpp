@@ -0,0 +1,149 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_local_exchange.h"
+
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+intrusive_ptr<DocumentSourceLocalExchange> DocumentSourceLocalExchange::create(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    intrusive_ptr<Exchange> exchange,
+    std::vector<BSONObj> consumerPipeline,
+    ParallelPipelineWorkers::ThreadReservation reservation) {
+    return new DocumentSourceLocalExchange(
+        expCtx, std::move(exchange), std::move(consumerPipeline), std::move(reservation));
+}
+
+DocumentSourceLocalExchange::DocumentSourceLocalExchange(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    intrusive_ptr<Exchange> exchange,
+    std::vector<BSONObj> consumerPipeline,
+    ParallelPipelineWorkers::ThreadReservation reservation)
+    : DocumentSource(kStageName, expCtx),
+      _exchange(std::move(exchange)),
+      _consumerPipelineSpec(std::move(consumerPipeline)),
+      _workers("localExchange", std::move(reservation)) {
+    for (size_t consumerId = 0; consumerId < _exchange->getConsumers(); ++consumerId) {
+        // Each consumer gets its own ExpressionContext, since an ExpressionContext cannot be shared
+        // between threads.
+        auto consumerExpCtx = pExpCtx->copyWith(pExpCtx->ns, pExpCtx->uuid);
+        auto pipeline = Pipeline::parse(_consumerPipelineSpec, consumerExpCtx);
+        pipeline->addInitialSource(
+            new DocumentSourceExchange(consumerExpCtx, _exchange, consumerId, nullptr));
+
+        // Disposing of a consumer pipeline also disposes of its share of the exchange, which must
+        // happen exactly once, so this stage takes care of it rather than the deleter.
+        pipeline.get_deleter().dismissDisposal();
+        pipeline->detachFromOperationContext();
+        _consumerPipelines.push_back(std::move(pipeline));
+    }
+}
+
+const char* DocumentSourceLocalExchange::getSourceName() const {
+    return kStageName.rawData();
+}
+
+Value DocumentSourceLocalExchange::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    std::vector<Value> pipeline;
+    for (auto&& stage : _consumerPipelineSpec) {
+        pipeline.emplace_back(stage);
+    }
+    return Value(Document{{kStageName,
+                           Document{{"exchange", Value(_exchange->getSpec().toBSON())},
+                                    {"pipeline", Value(std::move(pipeline))}}}});
+}
+
+bool DocumentSourceLocalExchange::usedDisk() {
+    return _workers.usedDisk();
+}
+
+DocumentSource::GetNextResult DocumentSourceLocalExchange::doGetNext() {
+    if (!_workers.isStarted()) {
+        startWorkers();
+    }
+
+    if (auto result = _workers.getNext(pExpCtx->opCtx)) {
+        return std::move(*result);
+    }
+    return GetNextResult::makeEOF();
+}
+
+void DocumentSourceLocalExchange::doDispose() {
+    _workers.stop();
+    disposeConsumerPipelines();
+}
+
+void DocumentSourceLocalExchange::startWorkers() {
+    std::vector<ParallelPipelineWorkers::WorkerFn> workers;
+    for (size_t consumerId = 0; consumerId < _consumerPipelines.size(); ++consumerId) {
+        workers.push_back(
+            [this, consumerId](OperationContext* opCtx) { runWorker(opCtx, consumerId); });
+    }
+    _workers.start(pExpCtx->opCtx->getServiceContext(), std::move(workers));
+}
+
+void DocumentSourceLocalExchange::runWorker(OperationContext* opCtx, size_t consumerId) {
+    auto& pipeline = _consumerPipelines[consumerId];
+    pipeline->reattachToOperationContext(opCtx);
+
+    // Disposing of the pipeline releases this consumer's share of the exchange, so that the
+    // exchange stops waiting for this consumer to make room in its buffer.
+    ON_BLOCK_EXIT([&] {
+        pipeline->dispose(opCtx);
+        pipeline.reset();
+    });
+
+    try {
+        _workers.drainPipeline(opCtx, pipeline.get());
+    } catch (const ExceptionFor<ErrorCodes::ExchangePassthrough>&) {
+        // A worker failing to load the exchange input makes the other workers fail with
+        // ExchangePassthrough, so only the original error is reported.
+    }
+}
+
+void DocumentSourceLocalExchange::disposeConsumerPipelines() {
+    for (auto&& pipeline : _consumerPipelines) {
+        if (pipeline) {
+            pipeline->reattachToOperationContext(pExpCtx->opCtx);
+            pipeline->dispose(pExpCtx->opCtx);
+            pipeline.reset();
+        }
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,126 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/document_source_exchange.h"
+#include "mongo/db/pipeline/parallel_pipeline_workers.h"
+
+namespace mongo {
+
+/**
+ * Runs several consumer pipelines of an Exchange in parallel within a single aggregation, and
+ * returns the results of all of the consumers as its own output, in no particular order.
+ *
+ * Each consumer pipeline starts with a DocumentSourceExchange reading its share of the exchange
+ * input, and is run by a worker of its own, with its own Client and OperationContext. The
+ * exchange input pipeline is pulled by whichever worker needs more input, as for an exchange which
+ * feeds several cursors.
+ */
+class DocumentSourceLocalExchange final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalLocalExchange"_sd;
+
+    /**
+     * Creates a stage running 'consumerPipeline' on top of each of the consumers of 'exchange'.
+     * 'reservation' must hold a thread for each of the consumers.
+     */
+    static boost::intrusive_ptr<DocumentSourceLocalExchange> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        boost::intrusive_ptr<Exchange> exchange,
+        std::vector<BSONObj> consumerPipeline,
+        ParallelPipelineWorkers::ThreadReservation reservation);
+
+    const char* getSourceName() const final;
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kNone,
+                                     DiskUseRequirement::kWritesTmpData,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kNotAllowed,
+                                     LookupRequirement::kNotAllowed,
+                                     UnionRequirement::kNotAllowed);
+
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    boost::optional<DistributedPlanLogic> distributedPlanLogic() final {
+        return boost::none;
+    }
+
+    bool usedDisk() final;
+
+protected:
+    GetNextResult doGetNext() final;
+
+    void doDispose() final;
+
+private:
+    DocumentSourceLocalExchange(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                boost::intrusive_ptr<Exchange> exchange,
+                                std::vector<BSONObj> consumerPipeline,
+                                ParallelPipelineWorkers::ThreadReservation reservation);
+
+    /**
+     * Starts one worker per consumer.
+     */
+    void startWorkers();
+
+    /**
+     * Body of the worker running '_consumerPipelines[consumerId]' with its OperationContext
+     * 'opCtx'.
+     */
+    void runWorker(OperationContext* opCtx, size_t consumerId);
+
+    /**
+     * Disposes of the consumer pipelines which no worker has run, using this stage's
+     * OperationContext.
+     */
+    void disposeConsumerPipelines();
+
+    const boost::intrusive_ptr<Exchange> _exchange;
+    const std::vector<BSONObj> _consumerPipelineSpec;
+
+    // The consumer pipelines, which are detached from any OperationContext until a worker runs
+    // them. Each worker disposes of its pipeline and resets its entry when it exits.
+    std::vector<std::unique_ptr<Pipeline, PipelineDeleter>> _consumerPipelines;
+
+    ParallelPipelineWorkers _workers;
+};
+
+}  // namespace mongo
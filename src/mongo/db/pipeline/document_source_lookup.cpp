@@ -31,6 +31,7 @@
 
 #include "mongo/db/pipeline/document_source_lookup.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "mongo/base/init.h"
@@ -44,6 +45,7 @@
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/str.h"
 
 namespace mongo {
 
@@ -234,6 +236,59 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
     return orBuilder.obj();
 }
 
+/**
+ * Adds the size of 'result' to 'totalSizeBytes', the size of the documents that joined with a
+ * single input document so far, and throws if the total exceeds the limit.
+ */
+void addToTotalResultSize(const Document& result,
+                          const NamespaceString& fromNs,
+                          long long* totalSizeBytes) {
+    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
+    long long safeSum = 0;
+    bool hasOverflowed = overflow::add(*totalSizeBytes, result.getApproximateSize(), &safeSum);
+    uassert(4568,
+            str::stream() << "Total size of documents in " << fromNs.coll()
+                          << " matching pipeline's $lookup stage exceeds " << maxBytes << " bytes",
+
+            !hasOverflowed && *totalSizeBytes <= maxBytes);
+    *totalSizeBytes = safeSum;
+}
+
+/**
+ * Adds to 'keys' every non-null value which a {<path>: {$eq: <value>}} query matches in 'doc',
+ * starting from the path component at 'pathIndex'. Like the query, this descends into arrays of
+ * subdocuments and expands an array found at the end of the path. 'path' must not contain
+ * positional components.
+ */
+void collectHashJoinKeys(const Document& doc,
+                         const FieldPath& path,
+                         size_t pathIndex,
+                         std::vector<Value>* keys) {
+    auto value = doc.getField(path.getFieldName(pathIndex));
+    if (pathIndex + 1 == path.getPathLength()) {
+        if (value.isArray()) {
+            for (auto&& element : value.getArray()) {
+                if (!element.nullish()) {
+                    keys->push_back(element);
+                }
+            }
+        } else if (!value.nullish()) {
+            keys->push_back(std::move(value));
+        }
+        return;
+    }
+
+    if (value.isArray()) {
+        for (auto&& element : value.getArray()) {
+            if (element.getType() == BSONType::Object) {
+                collectHashJoinKeys(element.getDocument(), path, pathIndex + 1, keys);
+            }
+        }
+    } else if (value.getType() == BSONType::Object) {
+        collectHashJoinKeys(value.getDocument(), path, pathIndex + 1, keys);
+    }
+}
+
 void assertIsValidCollectionState(const boost::intrusive_ptr<ExpressionContext>& expCtx) {
     if (expCtx->mongoProcessInterface->isSharded(expCtx->opCtx, expCtx->ns)) {
         const bool foreignShardedAllowed =
@@ -263,6 +318,18 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     invariant(!_matchSrc);
 
     if (!wasConstructedWithPipelineSyntax()) {
+        if (_hashJoinState == HashJoinState::kNotStarted) {
+            buildHashJoinTable();
+        }
+
+        if (_hashJoinState == HashJoinState::kServing) {
+            if (auto results = probeHashJoinTable(inputDoc)) {
+                MutableDocument output(std::move(inputDoc));
+                output.setNestedField(_as, Value(std::move(*results)));
+                return output.freeze();
+            }
+        }
+
         auto matchStage =
             makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
         // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
@@ -273,18 +340,9 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
 
     std::vector<Value> results;
     long long objsize = 0;
-    const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
 
     while (auto result = pipeline->getNext()) {
-        long long safeSum = 0;
-        bool hasOverflowed = overflow::add(objsize, result->getApproximateSize(), &safeSum);
-        uassert(4568,
-                str::stream() << "Total size of documents in " << _fromNs.coll()
-                              << " matching pipeline's $lookup stage exceeds " << maxBytes
-                              << " bytes",
-
-                !hasOverflowed && objsize <= maxBytes);
-        objsize = safeSum;
+        addToTotalResultSize(*result, _fromNs, &objsize);
         results.emplace_back(std::move(*result));
     }
     _usedDisk = _usedDisk || pipeline->usedDisk();
@@ -294,6 +352,118 @@ DocumentSource::GetNextResult DocumentSourceLookUp::doGetNext() {
     return output.freeze();
 }
 
+bool DocumentSourceLookUp::canUseHashJoin() const {
+    if (wasConstructedWithPipelineSyntax() || _unwindSrc || pExpCtx->inMongos) {
+        return false;
+    }
+
+    // Positional path components select array elements, which the hash join keys do not model.
+    for (size_t i = 0; i < _foreignField->getPathLength(); ++i) {
+        if (str::parseUnsignedBase10Integer(_foreignField->getFieldName(i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void DocumentSourceLookUp::buildHashJoinTable() {
+    invariant(_hashJoinState == HashJoinState::kNotStarted);
+    _hashJoinState = HashJoinState::kAbandoned;
+
+    const long long maxMemoryUsageBytes =
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    if (maxMemoryUsageBytes == 0 || !canUseHashJoin()) {
+        return;
+    }
+
+    // An empty trailing $match makes the pipeline return the whole foreign collection.
+    _resolvedPipeline.back() = BSON("$match" << BSONObj());
+    auto pipeline = buildPipeline(Document());
+
+    auto table = _fromExpCtx->getValueComparator().makeUnorderedValueMap<std::vector<size_t>>();
+    std::vector<Document> foreignDocs;
+    long long memoryUsageBytes = 0;
+    std::vector<Value> keys;
+    while (auto result = pipeline->getNext()) {
+        keys.clear();
+        collectHashJoinKeys(*result, *_foreignField, 0, &keys);
+        if (keys.empty()) {
+            // Only a null or missing local value can join with this document, and those input
+            // documents are looked up with the sub-pipeline.
+            continue;
+        }
+
+        const size_t index = foreignDocs.size();
+        for (auto&& key : keys) {
+            auto& matches = table[key];
+            if (matches.empty()) {
+                memoryUsageBytes += key.getApproximateSize();
+            }
+            if (matches.empty() || matches.back() != index) {
+                matches.push_back(index);
+                memoryUsageBytes += sizeof(size_t);
+            }
+        }
+
+        memoryUsageBytes += result->getApproximateSize();
+        if (memoryUsageBytes > maxMemoryUsageBytes) {
+            // The foreign collection is too large to hold in memory, so fall back to running the
+            // sub-pipeline for every input document.
+            return;
+        }
+        foreignDocs.push_back(std::move(*result));
+    }
+    _usedDisk = _usedDisk || pipeline->usedDisk();
+
+    _hashJoinTable.emplace(std::move(table));
+    _hashJoinForeignDocs = std::move(foreignDocs);
+    _hashJoinState = HashJoinState::kServing;
+}
+
+boost::optional<std::vector<Value>> DocumentSourceLookUp::probeHashJoinTable(
+    const Document& inputDoc) {
+    invariant(_hashJoinState == HashJoinState::kServing);
+
+    // Gather the join values the same way as makeMatchStageFromInput() does.
+    bool hasValues = false;
+    bool needsPipeline = false;
+    std::vector<size_t> matches;
+    document_path_support::visitAllValuesAtPath(
+        inputDoc, *_localField, [&](const Value& nextValue) {
+            hasValues = true;
+            if (nextValue.nullish() || nextValue.isArray()) {
+                // Null values join with documents missing the foreign field and array values
+                // join with entire arrays, neither of which the table holds.
+                needsPipeline = true;
+                return;
+            }
+
+            auto it = _hashJoinTable->find(nextValue);
+            if (it != _hashJoinTable->end()) {
+                matches.insert(matches.end(), it->second.begin(), it->second.end());
+            }
+        });
+
+    // Missing values are treated as null.
+    if (!hasValues || needsPipeline) {
+        return boost::none;
+    }
+
+    // A foreign document matching several of the join values is only returned once, and results
+    // are returned in the order in which the foreign collection was scanned.
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+
+    std::vector<Value> results;
+    results.reserve(matches.size());
+    long long objsize = 0;
+    for (auto&& index : matches) {
+        addToTotalResultSize(_hashJoinForeignDocs[index], _fromNs, &objsize);
+        results.emplace_back(_hashJoinForeignDocs[index]);
+    }
+    return results;
+}
+
 std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     const Document& inputDoc) {
     // Copy all 'let' variables into the foreign pipeline's expression context.
@@ -487,6 +657,9 @@ bool DocumentSourceLookUp::usedDisk() {
 }
 
 void DocumentSourceLookUp::doDispose() {
+    _hashJoinTable.reset();
+    _hashJoinForeignDocs.clear();
+
     if (_pipeline) {
         _usedDisk = _usedDisk || _pipeline->usedDisk();
         _pipeline->dispose(pExpCtx->opCtx);
@@ -260,6 +260,26 @@ private:
      */
     void initializeResolvedIntrospectionPipeline();
 
+    /**
+     * Returns true if this $lookup can join its input documents against an in-memory hash table
+     * of the foreign collection instead of running a sub-pipeline per input document. This is
+     * only possible for the localField/foreignField syntax without an absorbed $unwind.
+     */
+    bool canUseHashJoin() const;
+
+    /**
+     * Scans the foreign collection once and indexes its documents by the value of '_foreignField'
+     * in '_hashJoinTable'. Leaves the hash join abandoned if it is disabled, not applicable, or
+     * the foreign collection does not fit in the configured memory limit.
+     */
+    void buildHashJoinTable();
+
+    /**
+     * Returns the foreign documents which join with 'inputDoc', looked up in '_hashJoinTable'.
+     * Returns boost::none if 'inputDoc' has to be joined by running the sub-pipeline instead.
+     */
+    boost::optional<std::vector<Value>> probeHashJoinTable(const Document& inputDoc);
+
     /**
      * Builds the $lookup pipeline and resolves any variables using the passed 'inputDoc', adding a
      * cursor and/or cache source as appropriate.
@@ -299,6 +319,16 @@ private:
     // from a cursor source.
     boost::optional<SequentialDocumentCache> _cache;
 
+    // For use when $lookup is specified with localField/foreignField syntax. If the foreign
+    // collection fits in memory, it is read once into '_hashJoinForeignDocs', and
+    // '_hashJoinTable' maps each foreign join value to the positions of the documents with that
+    // value. Input documents are then joined by probing the table rather than by running the
+    // sub-pipeline.
+    enum class HashJoinState { kNotStarted, kServing, kAbandoned };
+    HashJoinState _hashJoinState = HashJoinState::kNotStarted;
+    boost::optional<ValueUnorderedMap<std::vector<size_t>>> _hashJoinTable;
+    std::vector<Document> _hashJoinForeignDocs;
+
     // The ExpressionContext used when performing aggregation pipelines against the '_resolvedNs'
     // namespace.
     boost::intrusive_ptr<ExpressionContext> _fromExpCtx;
@@ -48,6 +48,7 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/server_options.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace {
@@ -509,12 +510,18 @@ public:
         }
 
         pipeline->addInitialSource(DocumentSourceMock::createForTest(_mockResults));
+        ++_numPipelinesAttached;
         return pipeline;
     }
 
+    int numPipelinesAttached() const {
+        return _numPipelinesAttached;
+    }
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
     bool _removeLeadingQueryStages = false;
+    int _numPipelinesAttached = 0;
 };
 
 TEST_F(DocumentSourceLookUpTest, ShouldPropagatePauses) {
@@ -623,6 +630,73 @@ TEST_F(DocumentSourceLookUpTest, ShouldPropagatePausesWhileUnwinding) {
     lookup->dispose();
 }
 
+TEST_F(DocumentSourceLookUpTest, ShouldJoinWithHashTableWhenForeignCollectionFitsInMemory) {
+    const long long originalMaxMemoryBytes =
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(1024 * 1024);
+    ON_BLOCK_EXIT([&] {
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(originalMaxMemoryBytes);
+    });
+
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+        {fromNs.coll().toString(), {fromNs, std::vector<BSONObj>()}}});
+
+    // Mock out the foreign collection.
+    deque<DocumentSource::GetNextResult> mockForeignContents{
+        Document{{"_id", 0}, {"a", 1}},
+        Document{{"_id", 1}, {"a", vector<Value>{Value(1), Value(2)}}},
+        Document{{"_id", 2}, {"a", BSONNULL}},
+        Document{{"_id", 3}}};
+    auto mongoInterface = std::make_shared<MockMongoInterface>(std::move(mockForeignContents));
+    expCtx->mongoProcessInterface = mongoInterface;
+
+    // Set up the $lookup stage.
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "x"_sd},
+                                         {"foreignField", "a"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource =
+        DocumentSourceMock::createForTest({Document{{"x", 1}},
+                                           Document{{"x", 2}},
+                                           Document{{"x", vector<Value>{Value(1), Value(2)}}},
+                                           Document{{"x", 3}},
+                                           Document{{"x", BSONNULL}}});
+    lookup->setSource(mockLocalSource.get());
+
+    auto expectJoinedIds = [&](vector<int> ids) {
+        auto next = lookup->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        auto foreignDocs = next.releaseDocument()["foreignDocs"];
+        ASSERT_EQ(foreignDocs.getArrayLength(), ids.size());
+        for (size_t i = 0; i < ids.size(); ++i) {
+            ASSERT_VALUE_EQ(foreignDocs[i]["_id"], Value(ids[i]));
+        }
+    };
+
+    expectJoinedIds({0, 1});
+    expectJoinedIds({1});
+    expectJoinedIds({0, 1});
+    expectJoinedIds({});
+
+    // The foreign collection was scanned once to build the hash table.
+    ASSERT_EQ(mongoInterface->numPipelinesAttached(), 1);
+
+    // A null value also joins with documents missing the foreign field, which the hash table does
+    // not hold, so it is looked up with a sub-pipeline.
+    expectJoinedIds({2, 3});
+    ASSERT_EQ(mongoInterface->numPipelinesAttached(), 2);
+
+    ASSERT_TRUE(lookup->getNext().isEOF());
+    lookup->dispose();
+}
+
 TEST_F(DocumentSourceLookUpTest, LookupReportsAsFieldIsModified) {
     auto expCtx = getExpCtx();
     NamespaceString fromNs("test", "foreign");
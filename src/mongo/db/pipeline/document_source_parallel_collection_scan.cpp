@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_parallel_collection_scan.h"
+
+#include "mongo/db/db_raii.h"
+#include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/internal_plans.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+intrusive_ptr<DocumentSourceParallelCollectionScan> DocumentSourceParallelCollectionScan::create(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    UUID uuid,
+    std::vector<BSONObj> workerPipeline,
+    std::vector<RecordIdRange> ranges,
+    ParallelPipelineWorkers::ThreadReservation reservation) {
+    return new DocumentSourceParallelCollectionScan(expCtx,
+                                                    std::move(uuid),
+                                                    std::move(workerPipeline),
+                                                    std::move(ranges),
+                                                    std::move(reservation));
+}
+
+DocumentSourceParallelCollectionScan::DocumentSourceParallelCollectionScan(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    UUID uuid,
+    std::vector<BSONObj> workerPipeline,
+    std::vector<RecordIdRange> ranges,
+    ParallelPipelineWorkers::ThreadReservation reservation)
+    : DocumentSource(kStageName, expCtx),
+      _uuid(std::move(uuid)),
+      _workerPipeline(std::move(workerPipeline)),
+      _ranges(std::move(ranges)),
+      _workers("parallelCollectionScan", std::move(reservation)) {
+    invariant(!_ranges.empty());
+}
+
+const char* DocumentSourceParallelCollectionScan::getSourceName() const {
+    return kStageName.rawData();
+}
+
+Value DocumentSourceParallelCollectionScan::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    std::vector<Value> pipeline;
+    for (auto&& stage : _workerPipeline) {
+        pipeline.emplace_back(stage);
+    }
+    return Value(Document{{kStageName,
+                           Document{{"numRanges", static_cast<long long>(_ranges.size())},
+                                    {"pipeline", Value(std::move(pipeline))}}}});
+}
+
+bool DocumentSourceParallelCollectionScan::usedDisk() {
+    return _workers.usedDisk();
+}
+
+DocumentSource::GetNextResult DocumentSourceParallelCollectionScan::doGetNext() {
+    if (!_workers.isStarted()) {
+        startWorkers();
+    }
+
+    if (auto result = _workers.getNext(pExpCtx->opCtx)) {
+        return std::move(*result);
+    }
+    return GetNextResult::makeEOF();
+}
+
+void DocumentSourceParallelCollectionScan::doDispose() {
+    _workers.stop();
+}
+
+void DocumentSourceParallelCollectionScan::startWorkers() {
+    std::vector<ParallelPipelineWorkers::WorkerFn> workers;
+    for (size_t rangeIndex = 0; rangeIndex < _ranges.size(); ++rangeIndex) {
+        // The workers get their own copies of the ExpressionContext, made here because the
+        // original may change while they run. They return partial results to be merged by the
+        // stage which follows this one.
+        auto expCtx = pExpCtx->copyWith(pExpCtx->ns, _uuid);
+        expCtx->needsMerge = true;
+        expCtx->opCtx = nullptr;
+        workers.push_back([this, rangeIndex, expCtx = std::move(expCtx)](OperationContext* opCtx) {
+            runWorker(opCtx, rangeIndex, expCtx);
+        });
+    }
+    _workers.start(pExpCtx->opCtx->getServiceContext(), std::move(workers));
+}
+
+void DocumentSourceParallelCollectionScan::runWorker(OperationContext* opCtx,
+                                                     size_t rangeIndex,
+                                                     intrusive_ptr<ExpressionContext> expCtx) {
+    expCtx->opCtx = opCtx;
+    auto pipeline = Pipeline::parse(_workerPipeline, expCtx);
+    pipeline->optimizePipeline();
+
+    {
+        AutoGetCollectionForRead autoColl(opCtx,
+                                          NamespaceStringOrUUID(expCtx->ns.db().toString(), _uuid));
+        auto collection = autoColl.getCollection();
+        uassert(ErrorCodes::QueryPlanKilled,
+                "collection dropped during parallel collection scan",
+                collection);
+
+        const auto& range = _ranges[rangeIndex];
+        auto exec = InternalPlanner::collectionScan(opCtx,
+                                                    collection->ns().ns(),
+                                                    collection,
+                                                    PlanExecutor::YIELD_AUTO,
+                                                    InternalPlanner::FORWARD,
+                                                    range.first,
+                                                    range.second);
+        pipeline->addInitialSource(DocumentSourceCursor::create(
+            collection, std::move(exec), expCtx, DocumentSourceCursor::CursorType::kRegular));
+    }
+
+    _workers.drainPipeline(opCtx, pipeline.get());
+}
+
+}  // namespace mongo
@@ -0,0 +1,132 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/parallel_pipeline_workers.h"
+#include "mongo/db/record_id.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+/**
+ * Runs a pipeline prefix over a collection in parallel, and returns the results of all of the
+ * prefixes as its own output.
+ *
+ * The collection is split into ranges of RecordIds, and each range is scanned by its own worker,
+ * which runs the prefix on top of a collection scan bounded to that range. The prefix ends
+ * with the shards part of a split blocking stage, e.g. a $group producing partial groups, so that
+ * the stage following this one merges the partial results of all of the workers.
+ *
+ * Each worker has its own Client and OperationContext, and therefore its own storage snapshot.
+ * Like a yielding collection scan, this returns each document that exists for the whole duration
+ * of the scan exactly once.
+ */
+class DocumentSourceParallelCollectionScan final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalParallelCollectionScan"_sd;
+
+    /**
+     * A half-open range [min, max) of RecordIds. A missing bound leaves that side of the range
+     * unbounded.
+     */
+    using RecordIdRange = std::pair<boost::optional<RecordId>, boost::optional<RecordId>>;
+
+    /**
+     * Creates a stage which runs 'workerPipeline' over each range in 'ranges' of the collection
+     * with UUID 'uuid'. 'reservation' must hold a thread for each of the ranges.
+     */
+    static boost::intrusive_ptr<DocumentSourceParallelCollectionScan> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        UUID uuid,
+        std::vector<BSONObj> workerPipeline,
+        std::vector<RecordIdRange> ranges,
+        ParallelPipelineWorkers::ThreadReservation reservation);
+
+    const char* getSourceName() const final;
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kNone,
+                                     DiskUseRequirement::kWritesTmpData,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kNotAllowed,
+                                     LookupRequirement::kNotAllowed,
+                                     UnionRequirement::kNotAllowed);
+
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    boost::optional<DistributedPlanLogic> distributedPlanLogic() final {
+        return boost::none;
+    }
+
+    bool usedDisk() final;
+
+protected:
+    GetNextResult doGetNext() final;
+
+    void doDispose() final;
+
+private:
+    DocumentSourceParallelCollectionScan(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                         UUID uuid,
+                                         std::vector<BSONObj> workerPipeline,
+                                         std::vector<RecordIdRange> ranges,
+                                         ParallelPipelineWorkers::ThreadReservation reservation);
+
+    /**
+     * Starts one worker per range.
+     */
+    void startWorkers();
+
+    /**
+     * Body of the worker scanning '_ranges[rangeIndex]'. Runs the worker pipeline with 'expCtx',
+     * which the worker binds to its own OperationContext 'opCtx'.
+     */
+    void runWorker(OperationContext* opCtx,
+                   size_t rangeIndex,
+                   boost::intrusive_ptr<ExpressionContext> expCtx);
+
+    const UUID _uuid;
+    const std::vector<BSONObj> _workerPipeline;
+    const std::vector<RecordIdRange> _ranges;
+
+    ParallelPipelineWorkers _workers;
+};
+
+}  // namespace mongo
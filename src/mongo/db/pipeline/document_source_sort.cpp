@@ -221,6 +221,15 @@ DocumentSource::GetNextResult DocumentSourceSort::populate() {
 void DocumentSourceSort::loadDocument(Document&& doc) {
     invariant(!_populated);
 
+    // Once a top-k sort holds enough documents, the first component of the sort key is often enough
+    // to tell that a document cannot be part of the results, without computing its whole sort key.
+    if (_sortExecutor->hasLimit() && !_sortKeyGen->isSingleElementKey()) {
+        auto leadingKeyComponent = _sortKeyGen->computeLeadingSortKeyComponent(doc);
+        if (leadingKeyComponent && _sortExecutor->isWorseThanCutoff(*leadingKeyComponent)) {
+            return;
+        }
+    }
+
     Value sortKey;
     Document docForSorter;
     // We always need to extract the sort key if we've reached this point. If the query system had
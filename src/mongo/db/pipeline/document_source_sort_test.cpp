@@ -392,6 +392,29 @@ TEST_F(DocumentSourceSortExecutionTest, ShouldResumePopulationBetweenPauses) {
     ASSERT_TRUE(sort->getNext().isEOF());
 }
 
+TEST_F(DocumentSourceSortExecutionTest, CompoundSortSpecWithLimitKeepsTiesOnFirstField) {
+    // Once the top-k sort is full, documents which are worse on the first sort field are discarded
+    // early, but those tied with the worst document held still need the full sort key to compare.
+    auto sort = DocumentSourceSort::create(getExpCtx(), BSON("a" << -1 << "b" << 1), 2);
+    auto mock = DocumentSourceMock::createForTest({Document{{"_id", 0}, {"a", 1}, {"b", 0}},
+                                                   Document{{"_id", 1}, {"a", 3}, {"b", 5}},
+                                                   Document{{"_id", 2}, {"a", 2}, {"b", 0}},
+                                                   Document{{"_id", 3}, {"a", 3}, {"b", 1}},
+                                                   Document{{"_id", 4}, {"a", 0}, {"b", 0}},
+                                                   Document{{"_id", 5}, {"a", 3}, {"b", 0}}});
+    sort->setSource(mock.get());
+
+    auto next = sort->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.releaseDocument()["_id"], Value(5));
+
+    next = sort->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.releaseDocument()["_id"], Value(3));
+
+    ASSERT_TRUE(sort->getNext().isEOF());
+}
+
 TEST_F(DocumentSourceSortExecutionTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     auto expCtx = getExpCtx();
 
@@ -0,0 +1,237 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/parallel_pipeline_workers.h"
+
+#include <algorithm>
+
+#include "mongo/db/client.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/service_context.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/concurrency/with_lock.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+
+namespace {
+
+// The threads which run the workers of every operation. The pool is started on first use and shut
+// down with the ServiceContext.
+struct PipelineWorkerThreads {
+    Mutex mutex = MONGO_MAKE_LATCH("PipelineWorkerThreads::mutex");
+    std::unique_ptr<ThreadPool> pool;
+    size_t maxThreads = 0;
+
+    // The number of threads held by ThreadReservations.
+    size_t reservedThreads = 0;
+};
+
+const auto getPipelineWorkerThreads = ServiceContext::declareDecoration<PipelineWorkerThreads>();
+
+ThreadPool* getPipelineWorkerPool(WithLock, PipelineWorkerThreads& threads) {
+    if (!threads.pool) {
+        const int maxThreads = internalQueryMaxPipelineWorkerThreads.load();
+        threads.maxThreads =
+            maxThreads > 0 ? maxThreads : 2 * std::max(1u, ProcessInfo::getNumCores());
+
+        ThreadPool::Options options;
+        options.poolName = "PipelineWorkerThreadPool";
+        options.threadNamePrefix = "PipelineWorker-";
+        options.minThreads = 0;
+        // Workers only run on reserved threads, so the pool never needs more threads than can be
+        // reserved. Idle threads are kept for the workers of later operations.
+        options.maxThreads = threads.maxThreads;
+        threads.pool = std::make_unique<ThreadPool>(std::move(options));
+        threads.pool->startup();
+    }
+    return threads.pool.get();
+}
+
+}  // namespace
+
+ParallelPipelineWorkers::ThreadReservation::ThreadReservation(ServiceContext* serviceContext,
+                                                              size_t numThreads)
+    : _serviceContext(serviceContext), _numThreads(numThreads) {}
+
+ParallelPipelineWorkers::ThreadReservation::ThreadReservation(ThreadReservation&& other)
+    : _serviceContext(other._serviceContext), _numThreads(other._numThreads) {
+    other._numThreads = 0;
+}
+
+ParallelPipelineWorkers::ThreadReservation::~ThreadReservation() {
+    if (_numThreads == 0) {
+        return;
+    }
+    auto& threads = getPipelineWorkerThreads(_serviceContext);
+    stdx::lock_guard<Latch> lk(threads.mutex);
+    invariant(threads.reservedThreads >= _numThreads);
+    threads.reservedThreads -= _numThreads;
+}
+
+boost::optional<ParallelPipelineWorkers::ThreadReservation>
+ParallelPipelineWorkers::tryReserveThreads(ServiceContext* serviceContext, size_t numThreads) {
+    auto& threads = getPipelineWorkerThreads(serviceContext);
+    stdx::lock_guard<Latch> lk(threads.mutex);
+    getPipelineWorkerPool(lk, threads);
+    if (threads.reservedThreads + numThreads > threads.maxThreads) {
+        return boost::none;
+    }
+    threads.reservedThreads += numThreads;
+    return ThreadReservation(serviceContext, numThreads);
+}
+
+ParallelPipelineWorkers::ParallelPipelineWorkers(std::string workerName,
+                                                 ThreadReservation reservation)
+    : _workerName(std::move(workerName)), _reservation(std::move(reservation)) {}
+
+ParallelPipelineWorkers::~ParallelPipelineWorkers() {
+    stop();
+}
+
+void ParallelPipelineWorkers::start(ServiceContext* serviceContext, std::vector<WorkerFn> workers) {
+    invariant(!_started);
+    invariant(workers.size() <= _reservation.numThreads());
+    _started = true;
+
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _numRunningWorkers = workers.size();
+    }
+
+    ThreadPool* pool;
+    {
+        auto& threads = getPipelineWorkerThreads(serviceContext);
+        stdx::lock_guard<Latch> lk(threads.mutex);
+        pool = getPipelineWorkerPool(lk, threads);
+    }
+    for (auto&& worker : workers) {
+        pool->schedule([this, serviceContext, worker = std::move(worker)](Status status) mutable {
+            _runWorker(serviceContext, std::move(worker), std::move(status));
+        });
+    }
+}
+
+boost::optional<Document> ParallelPipelineWorkers::getNext(OperationContext* opCtx) {
+    stdx::unique_lock<Latch> lk(_mutex);
+    opCtx->waitForConditionOrInterrupt(_resultsAvailable, lk, [&] {
+        return !_results.empty() || _numRunningWorkers == 0 || !_workerStatus.isOK();
+    });
+    uassertStatusOK(_workerStatus);
+
+    if (_results.empty()) {
+        return boost::none;
+    }
+
+    auto result = std::move(_results.front());
+    _results.pop_front();
+    _bufferSpaceAvailable.notify_one();
+    return std::move(result);
+}
+
+void ParallelPipelineWorkers::stop() {
+    stdx::unique_lock<Latch> lk(_mutex);
+    _stopping = true;
+    for (auto&& opCtx : _workerOpCtxs) {
+        stdx::lock_guard<Client> clientLock(*opCtx->getClient());
+        opCtx->getServiceContext()->killOperation(clientLock, opCtx, ErrorCodes::Interrupted);
+    }
+    _bufferSpaceAvailable.notify_all();
+
+    // The workers refer to this object, so wait for them even if this operation is interrupted.
+    _resultsAvailable.wait(lk, [&] { return _numRunningWorkers == 0; });
+    _results.clear();
+}
+
+bool ParallelPipelineWorkers::usedDisk() {
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _usedDisk;
+}
+
+void ParallelPipelineWorkers::drainPipeline(OperationContext* opCtx, Pipeline* pipeline) {
+    while (auto result = pipeline->getNext()) {
+        stdx::unique_lock<Latch> lk(_mutex);
+        opCtx->waitForConditionOrInterrupt(_bufferSpaceAvailable, lk, [&] {
+            return _stopping || _results.size() < kMaxBufferedResults;
+        });
+        if (_stopping) {
+            break;
+        }
+        _results.push_back(result->getOwned());
+        _resultsAvailable.notify_one();
+    }
+
+    const bool usedDisk = pipeline->usedDisk();
+    stdx::lock_guard<Latch> lk(_mutex);
+    _usedDisk = _usedDisk || usedDisk;
+}
+
+void ParallelPipelineWorkers::_runWorker(ServiceContext* serviceContext,
+                                         WorkerFn worker,
+                                         Status poolStatus) {
+    // If the pool is shutting down, this runs on the thread which scheduled the worker.
+    Status status = std::move(poolStatus);
+    if (status.isOK()) {
+        ThreadClient tc(_workerName, serviceContext);
+        auto opCtx = cc().makeOperationContext();
+
+        bool stopping;
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            _workerOpCtxs.push_back(opCtx.get());
+            stopping = _stopping;
+        }
+
+        if (!stopping) {
+            try {
+                worker(opCtx.get());
+            } catch (const DBException& ex) {
+                status = ex.toStatus();
+            }
+        }
+        worker = nullptr;
+
+        stdx::lock_guard<Latch> lk(_mutex);
+        _workerOpCtxs.erase(std::find(_workerOpCtxs.begin(), _workerOpCtxs.end(), opCtx.get()));
+    }
+
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (!status.isOK() && !_stopping && _workerStatus.isOK()) {
+        _workerStatus =
+            status.withContext(str::stream() << "Error in " << _workerName << " worker");
+    }
+    --_numRunningWorkers;
+    _resultsAvailable.notify_all();
+}
+
+}  // namespace mongo
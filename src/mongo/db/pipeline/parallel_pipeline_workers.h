@@ -0,0 +1,185 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "mongo/base/status.h"
+#include "mongo/db/exec/document_value/document.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
+
+namespace mongo {
+
+class OperationContext;
+class Pipeline;
+class ServiceContext;
+
+/**
+ * Runs the workers of a DocumentSource which spreads its work over several threads, and buffers
+ * the results they produce until the stage returns them.
+ *
+ * Each worker runs on a thread of a pool shared by all operations, with a Client and an
+ * OperationContext of its own. Workers produce results by calling drainPipeline(), and the stage
+ * returns them from getNext() in no particular order.
+ *
+ * The pool has at most 'internalQueryMaxPipelineWorkerThreads' threads. A stage reserves a thread
+ * for each of its workers with tryReserveThreads() before it is added to a pipeline, so that its
+ * workers never wait in the pool's queue for each other, and the pipeline is planned without the
+ * stage when the pool is too busy.
+ */
+class ParallelPipelineWorkers {
+    ParallelPipelineWorkers(const ParallelPipelineWorkers&) = delete;
+    ParallelPipelineWorkers& operator=(const ParallelPipelineWorkers&) = delete;
+
+public:
+    /**
+     * The body of a worker, which runs with the worker's OperationContext. Errors it throws are
+     * returned by getNext().
+     */
+    using WorkerFn = std::function<void(OperationContext* opCtx)>;
+
+    /**
+     * Threads of the pool set aside for the workers of one stage. They are given back when the
+     * reservation is destroyed.
+     */
+    class ThreadReservation {
+    public:
+        ThreadReservation(ThreadReservation&& other);
+        ThreadReservation& operator=(ThreadReservation&& other) = delete;
+        ~ThreadReservation();
+
+        size_t numThreads() const {
+            return _numThreads;
+        }
+
+    private:
+        friend class ParallelPipelineWorkers;
+
+        ThreadReservation(ServiceContext* serviceContext, size_t numThreads);
+
+        ServiceContext* _serviceContext;
+        size_t _numThreads;
+    };
+
+    /**
+     * Reserves 'numThreads' threads of the pool of 'serviceContext'. Returns boost::none if fewer
+     * threads are left, in which case the operation should run without workers.
+     */
+    static boost::optional<ThreadReservation> tryReserveThreads(ServiceContext* serviceContext,
+                                                                size_t numThreads);
+
+    /**
+     * 'workerName' names the Clients of the workers and gives context to the errors they fail
+     * with. The workers run on the threads of 'reservation', which are held until this object is
+     * destroyed.
+     */
+    ParallelPipelineWorkers(std::string workerName, ThreadReservation reservation);
+
+    ~ParallelPipelineWorkers();
+
+    /**
+     * Starts running each of 'workers', which must not outnumber the reserved threads. Must be
+     * called at most once.
+     */
+    void start(ServiceContext* serviceContext, std::vector<WorkerFn> workers);
+
+    bool isStarted() const {
+        return _started;
+    }
+
+    /**
+     * Returns the next result produced by any worker, waiting for one if necessary, or boost::none
+     * once all of the workers have exited. Throws the first error a worker failed with, or if
+     * 'opCtx' is interrupted while waiting.
+     */
+    boost::optional<Document> getNext(OperationContext* opCtx);
+
+    /**
+     * Interrupts the workers which are still running, waits for all of them to exit, and discards
+     * the results which were not returned.
+     */
+    void stop();
+
+    /**
+     * Returns true if any of the pipelines drained by the workers used disk.
+     */
+    bool usedDisk();
+
+    /**
+     * Called by a worker to buffer every result of 'pipeline'. Waits while the buffer is full, and
+     * returns early if the workers are stopped.
+     */
+    void drainPipeline(OperationContext* opCtx, Pipeline* pipeline);
+
+private:
+    // The maximum number of results the workers may produce before the stage returns them.
+    static constexpr size_t kMaxBufferedResults = 1024;
+
+    /**
+     * Runs 'worker' on a thread of the pool, unless 'poolStatus' reports that the pool could not
+     * run it.
+     */
+    void _runWorker(ServiceContext* serviceContext, WorkerFn worker, Status poolStatus);
+
+    const std::string _workerName;
+
+    const ThreadReservation _reservation;
+
+    // Only accessed by the thread running the stage.
+    bool _started = false;
+
+    // Protects the members below, which are shared with the workers.
+    Mutex _mutex = MONGO_MAKE_LATCH("ParallelPipelineWorkers::_mutex");
+
+    // Signalled when a worker produces a result or exits.
+    stdx::condition_variable _resultsAvailable;
+
+    // Signalled when the stage consumes a result, or the workers are being stopped.
+    stdx::condition_variable _bufferSpaceAvailable;
+
+    std::deque<Document> _results;
+    size_t _numRunningWorkers = 0;
+    bool _stopping = false;
+    bool _usedDisk = false;
+
+    // The first error a worker failed with, if any.
+    Status _workerStatus = Status::OK();
+
+    // The OperationContexts of the running workers, so that they can be interrupted.
+    std::vector<OperationContext*> _workerOpCtxs;
+};
+
+}  // namespace mongo
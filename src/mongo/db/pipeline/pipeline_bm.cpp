@@ -0,0 +1,120 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <benchmark/benchmark.h>
+
+#include "mongo/db/client.h"
+#include "mongo/db/pipeline/document_source_queue.h"
+#include "mongo/db/pipeline/expression_context.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/query_bm_documents.h"
+#include "mongo/db/service_context.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("test.pipeline_bm");
+
+/**
+ * Parses and optimizes 'rawPipeline' once per iteration, feeds it the input documents from a
+ * DocumentSourceQueue and drains it. Reports how many input documents per second it consumed.
+ */
+void runPipeline(benchmark::State& state, const std::vector<BSONObj>& rawPipeline) {
+    auto client = getGlobalServiceContext()->makeClient("pipeline_bm");
+    auto opCtx = client->makeOperationContext();
+    auto expCtx = make_intrusive<ExpressionContext>(opCtx.get(), nullptr, kNss);
+    std::vector<Document> docs;
+    for (auto&& doc : makeBenchmarkDocuments(state.range(0), state.range(1))) {
+        docs.emplace_back(doc);
+    }
+
+    for (auto _ : state) {
+        std::deque<DocumentSource::GetNextResult> input;
+        for (auto&& doc : docs) {
+            input.emplace_back(Document{doc});
+        }
+
+        auto pipeline = Pipeline::parse(rawPipeline, expCtx);
+        pipeline->addInitialSource(make_intrusive<DocumentSourceQueue>(std::move(input), expCtx));
+        pipeline->optimizePipeline();
+
+        size_t numResults = 0;
+        while (pipeline->getNext()) {
+            ++numResults;
+        }
+        benchmark::DoNotOptimize(numResults);
+    }
+    state.SetItemsProcessed(state.iterations() * docs.size());
+}
+
+// Draining the input alone, as a baseline for the benchmarks below.
+void BM_Queue(benchmark::State& state) {
+    runPipeline(state, {});
+}
+
+void BM_Match(benchmark::State& state) {
+    runPipeline(state, {BSON("$match" << BSON("a" << BSON("$lt" << 500)))});
+}
+
+void BM_Project(benchmark::State& state) {
+    runPipeline(state, {BSON("$project" << BSON("_id" << 0 << "a" << 1 << "f0" << 1))});
+}
+
+void BM_AddFields(benchmark::State& state) {
+    runPipeline(state, {BSON("$addFields" << BSON("b" << BSON("$add" << BSON_ARRAY("$a" << 1))))});
+}
+
+void BM_Group(benchmark::State& state) {
+    runPipeline(state,
+                {BSON("$group" << BSON("_id"
+                                       << "$a"
+                                       << "count" << BSON("$sum" << 1)))});
+}
+
+void BM_Sort(benchmark::State& state) {
+    runPipeline(state, {BSON("$sort" << BSON("a" << 1))});
+}
+
+void BM_SortWithLimit(benchmark::State& state) {
+    runPipeline(state, {BSON("$sort" << BSON("a" << 1)), BSON("$limit" << 10)});
+}
+
+BENCHMARK(BM_Queue)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_Match)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_Project)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_AddFields)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_Group)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_Sort)->Apply(benchmarkDocumentShapes);
+BENCHMARK(BM_SortWithLimit)->Apply(benchmarkDocumentShapes);
+
+}  // namespace
+}  // namespace mongo
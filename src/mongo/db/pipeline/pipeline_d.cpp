@@ -33,6 +33,8 @@
 
 #include "mongo/db/pipeline/pipeline_d.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 
 #include "mongo/base/exact_cast.h"
@@ -51,27 +53,35 @@
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/trial_stage.h"
 #include "mongo/db/exec/working_set.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/ops/write_ops_exec.h"
 #include "mongo/db/ops/write_ops_gen.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_change_stream.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
 #include "mongo/db/pipeline/document_source_geo_near.h"
 #include "mongo/db/pipeline/document_source_geo_near_cursor.h"
 #include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_local_exchange.h"
 #include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/document_source_parallel_collection_scan.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
 #include "mongo/db/pipeline/document_source_sort.h"
+#include "mongo/db/pipeline/document_source_unwind.h"
+#include "mongo/db/pipeline/parallel_pipeline_workers.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_planner_common.h"
 #include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/operation_sharding_state.h"
@@ -80,6 +90,7 @@
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/db/transaction_participant.h"
+#include "mongo/logv2/log.h"
 #include "mongo/rpc/metadata/client_metadata_ismaster.h"
 #include "mongo/s/catalog_cache.h"
 #include "mongo/s/chunk_manager.h"
@@ -294,6 +305,349 @@ StringData extractGeoNearFieldFromIndexes(OperationContext* opCtx, Collection* c
     }
     MONGO_UNREACHABLE;
 }
+
+// The number of RecordIds sampled per range when splitting a collection for a parallel scan.
+constexpr size_t kParallelScanSamplesPerRange = 32;
+
+// A collection with fewer records per worker thread than this is not worth processing in parallel.
+constexpr long long kMinRecordsPerWorker = 10 * 1000;
+
+/**
+ * Returns true if the aggregation running 'pipeline' over 'collection' may read the collection
+ * from worker threads. The workers have OperationContexts and storage snapshots of their own, so
+ * only local reads which are neither sharded nor part of a transaction qualify.
+ */
+bool canReadFromWorkerThreads(Collection* collection, const Pipeline* pipeline) {
+    const auto& expCtx = pipeline->getContext();
+    auto opCtx = expCtx->opCtx;
+    return collection && !collection->isCapped() && !collection->ns().isOplog() &&
+        !expCtx->explain && !expCtx->inMongos && !expCtx->fromMongos && !expCtx->needsMerge &&
+        !expCtx->inMultiDocumentTransaction &&
+        !OperationShardingState::isOperationVersioned(opCtx) &&
+        repl::ReadConcernArgs::get(opCtx).getLevel() == repl::ReadConcernLevel::kLocalReadConcern;
+}
+
+/**
+ * Splits the RecordIds of 'collection' into at most 'numRanges' ranges holding similar numbers of
+ * records, using a random cursor to sample RecordIds. Returns the ranges in increasing order, or
+ * an empty vector if the collection cannot be sampled.
+ */
+std::vector<DocumentSourceParallelCollectionScan::RecordIdRange> splitCollectionIntoRanges(
+    OperationContext* opCtx, Collection* collection, size_t numRanges) {
+    auto rsRandCursor = collection->getRecordStore()->getRandomCursor(opCtx);
+    if (!rsRandCursor) {
+        // The storage engine does not support random cursors.
+        return {};
+    }
+
+    std::vector<RecordId> samples;
+    for (size_t i = 0; i < numRanges * kParallelScanSamplesPerRange; ++i) {
+        auto record = rsRandCursor->next();
+        if (!record) {
+            break;
+        }
+        samples.push_back(record->id);
+    }
+    std::sort(samples.begin(), samples.end());
+    samples.erase(std::unique(samples.begin(), samples.end()), samples.end());
+    if (samples.size() < numRanges) {
+        return {};
+    }
+
+    // Evenly spaced samples become the boundaries between the ranges.
+    std::vector<DocumentSourceParallelCollectionScan::RecordIdRange> ranges;
+    boost::optional<RecordId> rangeStart;
+    for (size_t i = 1; i < numRanges; ++i) {
+        const auto& boundary = samples[i * samples.size() / numRanges];
+        if (!rangeStart || *rangeStart < boundary) {
+            ranges.emplace_back(rangeStart, boundary);
+            rangeStart = boundary;
+        }
+    }
+    ranges.emplace_back(rangeStart, boost::none);
+    return ranges;
+}
+
+/**
+ * Attempts to run the beginning of 'pipeline' on several threads, each scanning part of
+ * 'collection'. This is possible when the pipeline starts with streaming stages followed by a
+ * $group, and no index can help with answering it. The prefix up to the $group is replaced with a
+ * parallel scan running the prefix on each part of the collection, followed by a $group merging
+ * the partial groups of all of the parts.
+ *
+ * Returns false and leaves 'pipeline' unchanged if the pipeline or the operation does not allow
+ * it, or if the collection is too small to be worth it.
+ */
+bool attemptToParallelizeCollectionScan(Collection* collection,
+                                        const AggregationRequest* aggRequest,
+                                        Pipeline* pipeline) {
+    const int numWorkers = internalQueryParallelCollectionScanWorkers.load();
+    const auto& expCtx = pipeline->getContext();
+    auto opCtx = expCtx->opCtx;
+
+    if (numWorkers < 2 || (aggRequest && !aggRequest->getHint().isEmpty()) ||
+        !canReadFromWorkerThreads(collection, pipeline)) {
+        return false;
+    }
+
+    // Look for the stages which each worker can run on its part of the collection, up to a $group
+    // whose partial results can be merged.
+    const auto& sources = pipeline->getSources();
+    const bool hasSecondaryIndexes = collection->getIndexCatalog()->numIndexesTotal(opCtx) > 1;
+    size_t prefixLength = 0;
+    DocumentSourceGroup* groupStage = nullptr;
+    for (auto&& source : sources) {
+        ++prefixLength;
+        if (auto matchStage = dynamic_cast<DocumentSourceMatch*>(source.get())) {
+            // A $match might be answered by an index scan rather than by scanning the whole
+            // collection.
+            if (hasSecondaryIndexes || matchStage->isTextQuery() ||
+                matchStage->getQuery().hasField("_id") ||
+                QueryPlannerCommon::hasNode(matchStage->getMatchExpression(),
+                                            MatchExpression::GEO_NEAR)) {
+                return false;
+            }
+            continue;
+        }
+        if (dynamic_cast<DocumentSourceSingleDocumentTransformation*>(source.get())) {
+            continue;
+        }
+        groupStage = dynamic_cast<DocumentSourceGroup*>(source.get());
+        break;
+    }
+    if (!groupStage) {
+        return false;
+    }
+
+    const long long numRecords = collection->getRecordStore()->numRecords(opCtx);
+    if (numRecords < numWorkers * kMinRecordsPerWorker) {
+        return false;
+    }
+
+    auto ranges = splitCollectionIntoRanges(opCtx, collection, numWorkers);
+    const auto numRanges = ranges.size();
+    if (numRanges < 2) {
+        return false;
+    }
+
+    auto reservation =
+        ParallelPipelineWorkers::tryReserveThreads(opCtx->getServiceContext(), numRanges);
+    if (!reservation) {
+        LOGV2_DEBUG(4765017,
+                    2,
+                    "Not enough pipeline worker threads left for a parallel collection scan",
+                    "namespace"_attr = collection->ns(),
+                    "numRanges"_attr = numRanges);
+        return false;
+    }
+
+    auto groupLogic = groupStage->distributedPlanLogic();
+    invariant(groupLogic && groupLogic->shardsStage.get() == groupStage &&
+              groupLogic->mergingStage);
+
+    std::vector<Value> serializedPrefix;
+    auto prefixEnd = std::next(sources.begin(), prefixLength);
+    for (auto it = sources.begin(); it != prefixEnd; ++it) {
+        (*it)->serializeToArray(serializedPrefix);
+    }
+    std::vector<BSONObj> workerPipeline;
+    for (auto&& stage : serializedPrefix) {
+        workerPipeline.push_back(stage.getDocument().toBson());
+    }
+
+    for (size_t i = 0; i < prefixLength; ++i) {
+        pipeline->popFront();
+    }
+    pipeline->addInitialSource(std::move(groupLogic->mergingStage));
+    pipeline->addInitialSource(DocumentSourceParallelCollectionScan::create(
+        expCtx,
+        collection->uuid(),
+        std::move(workerPipeline),
+        std::move(ranges),
+        std::move(*reservation)));
+
+    LOGV2_DEBUG(4765001,
+                2,
+                "Running aggregation with a parallel collection scan",
+                "namespace"_attr = collection->ns(),
+                "numRanges"_attr = numRanges);
+    return true;
+}
+
+/**
+ * Returns the name of a top-level field of the input of 'groupStage' which its group key is a
+ * function of, such that documents in the same group always have the same value for that field, or
+ * boost::none if there is no such field.
+ */
+boost::optional<std::string> getGroupPartitionField(const DocumentSourceGroup& groupStage) {
+    boost::optional<std::string> partitionField;
+    for (auto&& [idField, expression] : groupStage.getIdFields()) {
+        auto fieldPathExpr = dynamic_cast<ExpressionFieldPath*>(expression.get());
+        if (!fieldPathExpr || !fieldPathExpr->isRootFieldPath() ||
+            fieldPathExpr->getFieldPath().getPathLength() != 2) {
+            continue;
+        }
+
+        // Pick the same field regardless of the iteration order of the group key fields.
+        auto fieldName = fieldPathExpr->getFieldPath().getFieldName(1).toString();
+        if (!partitionField || fieldName < *partitionField) {
+            partitionField = std::move(fieldName);
+        }
+    }
+    return partitionField;
+}
+
+/**
+ * Returns the specification of an exchange distributing documents evenly between 'numConsumers'
+ * consumers, by the hash of their 'keyField' field.
+ *
+ * The exchange sends documents without 'keyField' to consumer 0. Since $group does not tell a
+ * missing group key apart from a null one, the hash of null is sent to consumer 0 as well.
+ */
+ExchangeSpec makeHashedExchangeSpec(const std::string& keyField, int numConsumers) {
+    // Split the domain of the hashes into 'numConsumers' ranges of equal width.
+    std::vector<long long> consumerBoundaries;
+    const auto rangeWidth = std::numeric_limits<unsigned long long>::max() / numConsumers;
+    for (int consumerId = 1; consumerId < numConsumers; ++consumerId) {
+        consumerBoundaries.push_back(static_cast<long long>(
+            static_cast<unsigned long long>(std::numeric_limits<long long>::min()) +
+            consumerId * rangeWidth));
+    }
+
+    // Carve out a range holding only the hash of null.
+    const long long nullHash = BSONElementHasher::hash64(BSON("" << BSONNULL).firstElement(),
+                                                         BSONElementHasher::DEFAULT_HASH_SEED);
+    std::vector<long long> points = consumerBoundaries;
+    points.push_back(nullHash);
+    if (nullHash < std::numeric_limits<long long>::max()) {
+        points.push_back(nullHash + 1);
+    }
+    std::sort(points.begin(), points.end());
+    points.erase(std::unique(points.begin(), points.end()), points.end());
+
+    std::vector<BSONObj> boundaries{BSON(keyField << MINKEY)};
+    std::vector<int> consumerIds{0};
+    for (auto point : points) {
+        boundaries.push_back(BSON(keyField << point));
+        consumerIds.push_back(point == nullHash
+                                  ? 0
+                                  : std::upper_bound(consumerBoundaries.begin(),
+                                                     consumerBoundaries.end(),
+                                                     point) -
+                                      consumerBoundaries.begin());
+    }
+    boundaries.push_back(BSON(keyField << MAXKEY));
+
+    ExchangeSpec exchangeSpec;
+    exchangeSpec.setPolicy(ExchangePolicyEnum::kKeyRange);
+    exchangeSpec.setKey(BSON(keyField << "hashed"));
+    exchangeSpec.setBoundaries(std::move(boundaries));
+    exchangeSpec.setConsumers(numConsumers);
+    exchangeSpec.setConsumerIds(std::move(consumerIds));
+    return exchangeSpec;
+}
+
+/**
+ * Attempts to run a $group of 'pipeline', and the streaming stages preceding it, on several
+ * threads. The input of the $group is distributed between the threads by the hash of one of the
+ * fields making up the group key, so that each thread computes complete groups for its share of
+ * the group keys. The $group is replaced with a local exchange running a copy of the $group on
+ * each of the threads, and the stages preceding it feed the exchange.
+ *
+ * Returns false and leaves 'pipeline' unchanged if the pipeline or the operation does not allow
+ * it, or if the collection is too small to be worth it.
+ */
+bool attemptToUseLocalExchange(Collection* collection,
+                               const NamespaceString& nss,
+                               const AggregationRequest* aggRequest,
+                               Pipeline* pipeline) {
+    const int numConsumers = internalQueryLocalExchangeConsumers.load();
+    const auto& expCtx = pipeline->getContext();
+
+    // Hashing the group keys does not respect collations.
+    if (numConsumers < 2 || expCtx->getCollator() ||
+        !canReadFromWorkerThreads(collection, pipeline)) {
+        return false;
+    }
+
+    const auto& sources = pipeline->getSources();
+    auto groupIt = std::find_if_not(sources.begin(), sources.end(), [](auto&& source) {
+        return dynamic_cast<DocumentSourceMatch*>(source.get()) ||
+            dynamic_cast<DocumentSourceSingleDocumentTransformation*>(source.get()) ||
+            dynamic_cast<DocumentSourceUnwind*>(source.get());
+    });
+    auto groupStage =
+        groupIt == sources.end() ? nullptr : dynamic_cast<DocumentSourceGroup*>(groupIt->get());
+
+    // A $group which may be answered with a DISTINCT_SCAN is better left alone.
+    if (!groupStage || groupStage->rewriteGroupAsTransformOnFirstDocument()) {
+        return false;
+    }
+
+    auto partitionField = getGroupPartitionField(*groupStage);
+    if (!partitionField) {
+        return false;
+    }
+
+    if (collection->getRecordStore()->numRecords(expCtx->opCtx) <
+        numConsumers * kMinRecordsPerWorker) {
+        return false;
+    }
+
+    auto reservation = ParallelPipelineWorkers::tryReserveThreads(
+        expCtx->opCtx->getServiceContext(), numConsumers);
+    if (!reservation) {
+        LOGV2_DEBUG(4765018,
+                    2,
+                    "Not enough pipeline worker threads left for a local exchange",
+                    "namespace"_attr = nss,
+                    "numConsumers"_attr = numConsumers);
+        return false;
+    }
+
+    // The stages preceding the $group make up the input of the exchange, which gets a $cursor of
+    // its own.
+    std::vector<Value> serializedPrefix;
+    for (auto it = sources.begin(); it != groupIt; ++it) {
+        (*it)->serializeToArray(serializedPrefix);
+    }
+    std::vector<BSONObj> exchangeInputSpec;
+    for (auto&& stage : serializedPrefix) {
+        exchangeInputSpec.push_back(stage.getDocument().toBson());
+    }
+    auto exchangeInput =
+        Pipeline::parse(exchangeInputSpec, expCtx->copyWith(nss, collection->uuid()));
+    exchangeInput->optimizePipeline();
+    PipelineD::buildAndAttachInnerQueryExecutorToPipeline(
+        collection, nss, aggRequest, exchangeInput.get());
+    exchangeInput->optimizePipeline();
+
+    std::vector<Value> serializedGroup;
+    groupStage->serializeToArray(serializedGroup);
+    std::vector<BSONObj> consumerPipeline;
+    for (auto&& stage : serializedGroup) {
+        consumerPipeline.push_back(stage.getDocument().toBson());
+    }
+
+    const size_t prefixLength = std::distance(sources.begin(), groupIt) + 1;
+    boost::intrusive_ptr<Exchange> exchange =
+        new Exchange(makeHashedExchangeSpec(*partitionField, numConsumers),
+                     std::move(exchangeInput));
+    auto localExchange = DocumentSourceLocalExchange::create(
+        expCtx, std::move(exchange), std::move(consumerPipeline), std::move(*reservation));
+    for (size_t i = 0; i < prefixLength; ++i) {
+        pipeline->popFront();
+    }
+    pipeline->addInitialSource(std::move(localExchange));
+
+    LOGV2_DEBUG(4765002,
+                2,
+                "Running aggregation with a local exchange",
+                "namespace"_attr = nss,
+                "numConsumers"_attr = numConsumers,
+                "partitionField"_attr = *partitionField);
+    return true;
+}
 }  // namespace
 
 std::pair<PipelineD::AttachExecutorCallback, std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>>
@@ -359,6 +713,17 @@ PipelineD::buildInnerQueryExecutor(Collection* collection,
         }
     }
 
+    // Scan the collection on several threads if the pipeline allows for it, in which case the
+    // pipeline does not need a $cursor stage.
+    if (attemptToParallelizeCollectionScan(collection, aggRequest, pipeline)) {
+        return {};
+    }
+
+    // Otherwise, run the first $group of the pipeline on several threads if possible.
+    if (attemptToUseLocalExchange(collection, nss, aggRequest, pipeline)) {
+        return {};
+    }
+
     // If the first stage is $geoNear, prepare a special DocumentSourceGeoNearCursor stage;
     // otherwise, create a generic DocumentSourceCursor.
     const auto geoNearStage =
@@ -315,6 +315,9 @@ void CanonicalQuery::setCollator(std::unique_ptr<CollatorInterface> collator) {
 
     // In a similar vein, we must give the ExpressionContext the same collator.
     _expCtx->setCollator(_collator.get());
+
+    // The collation is part of the query's shape.
+    _shapeString = boost::none;
 }
 
 // static
@@ -553,8 +556,11 @@ std::string CanonicalQuery::toStringShort() const {
     return ss;
 }
 
-CanonicalQuery::QueryShapeString CanonicalQuery::encodeKey() const {
-    return canonical_query_encoder::encode(*this);
+const CanonicalQuery::QueryShapeString& CanonicalQuery::encodeKey() const {
+    if (!_shapeString) {
+        _shapeString = canonical_query_encoder::encode(*this);
+    }
+    return *_shapeString;
 }
 
 }  // namespace mongo
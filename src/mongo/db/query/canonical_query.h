@@ -173,9 +173,10 @@ public:
 
     /**
      * Compute the "shape" of this query by encoding the match, projection and sort, and stripping
-     * out the appropriate values.
+     * out the appropriate values. The shape is computed once and remembered, since it is needed
+     * several times while planning a single query.
      */
-    QueryShapeString encodeKey() const;
+    const QueryShapeString& encodeKey() const;
 
     /**
      * Sets this CanonicalQuery's collator, and sets the collator on this CanonicalQuery's match
@@ -253,6 +254,10 @@ private:
     std::unique_ptr<CollatorInterface> _collator;
 
     bool _canHaveNoopMatchNodes = false;
+
+    // Cached result of encodeKey(). Everything the shape depends on is fixed once the query has
+    // been canonicalized, except for the collator, so setCollator() resets it.
+    mutable boost::optional<QueryShapeString> _shapeString;
 };
 
 }  // namespace mongo
@@ -368,6 +368,25 @@ TEST(CanonicalQueryTest, SettingCollatorUpdatesCollatorAndMatchExpression) {
     ASSERT_EQUALS(inExpr->getCollator(), cq->getCollator());
 }
 
+TEST(CanonicalQueryTest, SettingCollatorChangesQueryShape) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    auto qr = std::make_unique<QueryRequest>(nss);
+    qr->setFilter(fromjson("{a: 'foo'}"));
+    auto cq = assertGet(CanonicalQuery::canonicalize(opCtx.get(), std::move(qr)));
+
+    const auto shapeWithoutCollation = cq->encodeKey();
+    ASSERT_EQUALS(shapeWithoutCollation, cq->encodeKey());
+
+    unique_ptr<CollatorInterface> collator =
+        assertGet(CollatorFactoryInterface::get(opCtx->getServiceContext())
+                      ->makeFromBSON(BSON("locale"
+                                          << "reverse")));
+    cq->setCollator(std::move(collator));
+    ASSERT_NOT_EQUALS(shapeWithoutCollation, cq->encodeKey());
+}
+
 TEST(CanonicalQueryTest, NorWithOneChildNormalizedToNot) {
     unique_ptr<CanonicalQuery> cq(canonicalize("{$nor: [{a: 1}]}"));
     auto root = cq->root();
@@ -52,7 +52,9 @@ std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> InternalPlanner::collection
     StringData ns,
     Collection* collection,
     PlanExecutor::YieldPolicy yieldPolicy,
-    const Direction direction) {
+    const Direction direction,
+    boost::optional<RecordId> minRecord,
+    boost::optional<RecordId> maxRecord) {
     std::unique_ptr<WorkingSet> ws = std::make_unique<WorkingSet>();
 
     if (nullptr == collection) {
@@ -66,7 +68,7 @@ std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> InternalPlanner::collection
 
     invariant(ns == collection->ns().ns());
 
-    auto cs = _collectionScan(opCtx, ws.get(), collection, direction);
+    auto cs = _collectionScan(opCtx, ws.get(), collection, direction, minRecord, maxRecord);
 
     // Takes ownership of 'ws' and 'cs'.
     auto statusWithPlanExecutor =
@@ -183,11 +185,15 @@ std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> InternalPlanner::updateWith
 std::unique_ptr<PlanStage> InternalPlanner::_collectionScan(OperationContext* opCtx,
                                                             WorkingSet* ws,
                                                             const Collection* collection,
-                                                            Direction direction) {
+                                                            Direction direction,
+                                                            boost::optional<RecordId> minRecord,
+                                                            boost::optional<RecordId> maxRecord) {
     invariant(collection);
 
     CollectionScanParams params;
     params.shouldWaitForOplogVisibility = shouldWaitForOplogVisibility(opCtx, collection, false);
+    params.minRecord = minRecord;
+    params.maxRecord = maxRecord;
 
     if (FORWARD == direction) {
         params.direction = CollectionScanParams::FORWARD;
@@ -67,13 +67,18 @@ public:
 
     /**
      * Returns a collection scan.  Caller owns pointer.
+     *
+     * If 'minRecord' or 'maxRecord' are given, the forward scan only returns the records whose
+     * RecordIds fall in ['minRecord', 'maxRecord').
      */
     static std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> collectionScan(
         OperationContext* opCtx,
         StringData ns,
         Collection* collection,
         PlanExecutor::YieldPolicy yieldPolicy,
-        const Direction direction = FORWARD);
+        const Direction direction = FORWARD,
+        boost::optional<RecordId> minRecord = boost::none,
+        boost::optional<RecordId> maxRecord = boost::none);
 
     /**
      * Returns a FETCH => DELETE plan.
@@ -130,10 +135,13 @@ private:
      *
      * Used as a helper for collectionScan() and deleteWithCollectionScan().
      */
-    static std::unique_ptr<PlanStage> _collectionScan(OperationContext* opCtx,
-                                                      WorkingSet* ws,
-                                                      const Collection* collection,
-                                                      Direction direction);
+    static std::unique_ptr<PlanStage> _collectionScan(
+        OperationContext* opCtx,
+        WorkingSet* ws,
+        const Collection* collection,
+        Direction direction,
+        boost::optional<RecordId> minRecord = boost::none,
+        boost::optional<RecordId> maxRecord = boost::none);
 
     /**
      * Returns a plan stage that is either an index scan or an index scan with a fetch stage.
@@ -461,7 +461,13 @@ public:
      */
     PlanCache();
 
-    PlanCache(size_t size);
+    /**
+     * Constructs a cache holding up to 'size' entries, split across 'numPartitions' independently
+     * locked partitions. Each partition applies its own LRU policy to its share of 'size', so
+     * eviction is only approximately least recently used across the whole cache when there is
+     * more than one partition.
+     */
+    PlanCache(size_t size, size_t numPartitions = 1);
 
     ~PlanCache();
 
@@ -601,10 +607,26 @@ private:
                                    size_t newWorks,
                                    double growthCoefficient);
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry, PlanCacheKeyHasher> _cache;
+    /**
+     * A slice of the cache owning the entries whose keys hash to it. Queries of different shapes
+     * usually land in different partitions and so do not contend on the same mutex.
+     */
+    struct Partition {
+        explicit Partition(size_t size) : cache(size) {}
+
+        LRUKeyValue<PlanCacheKey, PlanCacheEntry, PlanCacheKeyHasher> cache;
+
+        // Protects 'cache'.
+        mutable Mutex mutex = MONGO_MAKE_LATCH("PlanCache::Partition::mutex");
+    };
+
+    /**
+     * Returns the partition responsible for 'key'.
+     */
+    Partition& getPartition(const PlanCacheKey& key) const;
 
-    // Protects _cache.
-    mutable Mutex _cacheMutex = MONGO_MAKE_LATCH("PlanCache::_cacheMutex");
+    // Never empty. Partitions are never added or removed after construction.
+    std::vector<std::unique_ptr<Partition>> _partitions;
 
     // Holds computed information about the collection's indexes.  Used for generating plan
     // cache keys.
@@ -569,6 +569,27 @@ TEST(PlanCacheTest, PlanCacheLRUPolicyRemovesInactiveEntries) {
     ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kPresentInactive);
 }
 
+TEST(PlanCacheTest, PartitionedPlanCacheRespectsTotalSize) {
+    // More partitions than entries, so each partition can hold at most one entry.
+    const size_t kCacheSize = 3;
+    PlanCache planCache(kCacheSize, 16);
+    QueryTestServiceContext serviceContext;
+
+    const std::vector<std::string> fields{"a", "b", "c", "d", "e", "f", "g", "h"};
+    for (auto&& field : fields) {
+        unique_ptr<CanonicalQuery> cq(canonicalize(BSON(field << 1)));
+        addCacheEntryForShape(*cq, &planCache);
+
+        // The entry just added is the most recently used one in its partition.
+        ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentInactive);
+        ASSERT_LTE(planCache.size(), kCacheSize);
+    }
+    ASSERT_EQ(planCache.getAllEntries().size(), planCache.size());
+
+    planCache.clear();
+    ASSERT_EQ(planCache.size(), 0U);
+}
+
 TEST(PlanCacheTest, PlanCacheRemoveDeletesInactiveEntries) {
     PlanCache planCache;
     unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
@@ -54,6 +54,7 @@
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/mock_yield_policies.h"
 #include "mongo/db/query/plan_yield_policy.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/service_context.h"
 #include "mongo/logv2/log.h"
@@ -234,7 +235,8 @@ PlanExecutorImpl::PlanExecutorImpl(OperationContext* opCtx,
       _root(std::move(rt)),
       _nss(std::move(nss)),
       // There's no point in yielding if the collection doesn't exist.
-      _yieldPolicy(makeYieldPolicy(this, collection ? yieldPolicy : NO_YIELD)) {
+      _yieldPolicy(makeYieldPolicy(this, collection ? yieldPolicy : NO_YIELD)),
+      _batchSize(internalQueryExecBatchSize.load()) {
     invariant(!_expCtx || _expCtx->opCtx == _opCtx);
     invariant(!_cq || !_expCtx || _cq->getExpCtx() == _expCtx);
 
@@ -332,6 +334,11 @@ const boost::intrusive_ptr<ExpressionContext>& PlanExecutorImpl::getExpCtx() con
 void PlanExecutorImpl::saveState() {
     invariant(_currentState == kUsable || _currentState == kSaved);
 
+    // Results of a batch may still point into storage engine memory.
+    for (size_t i = _batchPos; i < _batch.size(); ++i) {
+        _workingSet->get(_batch[i])->makeObjOwnedIfNeeded();
+    }
+
     if (!isMarkedAsKilled()) {
         _root->saveState();
     }
@@ -505,6 +512,42 @@ PlanExecutor::ExecState PlanExecutorImpl::_waitForInserts(CappedInsertNotifierDa
     return FAILURE;
 }
 
+PlanStage::StageState PlanExecutorImpl::_workRoot(WorkingSetID* out) {
+    if (_batchSize == 0) {
+        return _root->work(out);
+    }
+
+    if (_batchPos < _batch.size()) {
+        *out = _batch[_batchPos++];
+        return PlanStage::ADVANCED;
+    }
+
+    if (_batchEndState != PlanStage::NEED_TIME) {
+        // All results of the last batch have been returned, so report the state which ended it.
+        PlanStage::StageState state = _batchEndState;
+        *out = _batchEndId;
+        _batchEndState = PlanStage::NEED_TIME;
+        _batchEndId = WorkingSet::INVALID_ID;
+        return state;
+    }
+
+    _batch.clear();
+    _batchPos = 0;
+    WorkingSetID endId = WorkingSet::INVALID_ID;
+    PlanStage::StageState state = _root->workBatch(_batchSize, &_batch, &endId);
+    if (_batch.empty()) {
+        *out = endId;
+        return state;
+    }
+
+    if (state != PlanStage::ADVANCED && state != PlanStage::NEED_TIME) {
+        _batchEndState = state;
+        _batchEndId = endId;
+    }
+    *out = _batch[_batchPos++];
+    return PlanStage::ADVANCED;
+}
+
 PlanExecutor::ExecState PlanExecutorImpl::_getNextImpl(Snapshotted<Document>* objOut,
                                                        RecordId* dlOut) {
     if (MONGO_unlikely(planExecutorAlwaysFails.shouldFail())) {
@@ -561,7 +604,7 @@ PlanExecutor::ExecState PlanExecutorImpl::_getNextImpl(Snapshotted<Document>* ob
         }
 
         WorkingSetID id = WorkingSet::INVALID_ID;
-        PlanStage::StageState code = _root->work(&id);
+        PlanStage::StageState code = _workRoot(&id);
 
         if (code != PlanStage::NEED_YIELD)
             writeConflictsInARow = 0;
@@ -666,7 +709,9 @@ PlanExecutor::ExecState PlanExecutorImpl::_getNextImpl(Snapshotted<Document>* ob
 
 bool PlanExecutorImpl::isEOF() {
     invariant(_currentState == kUsable);
-    return isMarkedAsKilled() || (_stash.empty() && _root->isEOF());
+    return isMarkedAsKilled() ||
+        (_stash.empty() && _batchPos == _batch.size() &&
+         _batchEndState == PlanStage::NEED_TIME && _root->isEOF());
 }
 
 void PlanExecutorImpl::markAsKilled(Status killStatus) {
@@ -31,7 +31,10 @@
 
 #include <boost/optional.hpp>
 #include <queue>
+#include <vector>
 
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/working_set.h"
 #include "mongo/db/query/plan_executor.h"
 
 namespace mongo {
@@ -150,6 +153,13 @@ private:
     ExecState _waitForInserts(CappedInsertNotifierData* notifierData,
                               Snapshotted<Document>* errorObj);
 
+    /**
+     * Produces the next result of the plan stage tree, with the same contract as
+     * PlanStage::work(). When batched execution is enabled, results are pulled from the root with
+     * PlanStage::workBatch() and handed out one at a time from '_batch'.
+     */
+    PlanStage::StageState _workRoot(WorkingSetID* out);
+
     /**
      * Common implementation for getNext() and getNextSnapshotted().
      */
@@ -189,6 +199,19 @@ private:
     // stages.
     std::queue<Document> _stash;
 
+    // The maximum number of units of work to request from the root stage per call to
+    // PlanStage::workBatch(), fixed when the executor is created. Zero means results are produced
+    // one at a time with PlanStage::work().
+    const size_t _batchSize;
+
+    // Results of the last call to PlanStage::workBatch() which have not been returned yet, starting
+    // at '_batchPos', followed by the state and WSID which ended that batch. '_batchEndState' is
+    // NEED_TIME when there is nothing left to report.
+    std::vector<WorkingSetID> _batch;
+    size_t _batchPos = 0;
+    PlanStage::StageState _batchEndState = PlanStage::NEED_TIME;
+    WorkingSetID _batchEndId = WorkingSet::INVALID_ID;
+
     // The output document that is used by getNext BSON API. This allows us to avoid constantly
     // allocating and freeing DocumentStorage.
     Document _docOutput;
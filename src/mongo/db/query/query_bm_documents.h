@@ -0,0 +1,77 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <benchmark/benchmark.h>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/random.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+
+/**
+ * Builds 'numDocs' documents, each with an integer '_id', a random integer 'a' and 'numFields'
+ * additional string fields, so that a query benchmark can vary the size and shape of its input.
+ * The same arguments always produce the same documents.
+ */
+inline std::vector<BSONObj> makeBenchmarkDocuments(int64_t numDocs, int64_t numFields) {
+    PseudoRandom random(int64_t{1});
+    std::vector<BSONObj> docs;
+    docs.reserve(numDocs);
+    for (int64_t i = 0; i < numDocs; ++i) {
+        BSONObjBuilder bob;
+        bob.append("_id", static_cast<long long>(i));
+        bob.append("a", random.nextInt32(1000));
+        for (int64_t field = 0; field < numFields; ++field) {
+            bob.append(str::stream() << "f" << field,
+                       str::stream() << "value" << random.nextInt32());
+        }
+        docs.push_back(bob.obj());
+    }
+    return docs;
+}
+
+/**
+ * Registers the input shapes shared by the query benchmarks. Arguments are the number of
+ * documents and the number of additional fields per document, as taken by
+ * makeBenchmarkDocuments().
+ */
+inline void benchmarkDocumentShapes(benchmark::internal::Benchmark* bm) {
+    for (int64_t numDocs : {1000, 10 * 1000}) {
+        for (int64_t numFields : {0, 10, 50}) {
+            bm->Args({numDocs, numFields});
+        }
+    }
+}
+
+}  // namespace mongo
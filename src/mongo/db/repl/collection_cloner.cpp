@@ -31,7 +31,12 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/base/string_data.h"
+#include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands/list_collections_filter.h"
 #include "mongo/db/index_builds_coordinator.h"
 #include "mongo/db/repl/collection_bulk_loader.h"
@@ -40,11 +45,23 @@
 #include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/logv2/log.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace repl {
+namespace {
+
+// Collections with fewer documents than this per partition are not worth splitting.
+const size_t kMinDocumentsPerPartition = 100 * 1000;
+
+// The number of _id values sampled from the source for each partition.
+const size_t kSamplesPerPartition = 32;
+
+}  // namespace
 
 // Failpoint which causes initial sync to hang when it has cloned 'numDocsToClone' documents to
 // collection 'namespace'.
@@ -66,9 +83,11 @@ CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
       _collectionOptions(collectionOptions),
       _sourceDbAndUuid(NamespaceString("UNINITIALIZED")),
       _collectionClonerBatchSize(collectionClonerBatchSize),
+      _collectionClonerPartitions(collectionClonerPartitions),
       _countStage("count", this, &CollectionCloner::countStage),
       _listIndexesStage("listIndexes", this, &CollectionCloner::listIndexesStage),
       _createCollectionStage("createCollection", this, &CollectionCloner::createCollectionStage),
+      _partitionStage("partition", this, &CollectionCloner::partitionStage),
       _queryStage("query", this, &CollectionCloner::queryStage),
       _progressMeter(1U,  // total will be replaced with count command result.
                      kProgressMeterSecondsBetween,
@@ -89,6 +108,8 @@ CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
           _dbWorkTaskRunner.schedule(std::move(task));
           return executor::TaskExecutor::CallbackHandle();
       }),
+      _createClientFn(
+          [] { return std::make_unique<DBClientConnection>(true /* autoReconnect */); }),
       _dbWorkTaskRunner(dbPool) {
     invariant(sourceNss.isValid());
     invariant(collectionOptions.uuid);
@@ -100,7 +121,8 @@ CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
 }
 
 BaseCloner::ClonerStages CollectionCloner::getStages() {
-    return {&_countStage, &_listIndexesStage, &_createCollectionStage, &_queryStage};
+    return {
+        &_countStage, &_listIndexesStage, &_createCollectionStage, &_partitionStage, &_queryStage};
 }
 
 
@@ -193,10 +215,81 @@ BaseCloner::AfterStageBehavior CollectionCloner::createCollectionStage() {
     return kContinueNormally;
 }
 
+BaseCloner::AfterStageBehavior CollectionCloner::partitionStage() {
+    _partitions.clear();
+    // Ranges are bounded by raw _id index keys, which only order documents the way the query
+    // sees them under the simple collation. Capped collections must keep their insertion order.
+    if (_collectionClonerPartitions <= 1 || !_resumeSupported || _idIndexSpec.isEmpty() ||
+        _collectionOptions.capped || !_collectionOptions.collation.isEmpty()) {
+        return kContinueNormally;
+    }
+
+    size_t documentCount;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        documentCount = _stats.documentToCopy;
+    }
+    const size_t numPartitions = std::min(static_cast<size_t>(_collectionClonerPartitions),
+                                          documentCount / kMinDocumentsPerPartition);
+    if (numPartitions <= 1) {
+        return kContinueNormally;
+    }
+
+    const size_t sampleSize = numPartitions * kSamplesPerPartition;
+    BSONObj res;
+    auto cmdObj = BSON("aggregate" << _sourceNss.coll() << "pipeline"
+                                   << BSON_ARRAY(BSON("$sample" << BSON("size" << int(sampleSize)))
+                                                 << BSON("$project" << BSON("_id" << 1)))
+                                   << "cursor" << BSON("batchSize" << int(sampleSize)));
+    getClient()->runCommand(_sourceNss.db().toString(), cmdObj, res, QueryOption_SlaveOk);
+    auto status = getStatusFromCommandResult(res);
+    if (!status.isOK()) {
+        LOGV2(4765013,
+              "Cloning collection with a single query because sampling its _id values failed",
+              "ns"_attr = _sourceNss,
+              "error"_attr = status);
+        return kContinueNormally;
+    }
+
+    // The sampled documents point into 'res', which outlives 'ids'.
+    std::vector<BSONElement> ids;
+    for (auto&& doc : res["cursor"]["firstBatch"].Obj()) {
+        ids.push_back(doc.Obj()["_id"]);
+    }
+    if (ids.size() < numPartitions) {
+        return kContinueNormally;
+    }
+    std::sort(ids.begin(), ids.end(), SimpleBSONElementComparator::kInstance.makeLessThan());
+
+    BSONObj lower;
+    for (size_t i = 1; i < numPartitions; ++i) {
+        auto upper = ids[i * ids.size() / numPartitions].wrap();
+        if (!lower.isEmpty() && SimpleBSONObjComparator::kInstance.evaluate(upper <= lower)) {
+            continue;
+        }
+        _partitions.push_back({lower, upper});
+        lower = upper;
+    }
+    if (_partitions.empty()) {
+        return kContinueNormally;
+    }
+    _partitions.push_back({lower, BSONObj()});
+
+    LOGV2(4765014,
+          "Cloning collection with concurrent _id range queries",
+          "ns"_attr = _sourceNss,
+          "partitions"_attr = _partitions.size());
+    return kContinueNormally;
+}
+
 BaseCloner::AfterStageBehavior CollectionCloner::queryStage() {
-    // Attempt to clean up cursor from the last retry (if applicable).
-    killOldQueryCursor();
-    runQuery();
+    if (_partitions.empty()) {
+        // Attempt to clean up cursor from the last retry (if applicable).
+        killOldQueryCursor();
+        runQuery();
+    } else {
+        queryPartitions();
+    }
     waitForDatabaseWorkToComplete();
     // We want to free the _collLoader regardless of whether the commit succeeds.
     std::unique_ptr<CollectionBulkLoader> loader = std::move(_collLoader);
@@ -274,17 +367,151 @@ void CollectionCloner::runQuery() {
     }
 }
 
-void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
-    {
-        stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
-        if (!getSharedData()->getInitialSyncStatus(lk).isOK()) {
-            std::string message = str::stream()
-                << "Collection cloning cancelled due to initial sync failure: "
-                << getSharedData()->getInitialSyncStatus(lk).toString();
-            LOGV2(21136, "{message}", "message"_attr = message);
-            uasserted(ErrorCodes::CallbackCanceled, message);
+void CollectionCloner::queryPartitions() {
+    // Attempt to clean up the cursors of partitions which failed on the last retry.
+    killOldPartitionCursors();
+
+    std::vector<QueryPartition*> pending;
+    for (auto&& partition : _partitions) {
+        if (!partition.done) {
+            pending.push_back(&partition);
         }
     }
+    if (pending.empty()) {
+        return;
+    }
+
+    std::vector<Status> statuses(pending.size(), Status::OK());
+    std::vector<stdx::thread> helpers;
+    for (size_t i = 1; i < pending.size(); ++i) {
+        helpers.emplace_back([this, &pending, &statuses, i] {
+            Client::initThread("CollectionClonerPartition");
+            try {
+                auto client = _createClientFn();
+                // The InitialSyncer only knows about its own connection, so shut this one down
+                // when initial sync fails or is canceled to interrupt the query blocked on it.
+                int onFailureHandle;
+                {
+                    stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+                    onFailureHandle = getSharedData()->registerOnFailure(
+                        lk, [&client] { client->shutdownAndDisallowReconnect(); });
+                }
+                ON_BLOCK_EXIT([&] {
+                    stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+                    getSharedData()->unregisterOnFailure(lk, onFailureHandle);
+                });
+
+                uassertStatusOK(client->connect(getSource(), "CollectionClonerPartition"));
+                uassertStatusOK(replAuthenticate(client.get())
+                                    .withContext(str::stream()
+                                                 << "Failed to authenticate to " << getSource()));
+                runPartitionQuery(client.get(), pending[i]);
+            } catch (...) {
+                statuses[i] = exceptionToStatus();
+            }
+        });
+    }
+    try {
+        runPartitionQuery(getClient(), pending[0]);
+    } catch (...) {
+        statuses[0] = exceptionToStatus();
+    }
+    for (auto&& helper : helpers) {
+        helper.join();
+    }
+
+    for (auto&& status : statuses) {
+        uassertStatusOK(status);
+    }
+}
+
+void CollectionCloner::runPartitionQuery(DBClientConnection* client, QueryPartition* partition) {
+    Query query = QUERY("query" << BSONObj() << "$readOnce" << true);
+    query.hint(BSON("_id" << 1));
+    // The bounds are _id index keys rather than a filter on _id, so that a range spanning several
+    // BSON types is not narrowed by type bracketing.
+    const bool resuming = !partition->lastId.isEmpty();
+    const BSONObj& min = resuming ? partition->lastId : partition->min;
+    if (!min.isEmpty()) {
+        query.minKey(min);
+    }
+    if (!partition->max.isEmpty()) {
+        query.maxKey(partition->max);
+    }
+
+    // $min is inclusive, so a resumed query returns the last copied document again first.
+    bool skipLastId = resuming;
+    bool firstBatch = true;
+    auto handleBatch = [&](DBClientCursorBatchIterator& iter) {
+        checkInitialSyncStatus();
+
+        if (firstBatch) {
+            partition->cursorId = iter.getCursorId();
+            firstBatch = false;
+        }
+
+        std::vector<BSONObj> docs;
+        while (iter.moreInCurrentBatch()) {
+            auto doc = iter.nextSafe();
+            if (skipLastId) {
+                skipLastId = false;
+                if (SimpleBSONElementComparator::kInstance.evaluate(
+                        doc["_id"] == partition->lastId.firstElement())) {
+                    continue;
+                }
+            }
+            docs.push_back(std::move(doc));
+        }
+        if (docs.empty()) {
+            return;
+        }
+        auto lastId = docs.back()["_id"].wrap();
+
+        bool needsInsertTask;
+        {
+            stdx::lock_guard<Latch> lk(_mutex);
+            _stats.receivedBatches++;
+            // Only schedule an insertion if none is already pending for the buffered documents.
+            needsInsertTask = _documentsToInsert.empty();
+            std::move(docs.begin(), docs.end(), std::back_inserter(_documentsToInsert));
+        }
+        partition->lastId = std::move(lastId);
+
+        if (needsInsertTask) {
+            auto&& scheduleResult =
+                _scheduleDbWorkFn([=](const executor::TaskExecutor::CallbackArgs& cbd) {
+                    insertDocumentsCallback(cbd);
+                });
+            uassertStatusOK(scheduleResult.getStatus().withContext(
+                str::stream() << "Error cloning collection '" << _sourceNss.ns() << "'"));
+        }
+    };
+
+    partition->cursorId = 0;
+    client->query(handleBatch,
+                  _sourceDbAndUuid,
+                  query,
+                  nullptr /* fieldsToReturn */,
+                  QueryOption_NoCursorTimeout | QueryOption_SlaveOk |
+                      (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
+                  _collectionClonerBatchSize);
+    partition->cursorId = 0;
+    partition->done = true;
+}
+
+void CollectionCloner::checkInitialSyncStatus() {
+    stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+    if (!getSharedData()->getInitialSyncStatus(lk).isOK()) {
+        std::string message = str::stream()
+            << "Collection cloning cancelled due to initial sync failure: "
+            << getSharedData()->getInitialSyncStatus(lk).toString();
+        LOGV2(21136, "{message}", "message"_attr = message);
+        uasserted(ErrorCodes::CallbackCanceled, message);
+    }
+}
+
+void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
+    checkInitialSyncStatus();
 
     // If this is 'true', it means that something happened to our remote cursor for a reason other
     // than the collection being dropped, all while we were running a non-resumable (4.2) clone.
@@ -413,6 +640,32 @@ void CollectionCloner::killOldQueryCursor() {
     _remoteCursorId = -1;
 }
 
+void CollectionCloner::killOldPartitionCursors() {
+    BSONArrayBuilder ids;
+    for (auto&& partition : _partitions) {
+        if (partition.cursorId != 0) {
+            ids.append(partition.cursorId);
+            partition.cursorId = 0;
+        }
+    }
+    if (ids.arrSize() == 0) {
+        return;
+    }
+
+    // The cursors do not time out, so kill them through our own connection now that the
+    // connections they were opened on are gone.
+    BSONObj infoObj;
+    auto cmdObj = BSON("killCursors" << _sourceNss.coll() << "cursors" << ids.arr());
+    LOGV2_DEBUG(4765015, 1, "Attempting to kill old partition cursors", "cmd"_attr = cmdObj);
+    try {
+        getClient()->runCommand(_sourceNss.db().toString(), cmdObj, infoObj);
+    } catch (...) {
+        LOGV2(4765016,
+              "Error while trying to kill partition cursors after transient query error",
+              "error"_attr = exceptionToStatus());
+    }
+}
+
 void CollectionCloner::forgetOldQueryCursor() {
     _remoteCursorId = -1;
 }
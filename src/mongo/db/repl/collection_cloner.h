@@ -46,6 +46,11 @@ const int kProgressMeterCheckInterval = 128;
 
 class CollectionCloner final : public BaseCloner {
 public:
+    /**
+     * Type of function to create the connections partitions are queried on. Used for testing only.
+     */
+    using CreateClientFn = std::function<std::unique_ptr<DBClientConnection>()>;
+
     struct Stats {
         static constexpr StringData kDocumentsToCopyFieldName = "documentsToCopy"_sd;
         static constexpr StringData kDocumentsCopiedFieldName = "documentsCopied"_sd;
@@ -108,6 +113,16 @@ public:
         _collectionClonerBatchSize = batchSize;
     }
 
+    /**
+     * Set the maximum number of _id ranges queried concurrently.
+     *
+     * Used for testing only.  Set by server parameter 'collectionClonerPartitions' in normal
+     * operation.
+     */
+    void setPartitions_forTest(int partitions) {
+        _collectionClonerPartitions = partitions;
+    }
+
     /**
      * Overrides how executor schedules database work.
      *
@@ -117,6 +132,16 @@ public:
         _scheduleDbWorkFn = std::move(scheduleDbWorkFn);
     }
 
+    /**
+     * Overrides how the connections for all but the first partition are created. The cloner
+     * connects and authenticates them itself.
+     *
+     * For testing only.
+     */
+    void setCreateClientFn_forTest(const CreateClientFn& createClientFn) {
+        _createClientFn = createClientFn;
+    }
+
 protected:
     ClonerStages getStages() final;
 
@@ -125,6 +150,20 @@ protected:
 private:
     friend class CollectionClonerTest;
 
+    /**
+     * A range of the _id index queried on its own connection.  'min' is inclusive and 'max' is
+     * exclusive; an empty bound leaves that side of the range open.  'lastId' holds the _id of the
+     * last document handed to the bulk loader, so a retried query can resume after it.
+     * 'cursorId' is the remote cursor of the last query, killed before the partition is retried.
+     */
+    struct QueryPartition {
+        BSONObj min;
+        BSONObj max;
+        BSONObj lastId;
+        long long cursorId = 0;
+        bool done = false;
+    };
+
     class CollectionClonerStage : public ClonerStage<CollectionCloner> {
     public:
         CollectionClonerStage(std::string name, CollectionCloner* cloner, ClonerRunFn stageFunc)
@@ -191,6 +230,14 @@ private:
      */
     AfterStageBehavior createCollectionStage();
 
+    /**
+     * Stage function that splits a large collection into _id ranges to be queried concurrently,
+     * using a sample of the _id values on the source.  Leaves _partitions empty, so the
+     * collection is read by a single query, when the collection does not qualify or sampling
+     * fails.
+     */
+    AfterStageBehavior partitionStage();
+
     /**
      * Stage function that executes a query to retrieve all documents in the collection.  For each
      * batch returned by the upstream node, handleNextBatch will be called with the data.  This
@@ -204,6 +251,11 @@ private:
      */
     void handleNextBatch(DBClientCursorBatchIterator& iter);
 
+    /**
+     * Throws CallbackCanceled if initial sync has failed, so that a running query stops early.
+     */
+    void checkInitialSyncStatus();
+
     /**
      * Called whenever there is a new batch of documents ready from the DBClientConnection.
      *
@@ -218,12 +270,31 @@ private:
      */
     void runQuery();
 
+    /**
+     * Queries every unfinished partition concurrently: the first on this thread's client and the
+     * rest on threads with their own connections to the sync source, which are shut down if
+     * initial sync fails or is canceled.  Throws the first error after all of them have stopped;
+     * finished partitions are not queried again on retry.
+     */
+    void queryPartitions();
+
+    /**
+     * Queries the documents of a single _id range and feeds them to the bulk loader, resuming
+     * after 'partition->lastId' when a previous attempt made progress.
+     */
+    void runPartitionQuery(DBClientConnection* client, QueryPartition* partition);
+
     /**
      * Attempts to clean up the cursor on the upstream node. This is called any time we
      * receive a transient error during the query stage.
      */
     void killOldQueryCursor();
 
+    /**
+     * Kills the remote cursors left open by partitions whose last query failed.
+     */
+    void killOldPartitionCursors();
+
     /**
      * Clears the stored id of the remote cursor so that we do not attempt to kill it.
      * We call this when we know it has already been killed by the sync source itself.
@@ -249,10 +320,13 @@ private:
     NamespaceStringOrUUID _sourceDbAndUuid;  // (R)
     // The size of the batches of documents returned in collection cloning.
     int _collectionClonerBatchSize;  // (R)
+    // The maximum number of _id ranges queried concurrently.
+    int _collectionClonerPartitions;  // (R)
 
     CollectionClonerStage _countStage;             // (R)
     CollectionClonerStage _listIndexesStage;       // (R)
     CollectionClonerStage _createCollectionStage;  // (R)
+    CollectionClonerStage _partitionStage;         // (R)
     CollectionClonerQueryStage _queryStage;        // (R)
 
     ProgressMeter _progressMeter;                       // (X) progress meter for this instance.
@@ -261,6 +335,8 @@ private:
     std::unique_ptr<CollectionBulkLoader> _collLoader;  // (X)
     //  Function for scheduling database work using the executor.
     ScheduleDbWorkFn _scheduleDbWorkFn;  // (R)
+    // Function for creating the connections partitions are queried on.
+    CreateClientFn _createClientFn;  // (R)
     // Documents read from source to insert.
     std::vector<BSONObj> _documentsToInsert;  // (M)
     Stats _stats;                             // (M)
@@ -277,6 +353,10 @@ private:
     // The cursorId of the remote collection cursor.
     long long _remoteCursorId = -1;  // (X)
 
+    // The _id ranges queried concurrently; empty when the collection is read by a single query.
+    // Each partition is only written by the thread querying it while the query stage runs.
+    std::vector<QueryPartition> _partitions;  // (X)
+
     // If true, it means we are starting a new query or resuming an interrupted one.
     bool _firstBatchOfQueryRound = true;  // (X)
 
@@ -38,6 +38,7 @@
 #include "mongo/db/repl/storage_interface_mock.h"
 #include "mongo/db/service_context_test_fixture.h"
 #include "mongo/dbtests/mock/mock_dbclient_connection.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/thread_pool.h"
 
@@ -54,6 +55,27 @@ public:
     }
 };
 
+// A connection which fails its query after handing the first batch to the caller.
+class FailAfterFirstBatchConnection : public MockDBClientConnection {
+public:
+    using MockDBClientConnection::MockDBClientConnection;
+    using MockDBClientConnection::query;
+
+    unsigned long long query(std::function<void(DBClientCursorBatchIterator&)> f,
+                             const NamespaceStringOrUUID& nsOrUuid,
+                             Query query,
+                             const BSONObj* fieldsToReturn,
+                             int queryOptions,
+                             int batchSize) override {
+        auto handleFirstBatch = [&](DBClientCursorBatchIterator& iter) {
+            f(iter);
+            uasserted(ErrorCodes::HostUnreachable, "Failing query after its first batch");
+        };
+        return MockDBClientConnection::query(
+            handleFirstBatch, nsOrUuid, query, fieldsToReturn, queryOptions, batchSize);
+    }
+};
+
 class CollectionClonerTest : public ClonerTestFixture {
 public:
     CollectionClonerTest() {}
@@ -109,10 +131,36 @@ protected:
         return cloner->_idIndexSpec;
     }
 
+    std::vector<CollectionCloner::QueryPartition>& getPartitions(CollectionCloner* cloner) {
+        return cloner->_partitions;
+    }
+
+    /**
+     * Makes a cloner which splits the collection into two partitions at {_id: 2}.  The first
+     * partition is read through '_mockServer' and the second through '_partitionServer'.  Mock
+     * servers ignore the partition bounds, so each should only hold its own partition's documents.
+     */
+    std::unique_ptr<CollectionCloner> makePartitionedCollectionCloner() {
+        _mockServer->setCommandReply("count", createCountResponse(1000 * 1000));
+        _mockServer->setCommandReply("listIndexes",
+                                     createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+        _mockServer->setCommandReply(
+            "aggregate",
+            createCursorResponse(_nss.ns(), BSON_ARRAY(BSON("_id" << 0) << BSON("_id" << 2))));
+        _mockServer->setCommandReply("killCursors", fromjson("{ok:1}"));
+        _partitionServer = std::make_unique<MockRemoteDBServer>(_source.toString());
+        _partitionServer->assignCollectionUuid(_nss.ns(), _collUuid);
+
+        auto cloner = makeCollectionCloner();
+        cloner->setPartitions_forTest(2);
+        return cloner;
+    }
+
     std::shared_ptr<CollectionMockStats> _collectionStats;  // Used by the _loader.
     StorageInterfaceMock::CreateCollectionForBulkFn _standardCreateCollectionFn;
     CollectionBulkLoaderMock* _loader = nullptr;  // Owned by CollectionCloner.
     CollectionOptions _options;
+    std::unique_ptr<MockRemoteDBServer> _partitionServer;
 
     NamespaceString _nss = {"testDb", "testColl"};
     UUID _collUuid = UUID::gen();
@@ -285,6 +333,207 @@ TEST_F(CollectionClonerTest, BeginCollectionFailed) {
     ASSERT_EQUALS(ErrorCodes::OperationFailed, cloner->run());
 }
 
+TEST_F(CollectionClonerTest, PartitionStageSplitsOnSampledIds) {
+    auto cloner = makeCollectionCloner();
+    cloner->setPartitions_forTest(4);
+    cloner->setStopAfterStage_forTest("partition");
+    _mockServer->setCommandReply("count", createCountResponse(1000 * 1000));
+    _mockServer->setCommandReply("listIndexes",
+                                 createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+    BSONArrayBuilder sample;
+    for (int i = 0; i < 8; ++i) {
+        sample.append(BSON("_id" << (i * 5) % 8));
+    }
+    _mockServer->setCommandReply("aggregate", createCursorResponse(_nss.ns(), sample.arr()));
+    ASSERT_OK(cloner->run());
+
+    auto& partitions = getPartitions(cloner.get());
+    ASSERT_EQ(4U, partitions.size());
+    ASSERT_BSONOBJ_EQ(BSONObj(), partitions[0].min);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2), partitions[0].max);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 2), partitions[1].min);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 4), partitions[1].max);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 4), partitions[2].min);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 6), partitions[2].max);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 6), partitions[3].min);
+    ASSERT_BSONOBJ_EQ(BSONObj(), partitions[3].max);
+}
+
+// Small collections and failed sampling both leave the collection to a single query.
+TEST_F(CollectionClonerTest, PartitionStageFallsBackToSingleQuery) {
+    _mockServer->setCommandReply("listIndexes",
+                                 createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+    _mockServer->setCommandReply("aggregate", Status(ErrorCodes::OperationFailed, ""));
+
+    auto cloner = makeCollectionCloner();
+    cloner->setPartitions_forTest(4);
+    cloner->setStopAfterStage_forTest("partition");
+    _mockServer->setCommandReply("count", createCountResponse(1000));
+    ASSERT_OK(cloner->run());
+    ASSERT(getPartitions(cloner.get()).empty());
+
+    cloner = makeCollectionCloner();
+    cloner->setPartitions_forTest(4);
+    cloner->setStopAfterStage_forTest("partition");
+    _mockServer->setCommandReply("count", createCountResponse(1000 * 1000));
+    ASSERT_OK(cloner->run());
+    ASSERT(getPartitions(cloner.get()).empty());
+}
+
+TEST_F(CollectionClonerTest, QueryStageQueriesPartitionsConcurrently) {
+    auto cloner = makePartitionedCollectionCloner();
+    for (int i = 0; i < 2; ++i) {
+        _mockServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+    for (int i = 2; i < 5; ++i) {
+        _partitionServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+
+    // The second partition is queried on a connection of its own, from a thread of its own.
+    std::vector<stdx::thread::id> clientThreads;
+    cloner->setCreateClientFn_forTest([&] {
+        clientThreads.push_back(stdx::this_thread::get_id());
+        return std::make_unique<MockDBClientConnection>(_partitionServer.get());
+    });
+    ASSERT_OK(cloner->run());
+
+    ASSERT_EQ(1U, clientThreads.size());
+    ASSERT(clientThreads[0] != stdx::this_thread::get_id());
+    ASSERT_EQ(1U, _partitionServer->getQueryCount());
+
+    ASSERT_EQUALS(5, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    ASSERT_EQUALS(5u, cloner->getStats().documentsCopied);
+    auto& partitions = getPartitions(cloner.get());
+    ASSERT_EQ(2U, partitions.size());
+    ASSERT_TRUE(partitions[0].done);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 1), partitions[0].lastId);
+    ASSERT_TRUE(partitions[1].done);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 4), partitions[1].lastId);
+}
+
+// A partition which fails before copying anything is retried, but finished partitions are not.
+TEST_F(CollectionClonerTest, QueryStageRetriesOnlyTheFailedPartition) {
+    auto cloner = makePartitionedCollectionCloner();
+    for (int i = 0; i < 2; ++i) {
+        _mockServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+    for (int i = 2; i < 5; ++i) {
+        _partitionServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+
+    // The second partition cannot connect until the query stage is retried.
+    _partitionServer->shutdown();
+    int clientsCreated = 0;
+    cloner->setCreateClientFn_forTest([&] {
+        if (clientsCreated++ == 1) {
+            _partitionServer->reboot();
+        }
+        return std::make_unique<MockDBClientConnection>(_partitionServer.get());
+    });
+    ASSERT_OK(cloner->run());
+
+    ASSERT_EQ(2, clientsCreated);
+    ASSERT_EQ(1U, _partitionServer->getQueryCount());
+    // Querying the first partition again would insert its documents twice.
+    ASSERT_EQUALS(5, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    ASSERT_EQUALS(5u, cloner->getStats().documentsCopied);
+}
+
+// A partition which fails after copying some documents resumes after the last one copied.
+TEST_F(CollectionClonerTest, QueryStageResumesFailedPartitionAfterLastId) {
+    auto cloner = makePartitionedCollectionCloner();
+    cloner->setBatchSize_forTest(2);
+    for (int i = 0; i < 2; ++i) {
+        _mockServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+    for (int i = 2; i < 7; ++i) {
+        _partitionServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+
+    int clientsCreated = 0;
+    cloner->setCreateClientFn_forTest([&]() -> std::unique_ptr<DBClientConnection> {
+        if (clientsCreated++ == 0) {
+            // Copies {_id: 2} and {_id: 3}, then fails.
+            return std::make_unique<FailAfterFirstBatchConnection>(_partitionServer.get());
+        }
+        // The resumed query starts at {_id: 3}, the last document copied, since $min is
+        // inclusive.
+        _partitionServer->remove(_nss.ns(), Query());
+        for (int i = 3; i < 7; ++i) {
+            _partitionServer->insert(_nss.ns(), BSON("_id" << i));
+        }
+        return std::make_unique<MockDBClientConnection>(_partitionServer.get());
+    });
+    ASSERT_OK(cloner->run());
+
+    ASSERT_EQ(2, clientsCreated);
+    // Inserting {_id: 3} again would make this 8.
+    ASSERT_EQUALS(7, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    ASSERT_EQUALS(7u, cloner->getStats().documentsCopied);
+    auto& partitions = getPartitions(cloner.get());
+    ASSERT_EQ(2U, partitions.size());
+    ASSERT_TRUE(partitions[1].done);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 6), partitions[1].lastId);
+}
+
+// The first document of a resumed query is only skipped if it is the last document copied.
+TEST_F(CollectionClonerTest, QueryStageResumedPartitionKeepsFirstDocumentAfterLastId) {
+    auto cloner = makePartitionedCollectionCloner();
+    cloner->setBatchSize_forTest(2);
+    for (int i = 0; i < 2; ++i) {
+        _mockServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+    for (int i = 2; i < 7; ++i) {
+        _partitionServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+
+    int clientsCreated = 0;
+    cloner->setCreateClientFn_forTest([&]() -> std::unique_ptr<DBClientConnection> {
+        if (clientsCreated++ == 0) {
+            return std::make_unique<FailAfterFirstBatchConnection>(_partitionServer.get());
+        }
+        // {_id: 3} was deleted on the source before the query was resumed.
+        _partitionServer->remove(_nss.ns(), Query());
+        for (int i = 4; i < 7; ++i) {
+            _partitionServer->insert(_nss.ns(), BSON("_id" << i));
+        }
+        return std::make_unique<MockDBClientConnection>(_partitionServer.get());
+    });
+    ASSERT_OK(cloner->run());
+
+    ASSERT_EQ(2, clientsCreated);
+    ASSERT_EQUALS(7, _collectionStats->insertCount);
+    ASSERT_EQUALS(7u, cloner->getStats().documentsCopied);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 6), getPartitions(cloner.get())[1].lastId);
+}
+
+// The connections partitions are queried on are shut down when initial sync is canceled.
+TEST_F(CollectionClonerTest, QueryStageShutsDownPartitionConnectionsOnCancel) {
+    auto cloner = makePartitionedCollectionCloner();
+    for (int i = 0; i < 2; ++i) {
+        _mockServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+    for (int i = 2; i < 5; ++i) {
+        _partitionServer->insert(_nss.ns(), BSON("_id" << i));
+    }
+
+    cloner->setCreateClientFn_forTest([&] {
+        // Cancel initial sync before the second partition starts its query.
+        stdx::lock_guard<InitialSyncSharedData> lk(*_sharedData);
+        _sharedData->setInitialSyncStatusIfOK(
+            lk, Status(ErrorCodes::CallbackCanceled, "Initial sync was canceled"));
+        return std::make_unique<MockDBClientConnection>(_partitionServer.get());
+    });
+    ASSERT_NOT_OK(cloner->run());
+
+    ASSERT_EQ(0U, _partitionServer->getQueryCount());
+    ASSERT_FALSE(getPartitions(cloner.get())[1].done);
+    ASSERT_TRUE(getPartitions(cloner.get())[1].lastId.isEmpty());
+}
+
 TEST_F(CollectionClonerTest, InsertDocumentsSingleBatch) {
     // Set up data for preliminary stages
     _mockServer->setCommandReply("count", createCountResponse(2));
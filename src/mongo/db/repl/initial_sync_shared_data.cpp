@@ -33,6 +33,29 @@
 
 namespace mongo {
 namespace repl {
+void InitialSyncSharedData::setInitialSyncStatus(WithLock lk, Status newStatus) {
+    const bool failed = _initialSyncStatus.isOK() && !newStatus.isOK();
+    _initialSyncStatus = std::move(newStatus);
+    if (failed) {
+        for (auto&& [handle, onFailure] : _onFailure) {
+            onFailure();
+        }
+    }
+}
+
+int InitialSyncSharedData::registerOnFailure(WithLock lk, std::function<void()> onFailure) {
+    if (!_initialSyncStatus.isOK()) {
+        onFailure();
+    }
+    const int handle = _nextOnFailureHandle++;
+    _onFailure.emplace(handle, std::move(onFailure));
+    return handle;
+}
+
+void InitialSyncSharedData::unregisterOnFailure(WithLock lk, int handle) {
+    invariant(_onFailure.erase(handle) == 1);
+}
+
 int InitialSyncSharedData::incrementRetryingOperations(WithLock lk) {
     if (_retryingOperationsCount++ == 0) {
         _syncSourceUnreachableSince = _clock->now();
@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <functional>
+#include <map>
 #include <mutex>
 
 #include "mongo/base/status.h"
@@ -75,18 +77,27 @@ public:
         return _initialSyncStatus;
     }
 
-    void setInitialSyncStatus(WithLock lk, Status newStatus) {
-        _initialSyncStatus = newStatus;
-    }
+    void setInitialSyncStatus(WithLock lk, Status newStatus);
 
     /**
      * Sets the initialSyncStatus to the new status if and only if the old status is "OK".
      */
     void setInitialSyncStatusIfOK(WithLock lk, Status newStatus) {
         if (_initialSyncStatus.isOK())
-            _initialSyncStatus = newStatus;
+            setInitialSyncStatus(lk, std::move(newStatus));
     }
 
+    /**
+     * Registers 'onFailure' to run, with the lock held, when the initialSyncStatus becomes an
+     * error. This lets tasks which block outside of the InitialSyncer's control, such as queries
+     * on connections a cloner opens itself, be interrupted when initial sync fails or is canceled.
+     * Runs 'onFailure' right away if the initialSyncStatus is already an error. Returns a handle
+     * for unregisterOnFailure().
+     */
+    int registerOnFailure(WithLock lk, std::function<void()> onFailure);
+
+    void unregisterOnFailure(WithLock lk, int handle);
+
     int getRetryingOperationsCount(WithLock lk) {
         return _retryingOperationsCount;
     }
@@ -220,6 +231,11 @@ private:
     // non-OK.
     Status _initialSyncStatus = Status::OK();
 
+    // Functions to run when _initialSyncStatus becomes non-OK, by the handle they were registered
+    // with.
+    std::map<int, std::function<void()>> _onFailure;
+    int _nextOnFailureHandle = 0;
+
     // Number of operations currently being retried due to a transient error.
     int _retryingOperationsCount = 0;
 
@@ -247,5 +247,40 @@ TEST(InitialSyncSharedDataTest, OperationTimesOut) {
     ASSERT_EQ(Milliseconds::min(), data.getCurrentOutageDuration(lk));
 }
 
+TEST(InitialSyncSharedDataTest, OnFailureRunsWhenStatusBecomesAnError) {
+    Days timeout(1);
+    ClockSourceMock clock;
+    InitialSyncSharedData data(
+        ServerGlobalParams::FeatureCompatibility::Version::kFullyUpgradedTo44,
+        1 /* rollBackId */,
+        timeout,
+        &clock);
+
+    stdx::unique_lock<InitialSyncSharedData> lk(data);
+    int firstCalls = 0;
+    int secondCalls = 0;
+    auto first = data.registerOnFailure(lk, [&] { ++firstCalls; });
+    auto second = data.registerOnFailure(lk, [&] { ++secondCalls; });
+    ASSERT_EQ(0, firstCalls);
+    ASSERT_EQ(0, secondCalls);
+
+    // Unregistered functions are not run.
+    data.unregisterOnFailure(lk, second);
+    data.setInitialSyncStatusIfOK(lk, Status(ErrorCodes::CallbackCanceled, "canceled"));
+    ASSERT_EQ(1, firstCalls);
+    ASSERT_EQ(0, secondCalls);
+
+    // Functions only run when the status first becomes an error.
+    data.setInitialSyncStatus(lk, Status(ErrorCodes::InternalError, "failed"));
+    ASSERT_EQ(1, firstCalls);
+
+    // Functions registered after the failure run right away.
+    int lateCalls = 0;
+    auto late = data.registerOnFailure(lk, [&] { ++lateCalls; });
+    ASSERT_EQ(1, lateCalls);
+    data.unregisterOnFailure(lk, first);
+    data.unregisterOnFailure(lk, late);
+}
+
 }  // namespace repl
 }  // namespace mongo
@@ -116,6 +116,11 @@ void OplogApplier::enqueue(OperationContext* opCtx,
                     "oplog buffer has {oplogBuffer_getSize} bytes",
                     "oplogBuffer_getSize"_attr = _oplogBuffer->getSize());
     }
+    // Parse on the producer's thread, off the batcher's. Only the in-memory buffer used by
+    // secondaries hands back the documents pushed into it, which parsed entries are matched by.
+    if (_options.mode == OplogApplication::Mode::kSecondary && replParseOplogEntriesAhead.load()) {
+        _oplogBatcher->parseAhead(begin, end);
+    }
     _oplogBuffer->push(opCtx, begin, end);
 }
 
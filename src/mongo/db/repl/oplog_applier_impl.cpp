@@ -43,6 +43,7 @@
 #include "mongo/db/logical_session_id.h"
 #include "mongo/db/repl/apply_ops.h"
 #include "mongo/db/repl/insert_group.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/transaction_oplog_application.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/logv2/log.h"
@@ -229,27 +230,13 @@ void processCrudOp(OperationContext* opCtx,
 }
 
 /**
- * Adds a single oplog entry to the appropriate writer vector.
- */
-void addToWriterVector(OplogEntry* op,
-                       std::vector<std::vector<const OplogEntry*>>* writerVectors,
-                       uint32_t hash) {
-    const uint32_t numWriters = writerVectors->size();
-    auto& writer = (*writerVectors)[hash % numWriters];
-    if (writer.empty()) {
-        writer.reserve(8);  // Skip a few growth rounds
-    }
-    writer.push_back(op);
-}
-
-/**
- * Adds a set of derivedOps to writerVectors.
+ * Adds a set of derivedOps to the writer vectors.
  * If `serial` is true, assign all derived operations to the writer vector corresponding to the hash
  * of the first operation in `derivedOps`.
  */
 void addDerivedOps(OperationContext* opCtx,
                    std::vector<OplogEntry>* derivedOps,
-                   std::vector<std::vector<const OplogEntry*>>* writerVectors,
+                   WriterVectorAssigner* writers,
                    CachedCollectionProperties* collPropertiesCache,
                    bool serial) {
 
@@ -268,9 +255,9 @@ void addDerivedOps(OperationContext* opCtx,
         if (serial) {
             // Serial derived ops go to the writer vector corresponding to the first op of
             // derivedOps.
-            addToWriterVector(&op, writerVectors, serialWriterId.get());
+            writers->add(&op, serialWriterId.get());
         } else {
-            addToWriterVector(&op, writerVectors, hash);
+            writers->add(&op, hash);
         }
     }
 }
@@ -280,7 +267,7 @@ void _addOplogChainOpsToWriterVectors(OperationContext* opCtx,
                                       std::vector<std::vector<OplogEntry>>* derivedOps,
                                       OplogEntry* op,
                                       CachedCollectionProperties* collPropertiesCache,
-                                      std::vector<std::vector<const OplogEntry*>>* writerVectors) {
+                                      WriterVectorAssigner* writers) {
     std::vector<OplogEntry> txnOps;
     bool shouldSerialize = false;
     std::tie(txnOps, shouldSerialize) =
@@ -289,7 +276,7 @@ void _addOplogChainOpsToWriterVectors(OperationContext* opCtx,
     partialTxnList->clear();
 
     // Transaction entries cannot have different session updates.
-    addDerivedOps(opCtx, &derivedOps->back(), writerVectors, collPropertiesCache, shouldSerialize);
+    addDerivedOps(opCtx, &derivedOps->back(), writers, collPropertiesCache, shouldSerialize);
 }
 
 void stableSortByNamespace(std::vector<const OplogEntry*>* oplogEntryPointers) {
@@ -440,6 +427,9 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
             ? new ApplyBatchFinalizerForJournal(_replCoord)
             : new ApplyBatchFinalizer(_replCoord)};
 
+    // The next batch, if it was taken from the batcher while the previous one was being applied.
+    boost::optional<PipelinedBatch> nextBatch;
+
     while (true) {  // Exits on message from OplogBatcher.
         // Use a new operation context each iteration, as otherwise we may appear to use a single
         // collection name to refer to collections with different UUIDs.
@@ -464,7 +454,12 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
 
         // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
         // ready in time, we'll loop again so we can do the above checks periodically.
-        OplogBatch ops = _oplogBatcher->getNextBatch(Seconds(1));
+        boost::optional<PipelinedBatch> currentBatch = std::move(nextBatch);
+        nextBatch = boost::none;
+        if (!currentBatch) {
+            currentBatch.emplace(_oplogBatcher->getNextBatch(Seconds(1)));
+        }
+        OplogBatch& ops = currentBatch->batch;
         if (ops.empty()) {
             if (ops.mustShutdown()) {
                 // Shut down and exit oplog application loop.
@@ -506,7 +501,8 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
 
         // Apply the operations in this batch. '_applyOplogBatch' returns the optime of the
         // last op that was applied, which should be the last optime in the batch.
-        auto swLastOpTimeAppliedInBatch = _applyOplogBatch(&opCtx, ops.releaseBatch());
+        auto swLastOpTimeAppliedInBatch =
+            _applyPipelinedOplogBatch(&opCtx, ops.releaseBatch(), &*currentBatch, &nextBatch);
         if (swLastOpTimeAppliedInBatch.getStatus().code() == ErrorCodes::InterruptedAtShutdown) {
             // If an operation was interrupted at shutdown, fail the batch without advancing
             // appliedThrough as if this were an unclean shutdown. This ensures the stable timestamp
@@ -618,8 +614,80 @@ void scheduleWritesToOplog(OperationContext* opCtx,
     }
 }
 
+WriterVectorAssigner::WriterVectorAssigner(
+    std::vector<std::vector<const OplogEntry*>>* writerVectors)
+    : _writerVectors(writerVectors) {
+    invariant(!_writerVectors->empty());
+}
+
+size_t WriterVectorAssigner::add(const OplogEntry* op, uint32_t conflictHash) {
+    auto [it, isNew] = _writerByHash.emplace(conflictHash, 0);
+    if (isNew) {
+        auto leastLoaded = std::min_element(
+            _writerVectors->begin(), _writerVectors->end(), [](const auto& a, const auto& b) {
+                return a.size() < b.size();
+            });
+        it->second = std::distance(_writerVectors->begin(), leastLoaded);
+    }
+
+    auto& writer = (*_writerVectors)[it->second];
+    if (writer.empty()) {
+        writer.reserve(8);  // Skip a few growth rounds
+    }
+    writer.push_back(op);
+    return it->second;
+}
+
 StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                                                       std::vector<OplogEntry> ops) {
+    return _applyPipelinedOplogBatch(opCtx, std::move(ops), nullptr, nullptr);
+}
+
+OplogBatch OplogApplierImpl::takeNextBatchWhileApplying() {
+    return _oplogBatcher->getNextBatch(Seconds(0));
+}
+
+void OplogApplierImpl::_prepareNextBatch(OperationContext* opCtx,
+                                         const std::vector<OplogEntry>& ops,
+                                         boost::optional<PipelinedBatch>* next) {
+    auto isCommand = [](const OplogEntry& op) { return op.isCommand(); };
+
+    // Commands, including applyOps and transaction entries, may change the catalog or need earlier
+    // entries in the oplog, so the batches on either side of one are only prepared in order.
+    if (!replPipelineOplogBatches.load() || MONGO_unlikely(rsSyncApplyStop.shouldFail()) ||
+        std::any_of(ops.begin(), ops.end(), isCommand)) {
+        return;
+    }
+
+    OplogBatch batch = takeNextBatchWhileApplying();
+    if (batch.empty() && !batch.mustShutdown() && !batch.termWhenExhausted()) {
+        return;
+    }
+    next->emplace(std::move(batch));
+
+    auto& nextOps = (*next)->batch.getBatch();
+    if (nextOps.empty() || nextOps.front().getOpTime() <= ops.back().getOpTime() ||
+        std::any_of(nextOps.begin(), nextOps.end(), isCommand)) {
+        return;
+    }
+
+    // If we crash before this batch has been applied, the next batch's oplog entries will be
+    // truncated on startup, and this batch is recovered as if the next one had never been fetched.
+    if (!getOptions().skipWritesToOplog) {
+        _consistencyMarkers->setOplogTruncateAfterPoint(opCtx, ops.back().getTimestamp());
+        scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, nextOps);
+    }
+
+    (*next)->writerVectors.resize(_writerPool->getStats().numThreads);
+    fillWriterVectors(opCtx, &nextOps, &(*next)->writerVectors, &(*next)->derivedOps);
+    (*next)->prepared = true;
+}
+
+StatusWith<OpTime> OplogApplierImpl::_applyPipelinedOplogBatch(
+    OperationContext* opCtx,
+    std::vector<OplogEntry> ops,
+    PipelinedBatch* current,
+    boost::optional<PipelinedBatch>* next) {
     invariant(!ops.empty());
 
     LOGV2_DEBUG(21230, 2, "replication batch size is {ops_size}", "ops_size"_attr = ops.size());
@@ -647,13 +715,6 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
         // because the spawned threads refer to objects on the stack
         ON_BLOCK_EXIT([&] { _writerPool->waitForIdle(); });
 
-        // Write batch of ops into oplog.
-        if (!getOptions().skipWritesToOplog) {
-            _consistencyMarkers->setOplogTruncateAfterPoint(
-                opCtx, _replCoord->getMyLastAppliedOpTime().getTimestamp());
-            scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, ops);
-        }
-
         // Holds 'pseudo operations' generated by secondaries to aid in replication.
         // Keep in scope until all operations in 'ops' and 'derivedOps' have been applied.
         // Pseudo operations include:
@@ -665,7 +726,21 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 
         std::vector<std::vector<const OplogEntry*>> writerVectors(
             _writerPool->getStats().numThreads);
-        fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
+
+        if (current && current->prepared) {
+            // The oplog writes were already done while the previous batch was being applied.
+            derivedOps = std::move(current->derivedOps);
+            writerVectors = std::move(current->writerVectors);
+        } else {
+            // Write batch of ops into oplog.
+            if (!getOptions().skipWritesToOplog) {
+                _consistencyMarkers->setOplogTruncateAfterPoint(
+                    opCtx, _replCoord->getMyLastAppliedOpTime().getTimestamp());
+                scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, ops);
+            }
+
+            fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
+        }
 
         // Wait for writes to finish before applying ops.
         _writerPool->waitForIdle();
@@ -714,6 +789,12 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                     });
             }
 
+            // Rather than idly waiting on the slowest writer, get the next batch ready. Writers
+            // that finish early pick up its oplog writes.
+            if (next) {
+                _prepareNextBatch(opCtx, ops, next);
+            }
+
             _writerPool->waitForIdle();
 
             // If any of the statuses is not ok, return error.
@@ -787,7 +868,7 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 /**
  * ops - This only modifies the isForCappedCollection field on each op. It does not alter the ops
  *      vector in any other way.
- * writerVectors - Set of operations for each worker thread to apply.
+ * writers - Assigns operations to the set of operations for each worker thread to apply.
  * derivedOps - If provided, this function inserts a decomposition of applyOps operations
  *      and instructions for updating the transactions table.  Required if processing oplogs
  *      with transactions.
@@ -796,7 +877,7 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
 void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
     OperationContext* opCtx,
     std::vector<OplogEntry>* ops,
-    std::vector<std::vector<const OplogEntry*>>* writerVectors,
+    WriterVectorAssigner* writers,
     std::vector<std::vector<OplogEntry>>* derivedOps,
     SessionUpdateTracker* sessionUpdateTracker) noexcept {
 
@@ -811,8 +892,8 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
 
         auto hashedNs = StringMapHasher().hashed_key(op.getNss().ns());
         // Reduce the hash from 64bit down to 32bit, just to allow combinations with murmur3 later
-        // on. Bit depth not important, we end up just doing integer modulo with this in the end.
-        // The hash function should provide entropy in the lower bits as it's used in hash tables.
+        // on. Bit depth not important, we end up just using this to tell apart the documents or
+        // collections that ops conflict on.
         uint32_t hash = static_cast<uint32_t>(hashedNs.hash());
 
         // We need to track all types of ops, including type 'n' (these are generated from chunk
@@ -822,7 +903,7 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
                 derivedOps->emplace_back(std::move(*newOplogWrites));
                 addDerivedOps(opCtx,
                               &derivedOps->back(),
-                              writerVectors,
+                              writers,
                               &collPropertiesCache,
                               false /*serial*/);
             }
@@ -863,7 +944,7 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
                 // Flush partialTxnList operations for current transaction.
                 auto& partialTxnList = partialTxnOps[*logicalSessionId];
                 _addOplogChainOpsToWriterVectors(
-                    opCtx, &partialTxnList, derivedOps, &op, &collPropertiesCache, writerVectors);
+                    opCtx, &partialTxnList, derivedOps, &op, &collPropertiesCache, writers);
             } else {
                 // The applyOps entry was not generated as part of a transaction.
                 invariant(!op.getPrevWriteOpTimeInTransaction());
@@ -873,7 +954,7 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
                 // Nested entries cannot have different session updates.
                 addDerivedOps(opCtx,
                               &derivedOps->back(),
-                              writerVectors,
+                              writers,
                               &collPropertiesCache,
                               false /*serial*/);
             }
@@ -887,11 +968,11 @@ void OplogApplierImpl::_deriveOpsAndFillWriterVectors(
             auto logicalSessionId = op.getSessionId();
             auto& partialTxnList = partialTxnOps[*logicalSessionId];
             _addOplogChainOpsToWriterVectors(
-                opCtx, &partialTxnList, derivedOps, &op, &collPropertiesCache, writerVectors);
+                opCtx, &partialTxnList, derivedOps, &op, &collPropertiesCache, writers);
             continue;
         }
 
-        addToWriterVector(&op, writerVectors, hash);
+        writers->add(&op, hash);
     }
 }
 
@@ -901,14 +982,14 @@ void OplogApplierImpl::fillWriterVectors(
     std::vector<std::vector<const OplogEntry*>>* writerVectors,
     std::vector<std::vector<OplogEntry>>* derivedOps) noexcept {
 
+    WriterVectorAssigner writers(writerVectors);
     SessionUpdateTracker sessionUpdateTracker;
-    _deriveOpsAndFillWriterVectors(opCtx, ops, writerVectors, derivedOps, &sessionUpdateTracker);
+    _deriveOpsAndFillWriterVectors(opCtx, ops, &writers, derivedOps, &sessionUpdateTracker);
 
     auto newOplogWrites = sessionUpdateTracker.flushAll();
     if (!newOplogWrites.empty()) {
         derivedOps->emplace_back(std::move(newOplogWrites));
-        _deriveOpsAndFillWriterVectors(
-            opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+        _deriveOpsAndFillWriterVectors(opCtx, &derivedOps->back(), &writers, derivedOps, nullptr);
     }
 }
 
@@ -40,10 +40,32 @@
 #include "mongo/db/repl/replication_metrics.h"
 #include "mongo/db/repl/session_update_tracker.h"
 #include "mongo/db/repl/storage_interface.h"
+#include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
 namespace repl {
 
+/**
+ * Distributes the oplog entries of a batch over the writer vectors. Entries with the same conflict
+ * hash, which identifies the document they write to (or the collection, when its entries must be
+ * applied in order), always go to the same writer vector so that they are applied in order. The
+ * first entry with a given conflict hash goes to the writer vector with the fewest entries, so a
+ * hot document or an unlucky hash does not leave one writer with most of the batch.
+ */
+class WriterVectorAssigner {
+public:
+    explicit WriterVectorAssigner(std::vector<std::vector<const OplogEntry*>>* writerVectors);
+
+    /**
+     * Adds 'op' to the writer vector for 'conflictHash' and returns that vector's index.
+     */
+    size_t add(const OplogEntry* op, uint32_t conflictHash);
+
+private:
+    std::vector<std::vector<const OplogEntry*>>* const _writerVectors;
+    stdx::unordered_map<uint32_t, size_t> _writerByHash;
+};
+
 /**
  * Applies oplog entries.
  * Primarily used to apply batches of operations fetched from a sync source during steady state
@@ -75,6 +97,43 @@ public:
                      ThreadPool* writerPool);
 
 
+protected:
+    // Marked as protected for use in unit tests.
+    /**
+     * A batch taken from the batcher while the previous batch was being applied.
+     */
+    struct PipelinedBatch {
+        explicit PipelinedBatch(OplogBatch batch) : batch(std::move(batch)) {}
+
+        OplogBatch batch;
+
+        // Set if the batch's entries were written to the oplog and its writer vectors filled while
+        // the previous batch was being applied. The writer vectors point into 'batch' and
+        // 'derivedOps', which must not be modified until the batch has been applied.
+        bool prepared = false;
+        std::vector<std::vector<OplogEntry>> derivedOps;
+        std::vector<std::vector<const OplogEntry*>> writerVectors;
+    };
+
+    /**
+     * Like _applyOplogBatch(), but skips writing the oplog entries and filling the writer vectors
+     * if 'current' was prepared while the previous batch was being applied. If 'next' is not null,
+     * it may take the following batch from the batcher while this one is applied, and prepare it
+     * when neither batch contains commands.
+     */
+    StatusWith<OpTime> _applyPipelinedOplogBatch(OperationContext* opCtx,
+                                                 std::vector<OplogEntry> ops,
+                                                 PipelinedBatch* current,
+                                                 boost::optional<PipelinedBatch>* next);
+
+    /**
+     * Takes the next batch from the batcher without waiting for one to become ready. Called while
+     * the previous batch is being applied.
+     *
+     * This function has been marked as virtual to allow unit tests to supply the next batch.
+     */
+    virtual OplogBatch takeNextBatchWhileApplying();
+
 private:
     /**
      * Runs oplog application in a loop until shutdown() is called.
@@ -98,9 +157,17 @@ private:
      */
     StatusWith<OpTime> _applyOplogBatch(OperationContext* opCtx, std::vector<OplogEntry> ops);
 
+    /**
+     * Takes the next batch from the batcher without waiting and, if it is safe to do so while
+     * 'ops' is being applied, writes its entries to the oplog and fills its writer vectors.
+     */
+    void _prepareNextBatch(OperationContext* opCtx,
+                           const std::vector<OplogEntry>& ops,
+                           boost::optional<PipelinedBatch>* next);
+
     void _deriveOpsAndFillWriterVectors(OperationContext* opCtx,
                                         std::vector<OplogEntry>* ops,
-                                        std::vector<std::vector<const OplogEntry*>>* writerVectors,
+                                        WriterVectorAssigner* writers,
                                         std::vector<std::vector<OplogEntry>>* derivedOps,
                                         SessionUpdateTracker* sessionUpdateTracker) noexcept;
 
@@ -30,7 +30,9 @@
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
+#include <deque>
 #include <memory>
+#include <set>
 #include <utility>
 #include <vector>
 
@@ -56,6 +58,7 @@
 #include "mongo/db/repl/idempotency_test_fixture.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/oplog_applier.h"
+#include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/repl/replication_process.h"
 #include "mongo/db/repl/storage_interface.h"
@@ -313,6 +316,41 @@ Status TrackOpsAppliedApplier::applyOplogBatchPerWorker(
     return Status::OK();
 }
 
+TEST(WriterVectorAssignerTest, KeepsConflictingOpsTogetherAndBalancesTheRest) {
+    NamespaceString nss("test.t");
+    std::vector<OplogEntry> ops;
+    for (int i = 0; i < 12; ++i) {
+        ops.push_back(makeOplogEntry(OpTypeEnum::kInsert, nss, {}));
+    }
+
+    std::vector<std::vector<const OplogEntry*>> writerVectors(4);
+    WriterVectorAssigner writers(&writerVectors);
+
+    // All ops on a hot document go to one writer, in order.
+    const uint32_t hotHash = 7;
+    auto hotWriter = writers.add(&ops[0], hotHash);
+    for (int i = 1; i < 6; ++i) {
+        ASSERT_EQ(writers.add(&ops[i], hotHash), hotWriter);
+    }
+
+    // Other documents go to the other writers, even when their hashes are congruent to the hot
+    // document's modulo the number of writers.
+    for (int i = 6; i < 12; ++i) {
+        ASSERT_NE(writers.add(&ops[i], hotHash + 4 * i), hotWriter);
+    }
+
+    for (size_t i = 0; i < writerVectors.size(); ++i) {
+        if (i == hotWriter) {
+            ASSERT_EQ(writerVectors[i].size(), 6U);
+            for (size_t j = 0; j < 6; ++j) {
+                ASSERT_EQ(writerVectors[i][j], &ops[j]);
+            }
+        } else {
+            ASSERT_EQ(writerVectors[i].size(), 2U);
+        }
+    }
+}
+
 DEATH_TEST_F(OplogApplierImplTest, MultiApplyAbortsWhenNoOperationsAreGiven, "!ops.empty()") {
     auto writerPool = makeReplWriterPool();
     NoopOplogApplierObserver observer;
@@ -398,6 +436,195 @@ TEST_F(OplogApplierImplTest,
     ASSERT_TRUE(AutoGetCollectionForReadCommand(_opCtx.get(), nss).getCollection());
 }
 
+/**
+ * Test only subclass of OplogApplierImpl that applies pipelined batches, taking each batch it
+ * prepares from a queue instead of the batcher. It does not apply oplog entries, but tracks them,
+ * and fails the batch containing the entry at 'failAt'.
+ */
+class PipelinedBatchApplier : public OplogApplierImpl {
+public:
+    using OplogApplierImpl::OplogApplierImpl;
+    using OplogApplierImpl::PipelinedBatch;
+    using OplogApplierImpl::_applyPipelinedOplogBatch;
+
+    OplogBatch takeNextBatchWhileApplying() override {
+        if (nextBatches.empty()) {
+            return OplogBatch(0);
+        }
+        auto batch = std::move(nextBatches.front());
+        nextBatches.pop_front();
+        return batch;
+    }
+
+    Status applyOplogBatchPerWorker(OperationContext* opCtx,
+                                    std::vector<const OplogEntry*>* ops,
+                                    WorkerMultikeyPathInfo* workerMultikeyPathInfo) override {
+        stdx::lock_guard<Latch> lk(_mutex);
+        for (auto&& opPtr : *ops) {
+            if (opPtr->getTimestamp() == failAt) {
+                return {ErrorCodes::OperationFailed, "failing oplog entry for test"};
+            }
+            timestampsApplied.insert(opPtr->getTimestamp());
+        }
+        return Status::OK();
+    }
+
+    std::deque<OplogBatch> nextBatches;
+    Timestamp failAt;
+    std::set<Timestamp> timestampsApplied;
+
+private:
+    Mutex _mutex = MONGO_MAKE_LATCH("PipelinedBatchApplier::_mutex");
+};
+
+class OplogApplierImplPipelinedBatchTest : public OplogApplierImplTest {
+protected:
+    using PipelinedBatch = PipelinedBatchApplier::PipelinedBatch;
+
+    void setUp() override {
+        OplogApplierImplTest::setUp();
+        replPipelineOplogBatches.store(true);
+        _writerPool = makeReplWriterPool();
+        _applier = std::make_unique<PipelinedBatchApplier>(
+            nullptr,  // executor
+            nullptr,  // oplogBuffer
+            &_observer,
+            ReplicationCoordinator::get(_opCtx.get()),
+            getConsistencyMarkers(),
+            getStorageInterface(),
+            OplogApplier::Options(OplogApplication::Mode::kSecondary),
+            _writerPool.get());
+    }
+
+    void tearDown() override {
+        _applier.reset();
+        _writerPool.reset();
+        replPipelineOplogBatches.store(false);
+        OplogApplierImplTest::tearDown();
+    }
+
+    OplogEntry makeInsert(int seconds) {
+        return makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(seconds), 0), 1LL}, _nss, BSON("_id" << seconds));
+    }
+
+    OplogBatch makeBatch(std::vector<OplogEntry> ops) {
+        OplogBatch batch(ops.size());
+        for (auto&& op : ops) {
+            batch.emplace_back(std::move(op));
+        }
+        return batch;
+    }
+
+    bool isInOplog(const OplogEntry& op) {
+        return docExists(_opCtx.get(),
+                         NamespaceString::kRsOplogNamespace,
+                         BSON("ts" << op.getTimestamp()));
+    }
+
+    Timestamp getTruncateAfterPoint() {
+        return getConsistencyMarkers()->getOplogTruncateAfterPoint(_opCtx.get());
+    }
+
+    const NamespaceString _nss{"test.t"};
+    NoopOplogApplierObserver _observer;
+    std::unique_ptr<ThreadPool> _writerPool;
+    std::unique_ptr<PipelinedBatchApplier> _applier;
+};
+
+TEST_F(OplogApplierImplPipelinedBatchTest, TruncateAfterPointCoversNextBatchUntilItIsApplied) {
+    auto first = makeBatch({makeInsert(1), makeInsert(2)});
+    _applier->nextBatches.push_back(makeBatch({makeInsert(3), makeInsert(4)}));
+
+    boost::optional<PipelinedBatch> next;
+    PipelinedBatch current(std::move(first));
+    ASSERT_EQ(Timestamp(Seconds(2), 0),
+              unittest::assertGet(_applier->_applyPipelinedOplogBatch(
+                                      _opCtx.get(), current.batch.releaseBatch(), &current, &next))
+                  .getTimestamp());
+
+    // The second batch was written to the oplog while the first was applied, so a crash now must
+    // truncate the oplog back to the end of the first batch.
+    ASSERT(next);
+    ASSERT_TRUE(next->prepared);
+    ASSERT_TRUE(isInOplog(next->batch.front()));
+    ASSERT_TRUE(isInOplog(next->batch.back()));
+    ASSERT_EQ(Timestamp(Seconds(2), 0), getTruncateAfterPoint());
+    ASSERT_EQ(2U, _applier->timestampsApplied.size());
+
+    // Applying the prepared batch clears the truncate-after point before its writers start.
+    boost::optional<PipelinedBatch> afterNext;
+    ASSERT_EQ(Timestamp(Seconds(4), 0),
+              unittest::assertGet(_applier->_applyPipelinedOplogBatch(
+                                      _opCtx.get(), next->batch.releaseBatch(), &*next, &afterNext))
+                  .getTimestamp());
+    ASSERT_FALSE(afterNext);
+    ASSERT_EQ(Timestamp(), getTruncateAfterPoint());
+    ASSERT_EQ(OpTime(Timestamp(Seconds(4), 0), 1LL),
+              getConsistencyMarkers()->getMinValid(_opCtx.get()));
+    ASSERT_EQ(4U, _applier->timestampsApplied.size());
+}
+
+TEST_F(OplogApplierImplPipelinedBatchTest, FailedBatchLeavesTruncateAfterPointBeforePreparedBatch) {
+    auto first = makeBatch({makeInsert(1), makeInsert(2)});
+    _applier->nextBatches.push_back(makeBatch({makeInsert(3), makeInsert(4)}));
+    _applier->failAt = Timestamp(Seconds(2), 0);
+
+    boost::optional<PipelinedBatch> next;
+    PipelinedBatch current(std::move(first));
+    ASSERT_EQ(ErrorCodes::OperationFailed,
+              _applier
+                  ->_applyPipelinedOplogBatch(
+                      _opCtx.get(), current.batch.releaseBatch(), &current, &next)
+                  .getStatus());
+
+    // The next batch was prepared while the failing one was applied, but none of it was applied,
+    // and recovery truncates its oplog entries.
+    ASSERT(next);
+    ASSERT_TRUE(next->prepared);
+    ASSERT_TRUE(isInOplog(next->batch.back()));
+    ASSERT_EQ(Timestamp(Seconds(2), 0), getTruncateAfterPoint());
+    ASSERT_EQ(0U, _applier->timestampsApplied.count(Timestamp(Seconds(3), 0)));
+    ASSERT_EQ(0U, _applier->timestampsApplied.count(Timestamp(Seconds(4), 0)));
+}
+
+TEST_F(OplogApplierImplPipelinedBatchTest, ShutdownBatchTakenWhileApplyingIsNotPrepared) {
+    auto first = makeBatch({makeInsert(1), makeInsert(2)});
+    OplogBatch shutdown(0);
+    shutdown.setMustShutdownFlag();
+    _applier->nextBatches.push_back(std::move(shutdown));
+
+    boost::optional<PipelinedBatch> next;
+    PipelinedBatch current(std::move(first));
+    ASSERT_OK(_applier
+                  ->_applyPipelinedOplogBatch(
+                      _opCtx.get(), current.batch.releaseBatch(), &current, &next)
+                  .getStatus());
+
+    // The shutdown signal is handed back to the caller without moving the truncate-after point.
+    ASSERT(next);
+    ASSERT_TRUE(next->batch.mustShutdown());
+    ASSERT_FALSE(next->prepared);
+    ASSERT_EQ(Timestamp(), getTruncateAfterPoint());
+    ASSERT_EQ(2U, _applier->timestampsApplied.size());
+}
+
+TEST_F(OplogApplierImplPipelinedBatchTest, NextBatchIsNotPreparedWhenKnobIsOff) {
+    replPipelineOplogBatches.store(false);
+    auto first = makeBatch({makeInsert(1), makeInsert(2)});
+    _applier->nextBatches.push_back(makeBatch({makeInsert(3), makeInsert(4)}));
+
+    boost::optional<PipelinedBatch> next;
+    PipelinedBatch current(std::move(first));
+    ASSERT_OK(_applier
+                  ->_applyPipelinedOplogBatch(
+                      _opCtx.get(), current.batch.releaseBatch(), &current, &next)
+                  .getStatus());
+    ASSERT_FALSE(next);
+    ASSERT_EQ(1U, _applier->nextBatches.size());
+    ASSERT_EQ(Timestamp(), getTruncateAfterPoint());
+}
+
 class MultiOplogEntryOplogApplierImplTest : public OplogApplierImplTest {
 public:
     MultiOplogEntryOplogApplierImplTest()
@@ -401,6 +401,60 @@ TEST_F(OplogApplierTest,
     ASSERT_EQUALS(srcOps[1], batch[0]);
 }
 
+TEST_F(OplogApplierTest, GetNextApplierBatchTakesEntriesParsedAhead) {
+    OplogBuffer::Batch docs;
+    for (int t = 1; t <= 3; ++t) {
+        docs.push_back(makeInsertOplogEntry(t, NamespaceString(dbName, "bar")).getRaw());
+    }
+    OplogBatcher batcher(_applier.get(), _buffer.get());
+    batcher.parseAhead(docs.cbegin(), docs.cend());
+    _buffer->push(_opCtx.get(), docs.cbegin(), docs.cend());
+
+    // The blocking queue hands back the documents pushed into it, so every parsed entry is used.
+    auto batch = unittest::assertGet(batcher.getNextApplierBatch(_opCtx.get(), _limits));
+    ASSERT_EQUALS(3U, batch.size()) << toString(batch);
+    ASSERT_EQUALS(3U, batcher.getNumParsedAheadTaken_forTest());
+    for (std::size_t i = 0; i < docs.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(docs[i], batch[i].getRaw());
+    }
+}
+
+TEST_F(OplogApplierTest, GetNextApplierBatchParsesDocumentsThatWereNotParsedAhead) {
+    OplogBuffer::Batch docs;
+    OplogBuffer::Batch copies;
+    for (int t = 1; t <= 3; ++t) {
+        docs.push_back(makeInsertOplogEntry(t, NamespaceString(dbName, "bar")).getRaw());
+        copies.push_back(docs.back().copy());
+    }
+    OplogBatcher batcher(_applier.get(), _buffer.get());
+    batcher.parseAhead(docs.cbegin(), docs.cend());
+    _buffer->push(_opCtx.get(), copies.cbegin(), copies.cend());
+
+    // Equal documents in other buffers do not match the entries parsed ahead.
+    auto batch = unittest::assertGet(batcher.getNextApplierBatch(_opCtx.get(), _limits));
+    ASSERT_EQUALS(3U, batch.size()) << toString(batch);
+    ASSERT_EQUALS(0U, batcher.getNumParsedAheadTaken_forTest());
+    for (std::size_t i = 0; i < docs.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(docs[i], batch[i].getRaw());
+    }
+}
+
+TEST_F(OplogApplierTest, GetNextApplierBatchIgnoresEntriesParsedBeforeBufferWasCleared) {
+    std::vector<OplogEntry> srcOps;
+    srcOps.push_back(makeInsertOplogEntry(1, NamespaceString(dbName, "bar")));
+    srcOps.push_back(makeInsertOplogEntry(2, NamespaceString(dbName, "bar")));
+    _applier->enqueue(_opCtx.get(), srcOps.cbegin(), srcOps.cend());
+    _buffer->clear(_opCtx.get());
+
+    srcOps.push_back(makeInsertOplogEntry(3, NamespaceString(dbName, "bar")));
+    _applier->enqueue(_opCtx.get(), srcOps.cend() - 1, srcOps.cend());
+
+    // Only batch: [insert]
+    auto batch = unittest::assertGet(_applier->getNextApplierBatch(_opCtx.get(), _limits));
+    ASSERT_EQUALS(1U, batch.size()) << toString(batch);
+    ASSERT_EQUALS(srcOps[2], batch[0]);
+}
+
 }  // namespace
 }  // namespace repl
 }  // namespace mongo
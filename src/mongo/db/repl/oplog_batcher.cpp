@@ -167,7 +167,8 @@ StatusWith<std::vector<OplogEntry>> OplogBatcher::getNextApplierBatch(
     std::vector<OplogEntry> ops;
     BSONObj op;
     while (_oplogBuffer->peek(opCtx, &op)) {
-        auto entry = OplogEntry(op);
+        auto parsedEntry = _takeParsedEntry(op);
+        auto entry = parsedEntry ? std::move(*parsedEntry) : OplogEntry(op);
 
         // Check for oplog version change.
         if (entry.getVersion() != OplogEntry::kOplogVersion) {
@@ -226,6 +227,66 @@ StatusWith<std::vector<OplogEntry>> OplogBatcher::getNextApplierBatch(
     return std::move(ops);
 }
 
+void OplogBatcher::parseAhead(OplogBuffer::Batch::const_iterator begin,
+                              OplogBuffer::Batch::const_iterator end) {
+    // Bound the number of parsed entries held if the batcher falls behind the producer. Documents
+    // past the limit are still queued, unparsed, so that the queue stays in step with the buffer.
+    const auto maxParsedAhead = 2 * getBatchLimitOplogEntries();
+    std::size_t numParsedAhead;
+    {
+        stdx::lock_guard<Latch> lk(_parsedAheadMutex);
+        numParsedAhead = _numParsedAhead;
+    }
+
+    std::vector<ParsedAhead> parsed;
+    parsed.reserve(std::distance(begin, end));
+    for (auto it = begin; it != end; ++it) {
+        ParsedAhead doc{*it, nullptr};
+        if (numParsedAhead < maxParsedAhead) {
+            auto swEntry = OplogEntry::parse(*it);
+            if (swEntry.isOK()) {
+                doc.entry = std::make_unique<OplogEntry>(std::move(swEntry.getValue()));
+                ++numParsedAhead;
+            }
+        }
+        parsed.push_back(std::move(doc));
+    }
+
+    stdx::lock_guard<Latch> lk(_parsedAheadMutex);
+    for (auto&& doc : parsed) {
+        if (doc.entry) {
+            ++_numParsedAhead;
+        }
+        _parsedAhead.push_back(std::move(doc));
+    }
+}
+
+std::size_t OplogBatcher::getNumParsedAheadTaken_forTest() const {
+    stdx::lock_guard<Latch> lk(_parsedAheadMutex);
+    return _numParsedAheadTaken;
+}
+
+std::unique_ptr<OplogEntry> OplogBatcher::_takeParsedEntry(const BSONObj& op) {
+    stdx::lock_guard<Latch> lk(_parsedAheadMutex);
+    // Documents are pushed and consumed in the same order, so anything ahead of 'op' was cleared
+    // from the buffer without being consumed.
+    while (!_parsedAhead.empty() && _parsedAhead.front().raw.objdata() != op.objdata()) {
+        if (_parsedAhead.front().entry) {
+            --_numParsedAhead;
+        }
+        _parsedAhead.pop_front();
+    }
+    if (_parsedAhead.empty() || !_parsedAhead.front().entry) {
+        return nullptr;
+    }
+
+    // The document stays queued until it is consumed. If it does not fit in this batch, the next
+    // one parses it again.
+    --_numParsedAhead;
+    ++_numParsedAheadTaken;
+    return std::move(_parsedAhead.front().entry);
+}
+
 /**
  * If slaveDelay is enabled, this function calculates the most recent timestamp of any oplog
  * entries that can be be returned in a batch.
@@ -250,6 +311,15 @@ void OplogBatcher::_consume(OperationContext* opCtx, OplogBuffer* oplogBuffer) {
     // successfully.
     BSONObj opToPopAndDiscard;
     invariant(oplogBuffer->tryPop(opCtx, &opToPopAndDiscard) || _oplogApplier->inShutdown());
+
+    stdx::lock_guard<Latch> lk(_parsedAheadMutex);
+    if (!_parsedAhead.empty() &&
+        _parsedAhead.front().raw.objdata() == opToPopAndDiscard.objdata()) {
+        if (_parsedAhead.front().entry) {
+            --_numParsedAhead;
+        }
+        _parsedAhead.pop_front();
+    }
 }
 
 void OplogBatcher::_run(StorageInterface* storageInterface) {
@@ -283,8 +353,8 @@ void OplogBatcher::_run(StorageInterface* storageInterface) {
 
             auto oplogEntries =
                 fassertNoTrace(31004, getNextApplierBatch(opCtx.get(), batchLimits));
-            for (const auto& oplogEntry : oplogEntries) {
-                ops.emplace_back(oplogEntry);
+            for (auto&& oplogEntry : oplogEntries) {
+                ops.emplace_back(std::move(oplogEntry));
             }
 
             // If we don't have anything in the batch, wait a bit for something to appear.
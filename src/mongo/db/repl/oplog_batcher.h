@@ -29,6 +29,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "mongo/db/repl/oplog_buffer.h"
 #include "mongo/db/repl/oplog_entry.h"
 #include "mongo/db/repl/storage_interface.h"
@@ -63,6 +65,9 @@ public:
     const std::vector<OplogEntry>& getBatch() const {
         return _batch;
     }
+    std::vector<OplogEntry>& getBatch() {
+        return _batch;
+    }
 
     void emplace_back(OplogEntry oplog) {
         invariant(!_mustShutdown);
@@ -173,7 +178,38 @@ public:
     StatusWith<std::vector<OplogEntry>> getNextApplierBatch(OperationContext* opCtx,
                                                             const BatchLimits& batchLimits);
 
+    /**
+     * Parses documents that the producer is about to push into the OplogBuffer, so that
+     * getNextApplierBatch() can take the parsed entries instead of parsing them on the batcher
+     * thread. Must be called before the same documents are pushed. Documents that fail to parse
+     * are left for getNextApplierBatch() to report.
+     */
+    void parseAhead(OplogBuffer::Batch::const_iterator begin,
+                    OplogBuffer::Batch::const_iterator end);
+
+    /**
+     * Returns how many entries parsed by parseAhead() getNextApplierBatch() has used.
+     *
+     * Used for testing only.
+     */
+    std::size_t getNumParsedAheadTaken_forTest() const;
+
 private:
+    /**
+     * A document passed to parseAhead(), with its parsed entry unless too many were outstanding.
+     * Documents past the limit only cost the reference to the BSON buffer the OplogBuffer holds.
+     */
+    struct ParsedAhead {
+        BSONObj raw;
+        std::unique_ptr<OplogEntry> entry;
+    };
+
+    /**
+     * Returns the entry parsed ahead for 'op', the document at the front of the OplogBuffer, if
+     * there is one. Discards entries for documents that were cleared from the buffer.
+     */
+    std::unique_ptr<OplogEntry> _takeParsedEntry(const BSONObj& op);
+
     /**
      * If slaveDelay is enabled, this function calculates the most recent timestamp of any oplog
      * entries that can be be returned in a batch.
@@ -199,6 +235,18 @@ private:
     OplogBatch _ops;
 
     std::unique_ptr<stdx::thread> _thread;
+
+    mutable Mutex _parsedAheadMutex = MONGO_MAKE_LATCH("OplogBatcher::_parsedAheadMutex");
+
+    // Documents passed to parseAhead() and not yet consumed from the OplogBuffer, in push order.
+    // Entries are matched to the buffer by the identity of their documents' BSON buffers.
+    std::deque<ParsedAhead> _parsedAhead;
+
+    // The number of elements of '_parsedAhead' holding a parsed entry.
+    std::size_t _numParsedAhead = 0;
+
+    // The number of parsed entries getNextApplierBatch() has taken from '_parsedAhead'.
+    std::size_t _numParsedAheadTaken = 0;
 };
 
 /**
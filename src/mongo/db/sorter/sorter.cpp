@@ -49,8 +49,8 @@
 #include "mongo/db/sorter/sorter.h"
 
 #include <boost/filesystem/operations.hpp>
-#include <snappy.h>
 #include <vector>
+#include <zstd.h>
 
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
@@ -153,7 +153,7 @@ private:
 
 /**
  * Returns results from a sorted range within a file. Each instance is given a file name and start
- * and end offsets.
+ * and end offsets. See SortedFileWriter::spill() for the layout of the blocks in the range.
  *
  * This class is NOT responsible for file clean up / deletion. There are openSource() and
  * closeSource() functions to ensure the FileIterator is not holding the file open when the file is
@@ -209,7 +209,8 @@ public:
         // written to disk. Some iterators do not read back all data from the file, which prohibits
         // the _afterReadChecksum from obtaining all the information needed. Thus, we only fassert
         // if all data that was written to disk is read back and the checksums are not equivalent.
-        if (_done && _bufferReader->atEof() && (_originalChecksum != _afterReadChecksum)) {
+        if (_done && _keyReader && _keyReader->atEof() && _valueReader->atEof() &&
+            (_originalChecksum != _afterReadChecksum)) {
             fassert(31182,
                     Status(ErrorCodes::Error::ChecksumMismatch,
                            "Data read from disk does not match what was written to disk. Possible "
@@ -227,39 +228,46 @@ public:
         verify(!_done);
         fillBufferIfNeeded();
 
-        const char* startOfNewData = static_cast<const char*>(_bufferReader->pos());
-
-        // Note: calling read() on the _bufferReader buffer in the deserialize function advances the
-        // buffer. Since Key comes before Value in the _bufferReader, and C++ makes no function
-        // parameter evaluation order guarantees, we cannot deserialize Key and Value straight into
-        // the Data constructor
-        auto first = Key::deserializeForSorter(*_bufferReader, _settings.first);
-        auto second = Value::deserializeForSorter(*_bufferReader, _settings.second);
-
-        // The difference of _bufferReader's position before and after reading the data
-        // will provide the length of the data that was just read.
-        const char* endOfNewData = static_cast<const char*>(_bufferReader->pos());
+        // Keys and values live in separate columns of the block, so each is deserialized from its
+        // own reader. The difference of a reader's position before and after deserializing
+        // provides the length of the data that was just read, which feeds the checksum in the same
+        // order SortedFileWriter computed it.
+        const char* startOfKey = static_cast<const char*>(_keyReader->pos());
+        auto first = Key::deserializeForSorter(*_keyReader, _settings.first);
+        const char* endOfKey = static_cast<const char*>(_keyReader->pos());
+        _afterReadChecksum =
+            addDataToChecksum(startOfKey, endOfKey - startOfKey, _afterReadChecksum);
 
+        const char* startOfValue = static_cast<const char*>(_valueReader->pos());
+        auto second = Value::deserializeForSorter(*_valueReader, _settings.second);
+        const char* endOfValue = static_cast<const char*>(_valueReader->pos());
         _afterReadChecksum =
-            addDataToChecksum(startOfNewData, endOfNewData - startOfNewData, _afterReadChecksum);
+            addDataToChecksum(startOfValue, endOfValue - startOfValue, _afterReadChecksum);
 
         return Data(std::move(first), std::move(second));
     }
 
 private:
     /**
-     * Attempts to refill the _bufferReader if it is empty. Expects _done to be false.
+     * Attempts to refill the _keyReader and _valueReader if they are empty. Expects _done to be
+     * false.
      */
     void fillBufferIfNeeded() {
         verify(!_done);
 
-        if (!_bufferReader || _bufferReader->atEof())
+        if (!_keyReader || _keyReader->atEof()) {
+            uassert(4765003,
+                    str::stream() << "sorted data block in file \"" << _fileName
+                                  << "\" has more values than keys",
+                    !_valueReader || _valueReader->atEof());
             fillBufferFromDisk();
+        }
     }
 
     /**
-     * Tries to read from disk and places any results in _bufferReader. If there is no more data to
-     * read, then _done is set to true and the function returns immediately.
+     * Tries to read a block from disk and points _keyReader and _valueReader at its key and value
+     * columns. If there is no more data to read, then _done is set to true and the function
+     * returns immediately.
      */
     void fillBufferFromDisk() {
         int32_t rawSize;
@@ -292,26 +300,43 @@ private:
             _buffer.swap(out);
         }
 
-        if (!compressed) {
-            _bufferReader.reset(new BufReader(_buffer.get(), blockSize));
-            return;
+        size_t uncompressedSize = blockSize;
+        if (compressed) {
+            const auto contentSize = ZSTD_getFrameContentSize(_buffer.get(), blockSize);
+            uassert(17061,
+                    "couldn't get uncompressed length",
+                    contentSize != ZSTD_CONTENTSIZE_ERROR &&
+                        contentSize != ZSTD_CONTENTSIZE_UNKNOWN);
+            uncompressedSize = contentSize;
+
+            std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
+            const size_t decompressedSize = ZSTD_decompress(
+                decompressionBuffer.get(), uncompressedSize, _buffer.get(), blockSize);
+            uassert(17062,
+                    str::stream() << "decompression failed: "
+                                  << (ZSTD_isError(decompressedSize)
+                                          ? ZSTD_getErrorName(decompressedSize)
+                                          : "unexpected uncompressed length"),
+                    decompressedSize == uncompressedSize);
+
+            // hold on to decompressed data and throw out compressed data at block exit
+            _buffer.swap(decompressionBuffer);
         }
 
-        dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
-
-        size_t uncompressedSize;
-        uassert(17061,
-                "couldn't get uncompressed length",
-                snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
-
-        std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
-        uassert(17062,
-                "decompression failed",
-                snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
-
-        // hold on to decompressed data and throw out compressed data at block exit
-        _buffer.swap(decompressionBuffer);
-        _bufferReader.reset(new BufReader(_buffer.get(), uncompressedSize));
+        // The block starts with the length of its key column, followed by the key column and then
+        // the value column.
+        int32_t keysSize;
+        uassert(4765006, "sorted data block too short", uncompressedSize >= sizeof(keysSize));
+        memcpy(&keysSize, _buffer.get(), sizeof(keysSize));
+        const size_t columnsSize = uncompressedSize - sizeof(keysSize);
+        uassert(4765004,
+                str::stream() << "invalid key column length " << keysSize
+                              << " in sorted data block of file \"" << _fileName << "\"",
+                keysSize >= 0 && static_cast<size_t>(keysSize) <= columnsSize);
+
+        const char* keys = _buffer.get() + sizeof(keysSize);
+        _keyReader.reset(new BufReader(keys, keysSize));
+        _valueReader.reset(new BufReader(keys + keysSize, columnsSize - keysSize));
     }
 
     /**
@@ -346,7 +371,8 @@ private:
     bool _done;
 
     std::unique_ptr<char[]> _buffer;
-    std::unique_ptr<BufReader> _bufferReader;
+    std::unique_ptr<BufReader> _keyReader;    // Key column of the current block in _buffer.
+    std::unique_ptr<BufReader> _valueReader;  // Value column of the current block in _buffer.
     std::string _fileName;            // File containing the sorted data range.
     std::streampos _fileStartOffset;  // File offset at which the sorted data range starts.
     std::streampos _fileEndOffset;    // File offset at which the sorted data range ends.
@@ -665,6 +691,10 @@ public:
         }
     }
 
+    const Key* cutoffKey() const {
+        return _haveData ? &_best.first : nullptr;
+    }
+
 private:
     const Comparator _comp;
     Data _best;
@@ -743,6 +773,11 @@ public:
         if (!less(contender, _data.front()))
             return;  // not good enough
 
+        // Data which was spilled may already have made the cutoff better than the worst data held
+        // in memory.
+        if (_haveCutoff && !less(contender, _cutoff))
+            return;
+
         // Remove the old worst pair and insert the contender, adjusting _memUsed
 
         _memUsed += key.memUsageForSorter();
@@ -771,6 +806,17 @@ public:
         return iterator;
     }
 
+    const Key* cutoffKey() const {
+        // Data is discarded if it is not better than both the worst data held in memory, once
+        // there is enough of it, and the cutoff computed from the spilled data.
+        const Data* cutoff = _haveCutoff ? &_cutoff : nullptr;
+        if (_data.size() == _opts.limit &&
+            (!cutoff || STLComparator(_comp)(_data.front(), *cutoff))) {
+            cutoff = &_data.front();
+        }
+        return cutoff ? &cutoff->first : nullptr;
+    }
+
 private:
     class STLComparator {
     public:
@@ -977,38 +1023,56 @@ SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts,
 template <typename Key, typename Value>
 void SortedFileWriter<Key, Value>::addAlreadySorted(const Key& key, const Value& val) {
 
-    // Offset that points to the place in the buffer where a new data object will be stored.
-    int _nextObjPos = _buffer.len();
+    // Offsets that point to the places in the column buffers where the new key and value will be
+    // stored.
+    int nextKeyPos = _keyBuffer.len();
+    int nextValuePos = _valueBuffer.len();
 
-    // Add serialized key and value to the buffer.
-    key.serializeForSorter(_buffer);
-    val.serializeForSorter(_buffer);
+    // Add the serialized key and value to their columns.
+    key.serializeForSorter(_keyBuffer);
+    val.serializeForSorter(_valueBuffer);
 
-    // Serializing the key and value grows the buffer, but _buffer.buf() still points to the
-    // beginning. Use _buffer.len() to determine portion of buffer containing new datum.
-    _checksum =
-        addDataToChecksum(_buffer.buf() + _nextObjPos, _buffer.len() - _nextObjPos, _checksum);
+    // Serializing grows the buffers, but buf() still points to their beginning. Use len() to
+    // determine the portion of each buffer containing the new datum.
+    _checksum = addDataToChecksum(
+        _keyBuffer.buf() + nextKeyPos, _keyBuffer.len() - nextKeyPos, _checksum);
+    _checksum = addDataToChecksum(
+        _valueBuffer.buf() + nextValuePos, _valueBuffer.len() - nextValuePos, _checksum);
 
-    if (_buffer.len() > 64 * 1024)
+    if (_keyBuffer.len() + _valueBuffer.len() > 64 * 1024)
         spill();
 }
 
 template <typename Key, typename Value>
 void SortedFileWriter<Key, Value>::spill() {
-    int32_t size = _buffer.len();
-    char* outBuffer = _buffer.buf();
-
-    if (size == 0)
+    const int32_t keysSize = _keyBuffer.len();
+    if (keysSize + _valueBuffer.len() == 0)
         return;
 
-    std::string compressed;
-    snappy::Compress(outBuffer, size, &compressed);
-    verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
-
-    const bool shouldCompress = compressed.size() < size_t(_buffer.len() / 10 * 9);
+    // Each block holds the length of its key column, then the key column, then the value column.
+    // Keeping keys and values apart groups similar bytes together, which compresses better than
+    // interleaved pairs.
+    BufBuilder block(sizeof(keysSize) + keysSize + _valueBuffer.len());
+    block.appendNum(keysSize);
+    block.appendBuf(_keyBuffer.buf(), keysSize);
+    block.appendBuf(_valueBuffer.buf(), _valueBuffer.len());
+
+    int32_t size = block.len();
+    char* outBuffer = block.buf();
+
+    std::unique_ptr<char[]> compressed(new char[ZSTD_compressBound(size)]);
+    const size_t compressedSize = ZSTD_compress(
+        compressed.get(), ZSTD_compressBound(size), outBuffer, size, ZSTD_CLEVEL_DEFAULT);
+    uassert(4765005,
+            str::stream() << "Failed to compress sorted data: "
+                          << ZSTD_getErrorName(compressedSize),
+            !ZSTD_isError(compressedSize));
+    verify(compressedSize <= size_t(std::numeric_limits<int32_t>::max()));
+
+    const bool shouldCompress = compressedSize < size_t(size / 10 * 9);
     if (shouldCompress) {
-        size = compressed.size();
-        outBuffer = const_cast<char*>(compressed.data());
+        size = compressedSize;
+        outBuffer = compressed.get();
     }
 
     std::unique_ptr<char[]> out;
@@ -1040,7 +1104,8 @@ void SortedFileWriter<Key, Value>::spill() {
                                   << "\": " << sorter::myErrnoWithDescription());
     }
 
-    _buffer.reset();
+    _keyBuffer.reset();
+    _valueBuffer.reset();
 }
 
 template <typename Key, typename Value>
@@ -227,6 +227,16 @@ public:
      */
     virtual Iterator* done() = 0;
 
+    /**
+     * Returns a key such that any data added with a key which does not compare less than it will
+     * be discarded, or nullptr if there is no such key. Only sorters with a limit discard data,
+     * once they hold enough data which is better than the returned key. Cannot be called after
+     * done().
+     */
+    virtual const Key* cutoffKey() const {
+        return nullptr;
+    }
+
     virtual ~Sorter() {}
 
     bool usedDisk() const {
@@ -283,7 +293,10 @@ private:
     const Settings _settings;
     std::string _fileName;
     std::ofstream _file;
-    BufBuilder _buffer;
+
+    // Serialized keys and values waiting to be spilled, kept in separate columns.
+    BufBuilder _keyBuffer;
+    BufBuilder _valueBuffer;
 
     // Keeps track of the hash of all data objects spilled to disk. Passed to the FileIterator
     // to ensure data has not been corrupted after reading from disk.
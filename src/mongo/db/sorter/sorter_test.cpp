@@ -310,6 +310,30 @@ public:
 
             ASSERT_TRUE(boost::filesystem::remove(fileName));
         }
+        {  // compressible
+            std::string fileName = opts.tempDir + "/" + nextFileName();
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(opts, fileName, 0);
+            const int numPairs = 100 * 1000;
+            for (int i = 0; i < numPairs; i++)
+                sorter.addAlreadySorted(i, 0);
+            std::shared_ptr<IWIterator> iter(sorter.done());
+
+            // The constant value column should compress to almost nothing.
+            const std::streamoff rawSize = numPairs * 2 * sizeof(int);
+            ASSERT_LT(std::streamoff(sorter.getFileEndOffset()), rawSize / 2);
+
+            iter->openSource();
+            for (int i = 0; i < numPairs; i++) {
+                ASSERT_TRUE(iter->more());
+                IWPair pair = iter->next();
+                ASSERT_EQ(pair.first, i);
+                ASSERT_EQ(pair.second, 0);
+            }
+            ASSERT_FALSE(iter->more());
+            iter->closeSource();
+
+            ASSERT_TRUE(boost::filesystem::remove(fileName));
+        }
 
         ASSERT(boost::filesystem::is_empty(tempDir.path()));
     }
@@ -519,6 +543,48 @@ class Dupes : public Basic {
     }
 };
 
+class CutoffKey : public ScopedGlobalServiceContextForTest {
+public:
+    void run() {
+        unittest::TempDir tempDir("sorterTests");
+        const SortOptions opts = SortOptions().TempDir(tempDir.path());
+
+        {  // without a limit, nothing is ever discarded
+            std::unique_ptr<IWSorter> sorter(IWSorter::make(opts, IWComparator(ASC)));
+            sorter->add(1, -1);
+            ASSERT(!sorter->cutoffKey());
+        }
+        {  // limit 1
+            std::unique_ptr<IWSorter> sorter(
+                IWSorter::make(SortOptions(opts).Limit(1), IWComparator(ASC)));
+            ASSERT(!sorter->cutoffKey());
+            sorter->add(3, -3);
+            ASSERT_EQ(3, *sorter->cutoffKey());
+            sorter->add(5, -5);
+            ASSERT_EQ(3, *sorter->cutoffKey());
+            sorter->add(2, -2);
+            ASSERT_EQ(2, *sorter->cutoffKey());
+        }
+        {  // limit 3, DESC
+            std::unique_ptr<IWSorter> sorter(
+                IWSorter::make(SortOptions(opts).Limit(3), IWComparator(DESC)));
+            sorter->add(1, -1);
+            sorter->add(2, -2);
+            ASSERT(!sorter->cutoffKey());
+            sorter->add(3, -3);
+            ASSERT_EQ(1, *sorter->cutoffKey());
+            sorter->add(5, -5);
+            ASSERT_EQ(2, *sorter->cutoffKey());
+            sorter->add(0, 0);
+            ASSERT_EQ(2, *sorter->cutoffKey());
+
+            const int array[] = {5, 3, 2};
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter->done()),
+                                        makeInMemIterator(array));
+        }
+    }
+};
+
 template <bool Random = true>
 class LotsOfDataLittleMemory : public Basic {
 public:
@@ -598,6 +664,7 @@ public:
         add<SorterTests::Basic>();
         add<SorterTests::Limit>();
         add<SorterTests::Dupes>();
+        add<SorterTests::CutoffKey>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
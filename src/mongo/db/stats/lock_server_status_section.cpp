@@ -33,6 +33,8 @@
 
 #include "mongo/db/client.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/db/concurrency/lock_manager.h"
+#include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/concurrency/lock_stats.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
@@ -127,5 +129,29 @@ public:
 
 } lockStatsServerStatusSection;
 
+
+class LockManagerServerStatusSection : public ServerStatusSection {
+public:
+    LockManagerServerStatusSection() : ServerStatusSection("lockManager") {}
+
+    // Walks every lock bucket, so it is only reported on request.
+    bool includeByDefault() const override {
+        return false;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        BSONObjBuilder ret;
+        getGlobalLockManager()->appendContentionStats(
+            &ret, kMaxHotBuckets, kMaxResourcesPerHotBucket);
+        return ret.obj();
+    }
+
+private:
+    static constexpr size_t kMaxHotBuckets = 5;
+    static constexpr size_t kMaxResourcesPerHotBucket = 10;
+
+} lockManagerServerStatusSection;
+
 }  // namespace
 }  // namespace mongo
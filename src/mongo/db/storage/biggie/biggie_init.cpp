@@ -32,6 +32,7 @@
 #include "mongo/base/init.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/storage/biggie/biggie_kv_engine.h"
+#include "mongo/db/storage/biggie/biggie_parameters_gen.h"
 #include "mongo/db/storage/storage_engine_impl.h"
 #include "mongo/db/storage/storage_engine_init.h"
 #include "mongo/db/storage/storage_options.h"
@@ -47,7 +48,12 @@ public:
         StorageEngineOptions options;
         options.directoryPerDB = params.directoryperdb;
         options.forRepair = params.repair;
-        return new StorageEngineImpl(new KVEngine(), options);
+        std::string checkpointPath;
+        if (gBiggieCheckpointIntervalSecs > 0) {
+            checkpointPath = params.dbpath + "/biggie.checkpoint";
+        }
+        return new StorageEngineImpl(new KVEngine(checkpointPath, gBiggieCheckpointIntervalSecs),
+                                     options);
     }
 
     virtual StringData getCanonicalName() const {
@@ -33,17 +33,253 @@
 
 #include "mongo/db/storage/biggie/biggie_kv_engine.h"
 
+#include <boost/filesystem/operations.hpp>
 #include <memory>
 
+#include "mongo/base/data_range_cursor.h"
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/snapshot_window_options.h"
 #include "mongo/db/storage/biggie/biggie_recovery_unit.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/file.h"
 
 namespace mongo {
 namespace biggie {
+namespace {
+// Marks the start and the end of a complete checkpoint file.
+const uint64_t kCheckpointHeader = 0x3174706b63676762;   // "bggckpt1"
+const uint64_t kCheckpointTrailer = 0x646e656b63676762;  // "bggckend"
+
+/**
+ * Buffers the checkpoint being written and flushes it to the file in large writes.
+ */
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(File* file) : _file(file) {}
+
+    void writeNumber(uint64_t number) {
+        char buf[sizeof(number)];
+        DataView(buf).write<LittleEndian<uint64_t>>(number);
+        _buffer.append(buf, sizeof(buf));
+        _flushIfNeeded();
+    }
+
+    void writeString(StringData str) {
+        writeNumber(str.size());
+        _buffer.append(str.rawData(), str.size());
+        _flushIfNeeded();
+    }
+
+    /**
+     * Returns the total number of bytes written.
+     */
+    fileofs flush() {
+        if (!_buffer.empty()) {
+            _file->write(_offset, _buffer.data(), _buffer.size());
+            _offset += _buffer.size();
+            _buffer.clear();
+        }
+        return _offset;
+    }
+
+private:
+    static constexpr size_t kFlushBytes = 1024 * 1024;
+
+    void _flushIfNeeded() {
+        if (_buffer.size() >= kFlushBytes)
+            flush();
+    }
+
+    File* const _file;
+    std::string _buffer;
+    fileofs _offset = 0;
+};
+
+uint64_t readNumber(ConstDataRangeCursor* cursor) {
+    auto number = cursor->readAndAdvanceNoThrow<LittleEndian<uint64_t>>();
+    uassert(ErrorCodes::DataCorruptionDetected,
+            "biggie checkpoint file is truncated",
+            number.isOK());
+    return number.getValue();
+}
+
+std::string readString(ConstDataRangeCursor* cursor) {
+    uint64_t size = readNumber(cursor);
+    uassert(ErrorCodes::DataCorruptionDetected,
+            "biggie checkpoint file is truncated",
+            size <= cursor->length());
+    std::string str(cursor->data(), size);
+    cursor->advance(size);
+    return str;
+}
+}  // namespace
+
+KVEngine::KVEngine(std::string checkpointPath, int checkpointIntervalSecs)
+    : mongo::KVEngine(),
+      _checkpointPath(std::move(checkpointPath)),
+      _checkpointIntervalSecs(checkpointIntervalSecs) {
+    if (!_checkpointPath.empty() && boost::filesystem::exists(_checkpointPath)) {
+        _loadCheckpoint();
+    }
+    _history[Timestamp()] = _master;
+
+    if (!_checkpointPath.empty() && _checkpointIntervalSecs > 0) {
+        _checkpointThread = stdx::thread([this] { _checkpointThreadLoop(); });
+    }
+}
+
+KVEngine::~KVEngine() {
+    if (_checkpointThread.joinable()) {
+        {
+            stdx::lock_guard<Latch> lock(_checkpointMutex);
+            _inShutdown = true;
+        }
+        _checkpointCV.notify_all();
+        _checkpointThread.join();
+    }
+}
+
+void KVEngine::cleanShutdown() {
+    if (_checkpointThread.joinable()) {
+        {
+            stdx::lock_guard<Latch> lock(_checkpointMutex);
+            _inShutdown = true;
+        }
+        _checkpointCV.notify_all();
+        _checkpointThread.join();
+        checkpoint();
+    }
+}
+
+void KVEngine::_checkpointThreadLoop() {
+    stdx::unique_lock<Latch> lock(_checkpointMutex);
+    while (true) {
+        MONGO_IDLE_THREAD_BLOCK;
+        _checkpointCV.wait_for(lock, stdx::chrono::seconds(_checkpointIntervalSecs), [&] {
+            return _inShutdown;
+        });
+        if (_inShutdown)
+            return;
+
+        lock.unlock();
+        checkpoint();
+        lock.lock();
+    }
+}
+
+void KVEngine::checkpoint() {
+    if (_checkpointPath.empty())
+        return;
+
+    // Copying the tree is cheap as it shares all of its nodes with the master.
+    StringStore master;
+    std::map<std::string, bool> idents;
+    {
+        stdx::lock_guard<Latch> lock(_masterLock);
+        master = _master;
+        idents = _idents;
+    }
+
+    const Date_t startTime = Date_t::now();
+    const std::string tmpPath = _checkpointPath + ".tmp";
+    boost::filesystem::remove(tmpPath);
+
+    File file;
+    file.open(tmpPath.c_str());
+    CheckpointWriter writer(&file);
+    writer.writeNumber(kCheckpointHeader);
+    writer.writeNumber(idents.size());
+    for (const auto& [ident, isRecordStore] : idents) {
+        writer.writeString(ident);
+        writer.writeNumber(isRecordStore);
+    }
+    writer.writeNumber(master.size());
+    for (const auto& [key, value] : master) {
+        writer.writeString(key);
+        writer.writeString(value);
+    }
+    writer.writeNumber(kCheckpointTrailer);
+    file.truncate(writer.flush());
+    file.fsync();
+
+    if (file.bad()) {
+        LOGV2_WARNING(4765009,
+                      "Failed to write biggie checkpoint to {path}",
+                      "path"_attr = tmpPath);
+        return;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmpPath, _checkpointPath, ec);
+    if (ec) {
+        LOGV2_WARNING(4765010,
+                      "Failed to rename biggie checkpoint {tmpPath} to {path}: {error}",
+                      "tmpPath"_attr = tmpPath,
+                      "path"_attr = _checkpointPath,
+                      "error"_attr = ec.message());
+        return;
+    }
+
+    LOGV2_DEBUG(4765011,
+                1,
+                "Wrote biggie checkpoint of {numEntries} entries in {duration}",
+                "numEntries"_attr = master.size(),
+                "duration"_attr = Date_t::now() - startTime);
+}
+
+void KVEngine::_loadCheckpoint() {
+    File file;
+    file.open(_checkpointPath.c_str(), true /* readOnly */);
+    uassert(ErrorCodes::FileOpenFailed,
+            str::stream() << "Failed to open biggie checkpoint " << _checkpointPath,
+            file.is_open());
+
+    std::string contents(file.len(), '\0');
+    const unsigned kMaxReadBytes = 64 * 1024 * 1024;
+    for (fileofs offset = 0; offset < contents.size(); offset += kMaxReadBytes) {
+        file.read(offset,
+                  &contents[offset],
+                  std::min<fileofs>(kMaxReadBytes, contents.size() - offset));
+    }
+    uassert(ErrorCodes::FileStreamFailed,
+            str::stream() << "Failed to read biggie checkpoint " << _checkpointPath,
+            !file.bad());
+
+    ConstDataRangeCursor cursor(contents.data(), contents.data() + contents.size());
+    uassert(ErrorCodes::DataCorruptionDetected,
+            str::stream() << _checkpointPath << " is not a biggie checkpoint",
+            readNumber(&cursor) == kCheckpointHeader);
+
+    std::map<std::string, bool> idents;
+    for (uint64_t numIdents = readNumber(&cursor); numIdents > 0; --numIdents) {
+        auto ident = readString(&cursor);
+        idents[ident] = readNumber(&cursor);
+    }
+
+    StringStore master;
+    for (uint64_t numEntries = readNumber(&cursor); numEntries > 0; --numEntries) {
+        auto key = readString(&cursor);
+        master.insert(StringStore::value_type(std::move(key), readString(&cursor)));
+    }
+    uassert(ErrorCodes::DataCorruptionDetected,
+            str::stream() << "biggie checkpoint " << _checkpointPath << " is incomplete",
+            readNumber(&cursor) == kCheckpointTrailer);
+
+    LOGV2(4765012,
+          "Loaded biggie checkpoint {path} with {numEntries} entries",
+          "path"_attr = _checkpointPath,
+          "numEntries"_attr = master.size());
+
+    _master = std::move(master);
+    _idents = std::move(idents);
+    _loadedFromCheckpoint = true;
+}
 
 mongo::RecoveryUnit* KVEngine::newRecoveryUnit() {
     return new RecoveryUnit(this, nullptr);
@@ -57,6 +293,7 @@ Status KVEngine::createRecordStore(OperationContext* opCtx,
                                    StringData ns,
                                    StringData ident,
                                    const CollectionOptions& options) {
+    stdx::lock_guard<Latch> lock(_masterLock);
     _idents[ident.toString()] = true;
     return Status::OK();
 }
@@ -65,6 +302,7 @@ std::unique_ptr<mongo::RecordStore> KVEngine::makeTemporaryRecordStore(Operation
                                                                        StringData ident) {
     std::unique_ptr<mongo::RecordStore> recordStore =
         std::make_unique<RecordStore>("", ident, false);
+    stdx::lock_guard<Latch> lock(_masterLock);
     _idents[ident.toString()] = true;
     return recordStore;
 };
@@ -89,41 +327,187 @@ std::unique_ptr<mongo::RecordStore> KVEngine::getRecordStore(OperationContext* o
     } else {
         recordStore = std::make_unique<RecordStore>(ns, ident, options.capped);
     }
+    stdx::lock_guard<Latch> lock(_masterLock);
+    if (_loadedFromCheckpoint) {
+        checked_cast<RecordStore*>(recordStore.get())->restoreStatsFromStore(_master);
+    }
     _idents[ident.toString()] = true;
     return recordStore;
 }
 
-bool KVEngine::trySwapMaster(StringStore& newMaster, uint64_t version) {
+std::pair<uint64_t, StringStore> KVEngine::getMasterInfo(boost::optional<Timestamp> readTimestamp) {
+    stdx::lock_guard<Latch> lock(_masterLock);
+    if (!readTimestamp) {
+        return std::make_pair(_masterVersion, _master);
+    }
+
+    auto it = _history.upper_bound(*readTimestamp);
+    uassert(ErrorCodes::SnapshotTooOld,
+            str::stream() << "Read timestamp " << readTimestamp->toString()
+                          << " is older than the oldest available timestamp",
+            it != _history.begin());
+    return std::make_pair(_masterVersion, std::prev(it)->second);
+}
+
+bool KVEngine::trySwapMaster(StringStore& newMaster, uint64_t version, Timestamp commitTimestamp) {
     stdx::lock_guard<Latch> lock(_masterLock);
     invariant(!newMaster.hasBranch() && !_master.hasBranch());
     if (_masterVersion != version)
         return false;
+    _recordInHistory(lock, newMaster, {{commitTimestamp, _master, newMaster}});
     _master = newMaster;
     _masterVersion++;
     return true;
 }
 
+bool KVEngine::trySwapMaster(StringStore& newMaster,
+                             uint64_t version,
+                             const std::vector<TimestampedWrites>& writes) {
+    stdx::lock_guard<Latch> lock(_masterLock);
+    invariant(!newMaster.hasBranch() && !_master.hasBranch());
+    if (_masterVersion != version)
+        return false;
+    _recordInHistory(lock, newMaster, writes);
+    _master = newMaster;
+    _masterVersion++;
+    return true;
+}
+
+void KVEngine::_recordInHistory(WithLock,
+                                const StringStore& newMaster,
+                                const std::vector<TimestampedWrites>& writes) {
+    invariant(!_history.empty());
+
+    // Commits usually write at one timestamp, in timestamp order, so the new master is the version
+    // at that timestamp.
+    if (writes.size() == 1 && !writes.front().timestamp.isNull() &&
+        writes.front().timestamp >= _history.rbegin()->first) {
+        _history[writes.front().timestamp] = newMaster;
+        return;
+    }
+
+    for (const auto& write : writes) {
+        std::vector<std::pair<std::string, const std::string*>> changes;
+        write.tree.forEachChangeSince(write.base,
+                                      [&](const std::string& key, const std::string* value) {
+                                          changes.emplace_back(key, value);
+                                      });
+        if (changes.empty())
+            continue;
+
+        auto it = _history.begin();
+        if (!write.timestamp.isNull()) {
+            // Start a version at the write's timestamp from the one that served reads there. If
+            // the history does not go back that far, there is nothing to start it from, and reads
+            // at that timestamp fail with SnapshotTooOld anyway.
+            it = _history.upper_bound(write.timestamp);
+            if (it != _history.begin()) {
+                it = _history.emplace_hint(it, write.timestamp, std::prev(it)->second);
+            }
+        }
+
+        for (; it != _history.end(); ++it) {
+            auto& version = it->second;
+            for (const auto& [key, value] : changes) {
+                if (!value) {
+                    version.erase(key);
+                } else if (version.find(key) == version.end()) {
+                    version.insert(StringStore::value_type(key, *value));
+                } else {
+                    version.update(StringStore::value_type(key, *value));
+                }
+            }
+        }
+    }
+
+    // The newest version now holds every committed write, as the new master does. Sharing the
+    // master's tree keeps the two from holding separate copies of the same nodes.
+    _history.rbegin()->second = newMaster;
+}
+
+Timestamp KVEngine::getAllDurableTimestamp() const {
+    if (_visibilityManager) {
+        RecordId id = _visibilityManager->getAllCommittedRecord();
+        return Timestamp(id.repr());
+    }
+    stdx::lock_guard<Latch> lock(_masterLock);
+    return _history.empty() ? Timestamp() : _history.rbegin()->first;
+}
+
+void KVEngine::setStableTimestamp(Timestamp stableTimestamp, bool force) {
+    if (stableTimestamp.isNull()) {
+        return;
+    }
+
+    // Do not set the stable timestamp backward, unless 'force' is set.
+    if (stableTimestamp.asULL() < _stableTimestamp.load() && !force) {
+        return;
+    }
+    _stableTimestamp.store(stableTimestamp.asULL());
+
+    // Forward the oldest timestamp so that the versions no longer readable leave the history.
+    if (!force) {
+        setOldestTimestampFromStable();
+    }
+}
+
+void KVEngine::setOldestTimestampFromStable() {
+    // Keep 'targetSnapshotHistoryWindowInSeconds' worth of history behind the stable timestamp.
+    Timestamp stableTimestamp = getStableTimestamp();
+    const unsigned window = snapshotWindowParams.targetSnapshotHistoryWindowInSeconds.load();
+    if (stableTimestamp.getSecs() < window) {
+        return;
+    }
+    setOldestTimestamp(Timestamp(stableTimestamp.getSecs() - window, stableTimestamp.getInc()),
+                       false);
+}
+
+void KVEngine::setOldestTimestamp(Timestamp newOldestTimestamp, bool force) {
+    if (!force && newOldestTimestamp.asULL() <= _oldestTimestamp.load()) {
+        return;
+    }
+    _oldestTimestamp.store(newOldestTimestamp.asULL());
+
+    // Drop every version older than the one serving reads at the oldest timestamp.
+    stdx::lock_guard<Latch> lock(_masterLock);
+    auto it = _history.upper_bound(newOldestTimestamp);
+    if (it != _history.begin()) {
+        _history.erase(_history.begin(), std::prev(it));
+    }
+}
+
 
 Status KVEngine::createSortedDataInterface(OperationContext* opCtx,
                                            const CollectionOptions& collOptions,
                                            StringData ident,
                                            const IndexDescriptor* desc) {
+    stdx::lock_guard<Latch> lock(_masterLock);
     _idents[ident.toString()] = false;
     return Status::OK();  // I don't think we actually need to do anything here
 }
 
 std::unique_ptr<mongo::SortedDataInterface> KVEngine::getSortedDataInterface(
     OperationContext* opCtx, StringData ident, const IndexDescriptor* desc) {
-    _idents[ident.toString()] = false;
+    {
+        stdx::lock_guard<Latch> lock(_masterLock);
+        _idents[ident.toString()] = false;
+    }
     return std::make_unique<SortedDataInterface>(opCtx, ident, desc);
 }
 
 Status KVEngine::dropIdent(OperationContext* opCtx, mongo::RecoveryUnit* ru, StringData ident) {
     Status dropStatus = Status::OK();
-    if (_idents.count(ident.toString()) > 0) {
+    boost::optional<bool> isRecordStore;
+    {
+        stdx::lock_guard<Latch> lock(_masterLock);
+        auto it = _idents.find(ident.toString());
+        if (it != _idents.end())
+            isRecordStore = it->second;
+    }
+    if (isRecordStore) {
         // Check if the ident is a RecordStore or a SortedDataInterface then call the corresponding
         // truncate. A true value in the map means it is a RecordStore, false a SortedDataInterface.
-        if (_idents[ident.toString()] == true) {  // ident is RecordStore.
+        if (*isRecordStore) {  // ident is RecordStore.
             CollectionOptions s;
             auto rs = getRecordStore(/*unused*/ opCtx, ""_sd, ident, s);
             dropStatus =
@@ -133,6 +517,7 @@ Status KVEngine::dropIdent(OperationContext* opCtx, mongo::RecoveryUnit* ru, Str
                 std::make_unique<SortedDataInterface>(Ordering::make(BSONObj()), true, ident);
             dropStatus = sdi->truncate(ru);
         }
+        stdx::lock_guard<Latch> lock(_masterLock);
         _idents.erase(ident.toString());
     }
     return dropStatus;
@@ -146,6 +531,9 @@ public:
     boost::optional<Record> seekExact(const RecordId& id) final {
         return {};
     }
+    boost::optional<Record> seek(const RecordId& start) final {
+        return {};
+    }
     void save() final {}
     bool restore() final {
         return true;
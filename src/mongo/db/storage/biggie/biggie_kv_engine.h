@@ -29,27 +29,36 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <mutex>
 #include <set>
 
 #include "mongo/db/storage/biggie/biggie_record_store.h"
+#include "mongo/db/storage/biggie/biggie_snapshot_manager.h"
 #include "mongo/db/storage/biggie/biggie_sorted_impl.h"
 #include "mongo/db/storage/biggie/store.h"
 #include "mongo/db/storage/kv/kv_engine.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/with_lock.h"
 
 namespace mongo {
 namespace biggie {
 
 class JournalListener;
 /**
- * The biggie storage engine is intended for unit and performance testing.
+ * The biggie storage engine keeps all data in memory. Every committed version of the data is
+ * shared structurally with its predecessor, so the versions committed at recent timestamps are
+ * kept around to serve reads at a point in time. When 'checkpointPath' is given, the data is
+ * periodically written to that file and reloaded from it on startup.
  */
 class KVEngine : public mongo::KVEngine {
 public:
-    KVEngine() : mongo::KVEngine() {}
+    explicit KVEngine(std::string checkpointPath = "", int checkpointIntervalSecs = 0);
 
-    virtual ~KVEngine() {}
+    virtual ~KVEngine();
 
     virtual mongo::RecoveryUnit* newRecoveryUnit();
 
@@ -125,20 +134,18 @@ public:
 
     std::vector<std::string> getAllIdents(OperationContext* opCtx) const {
         std::vector<std::string> idents;
+        stdx::lock_guard<Latch> lock(_masterLock);
         for (const auto& i : _idents) {
             idents.push_back(i.first);
         }
         return idents;
     }
 
-    virtual void cleanShutdown(){};
+    virtual void cleanShutdown();
 
     void setJournalListener(mongo::JournalListener* jl) final {}
 
-    virtual Timestamp getAllDurableTimestamp() const override {
-        RecordId id = _visibilityManager->getAllCommittedRecord();
-        return Timestamp(id.repr());
-    }
+    virtual Timestamp getAllDurableTimestamp() const override;
 
     virtual Timestamp getOldestOpenReadTimestamp() const override {
         return Timestamp();
@@ -148,31 +155,124 @@ public:
         return boost::none;
     }
 
+    SnapshotManager* getSnapshotManager() const final {
+        return &_snapshotManager;
+    }
+
+    bool supportsReadConcernSnapshot() const final {
+        return true;
+    }
+
+    void setStableTimestamp(Timestamp stableTimestamp, bool force) final;
+
+    void setOldestTimestampFromStable() final;
+
+    void setOldestTimestamp(Timestamp newOldestTimestamp, bool force) final;
+
+    Timestamp getOldestTimestamp() const final {
+        return Timestamp(_oldestTimestamp.load());
+    }
+
+    Timestamp getStableTimestamp() const final {
+        return Timestamp(_stableTimestamp.load());
+    }
+
     // Biggie Specific
 
     /**
-     * Returns a pair of the current version and copy of tree of the master.
+     * The writes a unit of work made at one timestamp: the changes from 'base' to 'tree'. A null
+     * 'timestamp' makes the writes visible at every timestamp.
      */
-    std::pair<uint64_t, StringStore> getMasterInfo() {
-        stdx::lock_guard<Latch> lock(_masterLock);
-        return std::make_pair(_masterVersion, _master);
-    }
+    struct TimestampedWrites {
+        Timestamp timestamp;
+        StringStore base;
+        StringStore tree;
+    };
+
+    /**
+     * Returns a pair of the current version and copy of tree of the master. If 'readTimestamp' is
+     * given, the tree is instead the data as of that timestamp. Throws SnapshotTooOld if the
+     * history no longer goes back to 'readTimestamp'.
+     */
+    std::pair<uint64_t, StringStore> getMasterInfo(
+        boost::optional<Timestamp> readTimestamp = boost::none);
 
     /**
      * Returns true and swaps _master to newMaster if the version passed in is the same as the
-     * masters current version.
+     * masters current version. The changes are recorded in the history at 'commitTimestamp';
+     * a null 'commitTimestamp' makes the changes visible at every timestamp.
      */
-    bool trySwapMaster(StringStore& newMaster, uint64_t version);
+    bool trySwapMaster(StringStore& newMaster,
+                       uint64_t version,
+                       Timestamp commitTimestamp = Timestamp());
+
+    /**
+     * Like the above, but records each of 'writes' in the history at its own timestamp. Together
+     * the writes must be the changes the unit of work made on its way to 'newMaster'.
+     */
+    bool trySwapMaster(StringStore& newMaster,
+                       uint64_t version,
+                       const std::vector<TimestampedWrites>& writes);
+
+    /**
+     * Writes the current master to the checkpoint file. Does nothing if checkpoints are disabled.
+     */
+    void checkpoint();
+
+    /**
+     * Returns the number of versions currently kept in the history.
+     */
+    size_t getHistorySizeForTest() const {
+        stdx::lock_guard<Latch> lock(_masterLock);
+        return _history.size();
+    }
 
 private:
+    /**
+     * Records 'writes' in '_history'. Each write replaces the key in the version at its timestamp
+     * and in every later one, even if a later version already changed that key, so that the most
+     * recently committed write visible at a timestamp wins. Untimestamped writes replace the key in
+     * every version. 'newMaster' becomes the newest version.
+     */
+    void _recordInHistory(WithLock,
+                          const StringStore& newMaster,
+                          const std::vector<TimestampedWrites>& writes);
+
+    /**
+     * Replaces '_master' and '_idents' with the contents of the checkpoint file.
+     */
+    void _loadCheckpoint();
+
+    void _checkpointThreadLoop();
+
     std::shared_ptr<void> _catalogInfo;
     int _cachePressureForTest = 0;
     std::map<std::string, bool> _idents;  // TODO : replace with a query to _master.
     std::unique_ptr<VisibilityManager> _visibilityManager;
+    mutable SnapshotManager _snapshotManager;
 
     mutable Mutex _masterLock = MONGO_MAKE_LATCH("KVEngine::_masterLock");
     StringStore _master;
     uint64_t _masterVersion = 0;
+
+    // Versions of the master committed at a timestamp, keyed by that timestamp. The newest
+    // version always holds the same data as '_master'. Versions older than the oldest timestamp
+    // are dropped. Guarded by '_masterLock'.
+    std::map<Timestamp, StringStore> _history;
+
+    AtomicWord<unsigned long long> _oldestTimestamp;
+    AtomicWord<unsigned long long> _stableTimestamp;
+
+    // Whether the data was loaded from a checkpoint, in which case record stores must recompute
+    // their sizes from it.
+    bool _loadedFromCheckpoint = false;
+
+    const std::string _checkpointPath;
+    const int _checkpointIntervalSecs;
+    Mutex _checkpointMutex = MONGO_MAKE_LATCH("KVEngine::_checkpointMutex");
+    stdx::condition_variable _checkpointCV;
+    bool _inShutdown = false;  // Guarded by '_checkpointMutex'.
+    stdx::thread _checkpointThread;
 };
 }  // namespace biggie
 }  // namespace mongo
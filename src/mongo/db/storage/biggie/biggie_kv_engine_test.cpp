@@ -36,7 +36,10 @@
 #include "mongo/base/init.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_test_fixture.h"
+#include "mongo/db/snapshot_window_options.h"
 #include "mongo/db/storage/biggie/biggie_kv_engine.h"
+#include "mongo/db/storage/biggie/biggie_recovery_unit.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -70,5 +73,153 @@ MONGO_INITIALIZER(RegisterKVHarnessFactory)(InitializerContext*) {
     return Status::OK();
 }
 
+namespace {
+void commit(KVEngine* engine, std::string key, std::string value, Timestamp timestamp) {
+    auto [version, store] = engine->getMasterInfo();
+    if (store.find(key) == store.end()) {
+        store.insert(StringStore::value_type(std::move(key), std::move(value)));
+    } else {
+        store.update(StringStore::value_type(std::move(key), std::move(value)));
+    }
+    ASSERT(engine->trySwapMaster(store, version, timestamp));
+}
+
+std::string valueAt(KVEngine* engine, const std::string& key, Timestamp timestamp) {
+    auto store = engine->getMasterInfo(timestamp).second;
+    auto it = store.find(key);
+    return it == store.end() ? "" : it->second;
+}
+
+TEST(BiggieKVEngineTest, ReadAtTimestamp) {
+    KVEngine engine;
+    commit(&engine, "a", "1", Timestamp(1, 1));
+    commit(&engine, "c", "3", Timestamp(3, 1));
+
+    // A commit at an earlier timestamp becomes visible to reads at that timestamp and later.
+    commit(&engine, "b", "2", Timestamp(2, 1));
+
+    ASSERT_EQ(engine.getMasterInfo(Timestamp(1, 1)).second.size(), 1u);
+    auto atTwo = engine.getMasterInfo(Timestamp(2, 5)).second;
+    ASSERT_EQ(atTwo.size(), 2u);
+    ASSERT(atTwo.find("b") != atTwo.end());
+    ASSERT(atTwo.find("c") == atTwo.end());
+    ASSERT_EQ(engine.getMasterInfo(Timestamp(3, 1)).second.size(), 3u);
+    ASSERT_EQ(engine.getMasterInfo().second.size(), 3u);
+
+    // Advancing the oldest timestamp drops the versions no longer readable.
+    engine.setOldestTimestamp(Timestamp(2, 5), false);
+    ASSERT_THROWS_CODE(
+        engine.getMasterInfo(Timestamp(1, 1)), DBException, ErrorCodes::SnapshotTooOld);
+    ASSERT_EQ(engine.getMasterInfo(Timestamp(2, 5)).second.size(), 2u);
+    ASSERT_EQ(engine.getHistorySizeForTest(), 2u);
+}
+
+TEST(BiggieKVEngineTest, AdvancingStableTimestampDropsOldHistory) {
+    KVEngine engine;
+    commit(&engine, "a", "1", Timestamp(10, 1));
+    commit(&engine, "b", "2", Timestamp(20, 1));
+    commit(&engine, "c", "3", Timestamp(30, 1));
+    ASSERT_EQ(engine.getHistorySizeForTest(), 4u);
+
+    // The oldest timestamp trails the stable timestamp by the snapshot history window.
+    const unsigned window = snapshotWindowParams.targetSnapshotHistoryWindowInSeconds.load();
+    engine.setStableTimestamp(Timestamp(30 + window, 1), false);
+    ASSERT_EQ(engine.getOldestTimestamp(), Timestamp(30, 1));
+    ASSERT_EQ(engine.getHistorySizeForTest(), 1u);
+    ASSERT_THROWS_CODE(
+        engine.getMasterInfo(Timestamp(20, 1)), DBException, ErrorCodes::SnapshotTooOld);
+    ASSERT_EQ(engine.getMasterInfo(Timestamp(30, 1)).second.size(), 3u);
+
+    // Forcing the stable timestamp leaves the oldest timestamp alone.
+    engine.setStableTimestamp(Timestamp(40 + window, 1), true);
+    ASSERT_EQ(engine.getStableTimestamp(), Timestamp(40 + window, 1));
+    ASSERT_EQ(engine.getOldestTimestamp(), Timestamp(30, 1));
+}
+
+TEST(BiggieKVEngineTest, UntimestampedCommitIsVisibleAtEveryTimestamp) {
+    KVEngine engine;
+    commit(&engine, "a", "1", Timestamp(1, 1));
+    commit(&engine, "b", "2", Timestamp());
+
+    ASSERT_EQ(engine.getMasterInfo(Timestamp(0, 1)).second.size(), 1u);
+    ASSERT_EQ(engine.getMasterInfo(Timestamp(1, 1)).second.size(), 2u);
+}
+
+TEST(BiggieKVEngineTest, OutOfOrderCommitOfSameKeyKeepsHistory) {
+    KVEngine engine;
+    commit(&engine, "a", "1", Timestamp(1, 1));
+    commit(&engine, "a", "3", Timestamp(3, 1));
+
+    // The commit at the earlier timestamp is replayed onto the later version, where it is the
+    // most recently committed write, as it is on the master.
+    commit(&engine, "a", "2", Timestamp(2, 1));
+
+    ASSERT_EQ(valueAt(&engine, "a", Timestamp(1, 1)), "1");
+    ASSERT_EQ(valueAt(&engine, "a", Timestamp(2, 1)), "2");
+    ASSERT_EQ(valueAt(&engine, "a", Timestamp(3, 1)), "2");
+    ASSERT_EQ(engine.getMasterInfo().second.find("a")->second, "2");
+    ASSERT_EQ(engine.getHistorySizeForTest(), 4u);
+}
+
+TEST(BiggieKVEngineTest, UntimestampedCommitOfSameKeyKeepsHistory) {
+    KVEngine engine;
+    commit(&engine, "a", "1", Timestamp(1, 1));
+    commit(&engine, "a", "2", Timestamp(2, 1));
+    commit(&engine, "b", "1", Timestamp(2, 1));
+
+    commit(&engine, "a", "0", Timestamp());
+
+    ASSERT_EQ(valueAt(&engine, "a", Timestamp(0, 1)), "0");
+    ASSERT_EQ(valueAt(&engine, "a", Timestamp(1, 1)), "0");
+    ASSERT_EQ(valueAt(&engine, "a", Timestamp(2, 1)), "0");
+    ASSERT_EQ(valueAt(&engine, "b", Timestamp(1, 1)), "");
+    ASSERT_EQ(valueAt(&engine, "b", Timestamp(2, 1)), "1");
+    ASSERT_EQ(engine.getHistorySizeForTest(), 3u);
+}
+
+TEST(BiggieKVEngineTest, UnitOfWorkWritesAreVisibleAtTheirOwnTimestamps) {
+    KVEngine engine;
+    commit(&engine, "a", "1", Timestamp(1, 1));
+
+    RecoveryUnit ru(&engine);
+    ru.beginUnitOfWork(nullptr);
+    ASSERT_OK(ru.setTimestamp(Timestamp(2, 1)));
+    ru.getHead()->insert(StringStore::value_type("b", "2"));
+    ru.makeDirty();
+    ASSERT_OK(ru.setTimestamp(Timestamp(3, 1)));
+    ru.getHead()->update(StringStore::value_type("a", "3"));
+    ru.commitUnitOfWork();
+
+    ASSERT_EQ(valueAt(&engine, "a", Timestamp(2, 1)), "1");
+    ASSERT_EQ(valueAt(&engine, "b", Timestamp(2, 1)), "2");
+    ASSERT_EQ(valueAt(&engine, "a", Timestamp(3, 1)), "3");
+    ASSERT_EQ(valueAt(&engine, "b", Timestamp(3, 1)), "2");
+    ASSERT_EQ(valueAt(&engine, "b", Timestamp(1, 1)), "");
+}
+
+TEST(BiggieKVEngineTest, Checkpoint) {
+    unittest::TempDir dir("biggie_checkpoint_test");
+    const std::string path = dir.path() + "/biggie.checkpoint";
+    {
+        KVEngine engine(path);
+        ASSERT_OK(engine.createRecordStore(nullptr, "ns", "collection-ident", {}));
+        commit(&engine, "a", "1", Timestamp());
+        commit(&engine, "b", std::string(2 * 1024 * 1024, 'x'), Timestamp());
+        engine.checkpoint();
+        commit(&engine, "c", "3", Timestamp());
+    }
+
+    KVEngine engine(path);
+    auto master = engine.getMasterInfo().second;
+    ASSERT_EQ(master.size(), 2u);
+    ASSERT_EQ(master.find("a")->second, "1");
+    ASSERT_EQ(master.find("b")->second.size(), 2u * 1024 * 1024);
+    ASSERT(master.find("c") == master.end());
+    auto idents = engine.getAllIdents(nullptr);
+    ASSERT_EQ(idents.size(), 1u);
+    ASSERT_EQ(idents[0], "collection-ident");
+}
+}  // namespace
+
 }  // namespace biggie
 }  // namespace mongo
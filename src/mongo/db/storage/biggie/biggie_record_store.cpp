@@ -307,6 +307,21 @@ void RecordStore::updateStatsAfterRepair(OperationContext* opCtx,
     _dataSize.store(dataSize);
 }
 
+void RecordStore::restoreStatsFromStore(const StringStore& store) {
+    long long numRecords = 0;
+    long long dataSize = 0;
+    int64_t highestRecordId = 0;
+    StringStore::const_iterator end = store.upper_bound(_postfix);
+    for (auto it = store.lower_bound(_prefix); it != end; ++it) {
+        ++numRecords;
+        dataSize += it->second.size();
+        highestRecordId = std::max(highestRecordId, extractRecordId(it->first).repr());
+    }
+    _numRecords.store(numRecords);
+    _dataSize.store(dataSize);
+    _highestRecordId.store(highestRecordId + 1);
+}
+
 void RecordStore::waitForAllEarlierOplogWritesToBeVisible(OperationContext* opCtx) const {
     _visibilityManager->waitForAllEarlierOplogWritesToBeVisible(opCtx);
 }
@@ -435,6 +450,30 @@ boost::optional<Record> RecordStore::Cursor::seekExact(const RecordId& id) {
     return Record{id, RecordData(it->second.c_str(), it->second.length())};
 }
 
+boost::optional<Record> RecordStore::Cursor::seek(const RecordId& start) {
+    _savedPosition = boost::none;
+    _lastMoveWasRestore = false;
+    _needFirstSeek = false;
+    StringStore* workingCopy(RecoveryUnit::get(opCtx)->getHead());
+    it = workingCopy->lower_bound(createKey(_ident, start.repr()));
+
+    if (it == workingCopy->end() || !inPrefix(it->first))
+        return boost::none;
+
+    RecordId id(extractRecordId(it->first));
+    if (_isOplog && id > _visibilityManager->getAllCommittedRecord())
+        return boost::none;
+
+    _savedPosition = it->first;
+    return Record{id, RecordData(it->second.c_str(), it->second.length())};
+}
+
+// Records point into the recovery unit's working copy, which only changes on writes or when the
+// snapshot is abandoned.
+bool RecordStore::Cursor::unownedDataValidUntilSave() const {
+    return true;
+}
+
 // Positions are saved as we go.
 void RecordStore::Cursor::save() {}
 void RecordStore::Cursor::saveUnpositioned() {}
@@ -517,6 +556,30 @@ boost::optional<Record> RecordStore::ReverseCursor::seekExact(const RecordId& id
     return Record{id, RecordData(it->second.c_str(), it->second.length())};
 }
 
+boost::optional<Record> RecordStore::ReverseCursor::seek(const RecordId& start) {
+    _needFirstSeek = false;
+    _savedPosition = boost::none;
+    _lastMoveWasRestore = false;
+    StringStore* workingCopy(RecoveryUnit::get(opCtx)->getHead());
+    // The reverse iterator refers to the last entry before the first one > 'start'.
+    it = StringStore::const_reverse_iterator(
+        workingCopy->upper_bound(createKey(_ident, start.repr())));
+
+    if (it == workingCopy->rend() || !inPrefix(it->first))
+        return boost::none;
+
+    RecordId id(extractRecordId(it->first));
+    if (_isOplog && id > _visibilityManager->getAllCommittedRecord())
+        return boost::none;
+
+    _savedPosition = it->first;
+    return Record{id, RecordData(it->second.c_str(), it->second.length())};
+}
+
+bool RecordStore::ReverseCursor::unownedDataValidUntilSave() const {
+    return true;
+}
+
 void RecordStore::ReverseCursor::save() {}
 void RecordStore::ReverseCursor::saveUnpositioned() {}
 
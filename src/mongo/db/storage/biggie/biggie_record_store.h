@@ -109,6 +109,14 @@ public:
                                         long long numRecords,
                                         long long dataSize);
 
+    // Biggie Specific
+
+    /**
+     * Recomputes the record count, data size and next record id from the records of this store
+     * in 'store'. Used after the engine's data was loaded from a checkpoint.
+     */
+    void restoreStatsFromStore(const StringStore& store);
+
 private:
     friend class VisibilityManagerChange;
 
@@ -188,6 +196,8 @@ private:
                VisibilityManager* visibilityManager);
         boost::optional<Record> next() final;
         boost::optional<Record> seekExact(const RecordId& id) final override;
+        boost::optional<Record> seek(const RecordId& start) final override;
+        bool unownedDataValidUntilSave() const final;
         void save() final;
         void saveUnpositioned() final override;
         bool restore() final;
@@ -217,6 +227,8 @@ private:
                       VisibilityManager* visibilityManager);
         boost::optional<Record> next() final;
         boost::optional<Record> seekExact(const RecordId& id) final override;
+        boost::optional<Record> seek(const RecordId& start) final override;
+        bool unownedDataValidUntilSave() const final;
         void save() final;
         void saveUnpositioned() final override;
         bool restore() final;
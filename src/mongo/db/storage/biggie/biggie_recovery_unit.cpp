@@ -56,8 +56,16 @@ void RecoveryUnit::beginUnitOfWork(OperationContext* opCtx) {
 void RecoveryUnit::doCommitUnitOfWork() {
     invariant(_inUnitOfWork(), toString(_getState()));
 
+    const Timestamp commitTimestamp =
+        _commitTimestamp.isNull() ? _lastTimestampSet : _commitTimestamp;
+
     if (_dirty) {
         invariant(_forked);
+        std::vector<KVEngine::TimestampedWrites> writes = std::move(_earlierTimestampedWrites);
+        _earlierTimestampedWrites.clear();
+        StringStore base = writes.empty() ? _mergeBase : writes.back().tree;
+        writes.push_back({commitTimestamp, std::move(base), _workingCopy});
+
         while (true) {
             std::pair<uint64_t, StringStore> masterInfo = _KVEngine->getMasterInfo();
             try {
@@ -66,7 +74,7 @@ void RecoveryUnit::doCommitUnitOfWork() {
                 throw WriteConflictException();
             }
 
-            if (_KVEngine->trySwapMaster(_workingCopy, masterInfo.first)) {
+            if (_KVEngine->trySwapMaster(_workingCopy, masterInfo.first, writes)) {
                 // Merged successfully
                 break;
             } else {
@@ -82,8 +90,11 @@ void RecoveryUnit::doCommitUnitOfWork() {
     }
 
     _setState(State::kCommitting);
-    commitRegisteredChanges(boost::none);
+    commitRegisteredChanges(commitTimestamp.isNull() ? boost::none
+                                                     : boost::make_optional(commitTimestamp));
     _setState(State::kInactive);
+    _lastTimestampSet = Timestamp();
+    _earlierTimestampedWrites.clear();
 }
 
 void RecoveryUnit::doAbortUnitOfWork() {
@@ -109,7 +120,8 @@ bool RecoveryUnit::forkIfNeeded() {
 
     // Update the copies of the trees when not in a WUOW so cursors can retrieve the latest data.
 
-    std::pair<uint64_t, StringStore> masterInfo = _KVEngine->getMasterInfo();
+    _readAtTimestamp = _chooseReadTimestamp();
+    std::pair<uint64_t, StringStore> masterInfo = _KVEngine->getMasterInfo(_readAtTimestamp);
     StringStore master = masterInfo.second;
 
     _mergeBase = master;
@@ -119,11 +131,118 @@ bool RecoveryUnit::forkIfNeeded() {
     return true;
 }
 
+boost::optional<Timestamp> RecoveryUnit::_chooseReadTimestamp() {
+    switch (_timestampReadSource) {
+        case ReadSource::kUnset:
+        case ReadSource::kNoTimestamp:
+        case ReadSource::kCheckpoint:
+            return boost::none;
+        case ReadSource::kMajorityCommitted: {
+            auto committed = _KVEngine->getSnapshotManager()->getCommittedSnapshot();
+            uassert(ErrorCodes::ReadConcernMajorityNotAvailableYet,
+                    "Committed view disappeared while running operation",
+                    committed);
+            return committed;
+        }
+        case ReadSource::kLastApplied:
+            // Without a local snapshot, read the latest data.
+            return _KVEngine->getSnapshotManager()->getLocalSnapshot();
+        case ReadSource::kNoOverlap:
+        case ReadSource::kAllDurableSnapshot: {
+            // kAllDurableSnapshot keeps reading at the timestamp it first chose.
+            if (_timestampReadSource == ReadSource::kAllDurableSnapshot && _readAtTimestamp) {
+                return _readAtTimestamp;
+            }
+            auto allDurable = _KVEngine->getAllDurableTimestamp();
+            if (allDurable.isNull())
+                return boost::none;
+            return allDurable;
+        }
+        case ReadSource::kProvided:
+            return _providedReadTimestamp;
+    }
+    MONGO_UNREACHABLE;
+}
+
+Status RecoveryUnit::obtainMajorityCommittedSnapshot() {
+    invariant(_timestampReadSource == ReadSource::kMajorityCommitted);
+    if (!_KVEngine->getSnapshotManager()->getCommittedSnapshot()) {
+        return {ErrorCodes::ReadConcernMajorityNotAvailableYet,
+                "Read concern majority reads are currently not possible."};
+    }
+    return Status::OK();
+}
+
+boost::optional<Timestamp> RecoveryUnit::getPointInTimeReadTimestamp() {
+    if (_timestampReadSource == ReadSource::kUnset ||
+        _timestampReadSource == ReadSource::kNoTimestamp ||
+        _timestampReadSource == ReadSource::kCheckpoint) {
+        return boost::none;
+    }
+
+    // Choosing the read timestamp requires a snapshot.
+    forkIfNeeded();
+    return _readAtTimestamp;
+}
+
+Status RecoveryUnit::setTimestamp(Timestamp timestamp) {
+    invariant(_inUnitOfWork(), toString(_getState()));
+    invariant(_commitTimestamp.isNull(),
+              str::stream() << "Commit timestamp set to " << _commitTimestamp.toString()
+                            << " and trying to set WUOW timestamp to " << timestamp.toString());
+    if (_dirty && !_lastTimestampSet.isNull() && timestamp != _lastTimestampSet) {
+        // Keep the writes made so far apart, so that they become visible at their own timestamp.
+        StringStore base = _earlierTimestampedWrites.empty()
+            ? _mergeBase
+            : _earlierTimestampedWrites.back().tree;
+        _earlierTimestampedWrites.push_back({_lastTimestampSet, std::move(base), _workingCopy});
+    }
+    _lastTimestampSet = timestamp;
+    return Status::OK();
+}
+
+void RecoveryUnit::setCommitTimestamp(Timestamp timestamp) {
+    invariant(!_inUnitOfWork(), toString(_getState()));
+    invariant(_commitTimestamp.isNull(),
+              str::stream() << "Commit timestamp set to " << _commitTimestamp.toString()
+                            << " and trying to set it to " << timestamp.toString());
+    _commitTimestamp = timestamp;
+}
+
+void RecoveryUnit::clearCommitTimestamp() {
+    invariant(!_inUnitOfWork(), toString(_getState()));
+    _commitTimestamp = Timestamp();
+}
+
+Timestamp RecoveryUnit::getCommitTimestamp() const {
+    return _commitTimestamp;
+}
+
+void RecoveryUnit::setTimestampReadSource(ReadSource readSource,
+                                          boost::optional<Timestamp> provided) {
+    invariant(!provided == (readSource != ReadSource::kProvided));
+    invariant(!_forked || _timestampReadSource == readSource,
+              str::stream() << "Current state: " << toString(_getState())
+                            << ". Invalid internal state while setting timestamp read source: "
+                            << static_cast<int>(readSource) << ", provided timestamp: "
+                            << (provided ? provided->toString() : "none"));
+
+    _timestampReadSource = readSource;
+    _providedReadTimestamp = provided ? *provided : Timestamp();
+    _readAtTimestamp = boost::none;
+}
+
+RecoveryUnit::ReadSource RecoveryUnit::getTimestampReadSource() const {
+    return _timestampReadSource;
+}
+
 void RecoveryUnit::setOrderedCommit(bool orderedCommit) {}
 
 void RecoveryUnit::_abort() {
     _forked = false;
     _dirty = false;
+    _lastTimestampSet = Timestamp();
+    _earlierTimestampedWrites.clear();
     _setState(State::kAborting);
     abortRegisteredChanges();
     _setState(State::kInactive);
@@ -55,6 +55,23 @@ public:
 
     virtual void setOrderedCommit(bool orderedCommit) override;
 
+    Status obtainMajorityCommittedSnapshot() override;
+
+    boost::optional<Timestamp> getPointInTimeReadTimestamp() override;
+
+    Status setTimestamp(Timestamp timestamp) override;
+
+    void setCommitTimestamp(Timestamp timestamp) override;
+
+    void clearCommitTimestamp() override;
+
+    Timestamp getCommitTimestamp() const override;
+
+    void setTimestampReadSource(ReadSource source,
+                                boost::optional<Timestamp> provided = boost::none) override;
+
+    ReadSource getTimestampReadSource() const override;
+
     // Biggie specific function declarations below.
     StringStore* getHead() {
         forkIfNeeded();
@@ -82,6 +99,12 @@ private:
 
     void _abort();
 
+    /**
+     * Returns the timestamp the next snapshot should read at according to the read source, or
+     * boost::none to read the latest data.
+     */
+    boost::optional<Timestamp> _chooseReadTimestamp();
+
     std::function<void()> _waitUntilDurableCallback;
     // Official master is kept by KVEngine
     KVEngine* _KVEngine;
@@ -90,6 +113,20 @@ private:
 
     bool _forked = false;
     bool _dirty = false;  // Whether or not we have written to this _workingCopy.
+
+    ReadSource _timestampReadSource = ReadSource::kUnset;
+    // The timestamp the current snapshot reads at, if any.
+    boost::optional<Timestamp> _readAtTimestamp;
+    // Set by setTimestampReadSource() for kProvided.
+    Timestamp _providedReadTimestamp;
+
+    // Set by setCommitTimestamp() and applies to every unit of work until cleared.
+    Timestamp _commitTimestamp;
+    // The timestamp last passed to setTimestamp() in the current unit of work. Writes made since
+    // then, and any made before the first call, become visible at this timestamp.
+    Timestamp _lastTimestampSet;
+    // The writes made at each earlier timestamp of the current unit of work.
+    std::vector<KVEngine::TimestampedWrites> _earlierTimestampedWrites;
 };
 
 }  // namespace biggie
@@ -0,0 +1,71 @@
+/**
+ *    Copyright (C) 2020-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+
+#include "mongo/bson/timestamp.h"
+#include "mongo/db/storage/snapshot_manager.h"
+#include "mongo/platform/mutex.h"
+
+namespace mongo {
+namespace biggie {
+
+/**
+ * Tracks the majority committed and local snapshot timestamps. Reads at these timestamps are
+ * served from the KVEngine's history of committed versions.
+ */
+class SnapshotManager final : public mongo::SnapshotManager {
+    SnapshotManager(const SnapshotManager&) = delete;
+    SnapshotManager& operator=(const SnapshotManager&) = delete;
+
+public:
+    SnapshotManager() = default;
+
+    void setCommittedSnapshot(const Timestamp& timestamp) final;
+    void setLocalSnapshot(const Timestamp& timestamp) final;
+    boost::optional<Timestamp> getLocalSnapshot() final;
+    void dropAllSnapshots() final;
+
+    // Biggie Specific
+
+    /**
+     * Returns the majority committed snapshot, or boost::none if there is currently none.
+     */
+    boost::optional<Timestamp> getCommittedSnapshot() const;
+
+private:
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("biggie::SnapshotManager::_mutex");
+    boost::optional<Timestamp> _committedSnapshot;
+    boost::optional<Timestamp> _localSnapshot;
+};
+
+}  // namespace biggie
+}  // namespace mongo
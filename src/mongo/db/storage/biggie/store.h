@@ -34,6 +34,7 @@
 #include <cstring>
 #include <exception>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <string.h>
 #include <vector>
@@ -641,6 +642,16 @@ public:
         _root->_dataSize = other._root->_dataSize + deltaDataSize;
     }
 
+    /**
+     * Calls 'onChange' with each key whose value differs between 'base' and this tree, along with
+     * a pointer to its value in this tree, or nullptr if this tree does not have the key. Branches
+     * this tree still shares with 'base' are skipped, so the cost follows the size of the changes.
+     */
+    template <typename OnChange>
+    void forEachChangeSince(const RadixStore& base, OnChange&& onChange) const {
+        _diffHelper(_root.get(), base._root.get(), onChange);
+    }
+
     // Iterators
     const_iterator begin() const noexcept {
         if (_root->isLeaf() && !_root->_data)
@@ -1340,6 +1351,67 @@ private:
         }
     }
 
+    /**
+     * Calls 'onElement' with every element in the subtree rooted at 'node'.
+     */
+    template <typename OnElement>
+    static void _forEachInSubtree(const Node* node, OnElement& onElement) {
+        if (node->_data)
+            onElement(*node->_data);
+        for (const auto& child : node->_children) {
+            if (child)
+                _forEachInSubtree(child.get(), onElement);
+        }
+    }
+
+    /**
+     * Reports the differences between the subtrees rooted at 'current' and 'base', either of which
+     * may be null, to 'onChange'.
+     */
+    template <typename OnChange>
+    static void _diffHelper(const Node* current, const Node* base, OnChange& onChange) {
+        if (current == base)
+            return;
+
+        if (current && base && current->_trieKey == base->_trieKey) {
+            if (current->_data != base->_data) {
+                if (current->_data)
+                    onChange(current->_data->first, &current->_data->second);
+                else
+                    onChange(base->_data->first, nullptr);
+            }
+            for (size_t key = 0; key < 256; ++key) {
+                _diffHelper(current->_children[key].get(), base->_children[key].get(), onChange);
+            }
+            return;
+        }
+
+        // The branches are compressed differently, so compare them element by element.
+        std::map<Key, const mapped_type*> baseElements;
+        if (base) {
+            auto collect = [&](const value_type& element) {
+                baseElements.emplace(element.first, &element.second);
+            };
+            _forEachInSubtree(base, collect);
+        }
+        if (current) {
+            auto compare = [&](const value_type& element) {
+                auto it = baseElements.find(element.first);
+                if (it == baseElements.end()) {
+                    onChange(element.first, &element.second);
+                    return;
+                }
+                if (*it->second != element.second)
+                    onChange(element.first, &element.second);
+                baseElements.erase(it);
+            };
+            _forEachInSubtree(current, compare);
+        }
+        for (const auto& [key, value] : baseElements) {
+            onChange(key, nullptr);
+        }
+    }
+
     /**
      * Merges changes from base to other into current. Throws merge_conflict_exception if there are
      * merge conflicts.
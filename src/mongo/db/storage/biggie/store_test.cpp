@@ -29,6 +29,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <map>
+
 #include "mongo/db/storage/biggie/store.h"
 #include "mongo/unittest/unittest.h"
 
@@ -1179,6 +1181,36 @@ TEST_F(RadixStoreTest, DistanceTest) {
     ASSERT_EQ(thisStore.distance(second, end), 3);
 }
 
+TEST_F(RadixStoreTest, ForEachChangeSinceReportsInsertsUpdatesAndDeletes) {
+    baseStore.insert(value_type("foo", "1"));
+    baseStore.insert(value_type("food", "2"));
+    baseStore.insert(value_type("bar", "3"));
+    baseStore.insert(value_type("baz", "4"));
+
+    thisStore = baseStore;
+    thisStore.update(value_type("food", "20"));
+    thisStore.erase("bar");
+    thisStore.insert(value_type("fo", "5"));
+    thisStore.insert(value_type("qux", "6"));
+
+    std::map<std::string, boost::optional<std::string>> changes;
+    thisStore.forEachChangeSince(baseStore, [&](const std::string& key, const std::string* value) {
+        ASSERT(changes.emplace(key, value ? boost::make_optional(*value) : boost::none).second);
+    });
+
+    std::map<std::string, boost::optional<std::string>> expectedChanges{
+        {"bar", boost::none},
+        {"fo", std::string("5")},
+        {"food", std::string("20")},
+        {"qux", std::string("6")}};
+    ASSERT(changes == expectedChanges);
+
+    int calls = 0;
+    baseStore.forEachChangeSince(StringStore(baseStore),
+                                 [&](const std::string&, const std::string*) { ++calls; });
+    ASSERT_EQ(calls, 0);
+}
+
 TEST_F(RadixStoreTest, MergeNoModifications) {
     value_type value1 = std::make_pair("foo", "1");
     value_type value2 = std::make_pair("bar", "2");
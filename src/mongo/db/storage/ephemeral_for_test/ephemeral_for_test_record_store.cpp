@@ -151,6 +151,20 @@ public:
         return {{_it->first, _it->second.toRecordData()}};
     }
 
+    boost::optional<Record> seek(const RecordId& start) final {
+        _lastMoveWasRestore = false;
+        _needFirstSeek = false;
+        _it = _records.lower_bound(start);
+        if (_it == _records.end())
+            return {};
+        return {{_it->first, _it->second.toRecordData()}};
+    }
+
+    // Records are never moved in memory, only replaced or deleted.
+    bool unownedDataValidUntilSave() const final {
+        return true;
+    }
+
     void save() final {
         if (!_needFirstSeek && !_lastMoveWasRestore)
             _savedId = _it == _records.end() ? RecordId() : _it->first;
@@ -224,6 +238,22 @@ public:
         return {{_it->first, _it->second.toRecordData()}};
     }
 
+    boost::optional<Record> seek(const RecordId& start) final {
+        _lastMoveWasRestore = false;
+        _needFirstSeek = false;
+
+        // The reverse_iterator dereferences to the last element <= 'start'.
+        _it = Records::const_reverse_iterator(_records.upper_bound(start));
+        if (_it == _records.rend())
+            return {};
+        return {{_it->first, _it->second.toRecordData()}};
+    }
+
+    // Records are never moved in memory, only replaced or deleted.
+    bool unownedDataValidUntilSave() const final {
+        return true;
+    }
+
     void save() final {
         if (!_needFirstSeek && !_lastMoveWasRestore)
             _savedId = _it == _records.rend() ? RecordId() : _it->first;
@@ -1612,6 +1612,20 @@ TEST_F(KeyStringBuilderTest, VeryLargeString) {
     ROUNDTRIP(version, obj);
 }
 
+TEST_F(KeyStringBuilderTest, StringsWithNulsOfManyLengths) {
+    // Covers the word-at-a-time and byte-at-a-time parts of inverting strings.
+    for (size_t length = 0; length < 40; length++) {
+        std::string str(length, 'x');
+        ROUNDTRIP(version, BSON("" << str));
+        ROUNDTRIP(version, BSON("" << BSONSymbol(str)));
+        for (size_t nul = 0; nul < length; nul += 7) {
+            str[nul] = '\0';
+            ROUNDTRIP(version, BSON("" << str));
+            ROUNDTRIP(version, BSON("" << BSONSymbol(str)));
+        }
+    }
+}
+
 TEST_F(KeyStringBuilderTest, ToBsonSafeShouldNotTerminate) {
     KeyString::TypeBits typeBits(KeyString::Version::V1);
 
@@ -78,7 +78,7 @@ struct Record {
  * destroyed, which is guaranteed not to leak any resources.
  *
  * Any returned unowned BSON is only valid until the next call to any method on this
- * interface.
+ * interface, unless unownedDataValidUntilSave() says otherwise.
  *
  * Implementations may override any default implementation if they can provide a more
  * efficient implementation.
@@ -109,6 +109,16 @@ public:
      */
     virtual boost::optional<Record> next() = 0;
 
+    /**
+     * Returns true if unowned data returned by this cursor stays valid until the cursor is saved or
+     * the record store is modified, rather than only until the next call to a method on this
+     * cursor. Callers which read several records before consuming them can then avoid copying
+     * them.
+     */
+    virtual bool unownedDataValidUntilSave() const {
+        return false;
+    }
+
     //
     // Saving and restoring state
     //
@@ -171,6 +181,22 @@ public:
      */
     virtual boost::optional<Record> seekExact(const RecordId& id) = 0;
 
+    /**
+     * Seeks to the first Record whose id is at or after 'start' in the direction of this cursor,
+     * i.e. the smallest id >= 'start' for a forward cursor and the largest id <= 'start' for a
+     * reverse cursor. Unlike seekExact(), 'start' does not need to exist.
+     *
+     * Returns boost::none and leaves the cursor at EOF if there is no such Record.
+     */
+    virtual boost::optional<Record> seek(const RecordId& start) = 0;
+
+    /**
+     * Hints that the caller will soon call seekExact() on each of 'ids'. Implementations may start
+     * reading them into memory in the background. This never changes the cursor's position and is
+     * legal to call whenever seekExact() is.
+     */
+    virtual void prefetch(const std::vector<RecordId>& ids) {}
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
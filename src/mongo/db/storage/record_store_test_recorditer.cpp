@@ -483,5 +483,113 @@ TEST(RecordStoreTestHarness, SeekExactForMissingRecordReturnsNone) {
     ASSERT_FALSE(recordStore->findRecord(opCtx.get(), recordIds[1], &outputData));
 }
 
+// seek() must position the cursor at the closest record in its direction when the RecordId does
+// not exist, and continue iterating from there.
+TEST(RecordStoreTestHarness, SeekToMissingRecordPositionsAtNextRecord) {
+    const auto harnessHelper{newRecordStoreHarnessHelper()};
+    auto recordStore = harnessHelper->newNonCappedRecordStore();
+    ServiceContext::UniqueOperationContext opCtx{harnessHelper->newOperationContext()};
+
+    // Insert three records and remember their record ids.
+    const int nToInsert = 3;
+    RecordId recordIds[nToInsert];
+    for (int i = 0; i < nToInsert; ++i) {
+        StringBuilder sb;
+        sb << "record " << i;
+        string data = sb.str();
+
+        WriteUnitOfWork uow{opCtx.get()};
+        auto res =
+            recordStore->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, Timestamp{});
+        ASSERT_OK(res.getStatus());
+        recordIds[i] = res.getValue();
+        uow.commit();
+    }
+    std::sort(recordIds, recordIds + nToInsert);
+
+    // Delete the second record.
+    {
+        WriteUnitOfWork uow{opCtx.get()};
+        recordStore->deleteRecord(opCtx.get(), recordIds[1]);
+        uow.commit();
+    }
+
+    // Seeking to an existing record returns it.
+    {
+        auto cursor = recordStore->getCursor(opCtx.get());
+        auto record = cursor->seek(recordIds[0]);
+        ASSERT(record);
+        ASSERT_EQ(recordIds[0], record->id);
+    }
+
+    // Seeking to the deleted record positions a forward cursor on the third record, and a reverse
+    // cursor on the first one.
+    {
+        auto cursor = recordStore->getCursor(opCtx.get(), true);
+        auto record = cursor->seek(recordIds[1]);
+        ASSERT(record);
+        ASSERT_EQ(recordIds[2], record->id);
+        ASSERT(!cursor->next());
+    }
+    {
+        auto cursor = recordStore->getCursor(opCtx.get(), false);
+        auto record = cursor->seek(recordIds[1]);
+        ASSERT(record);
+        ASSERT_EQ(recordIds[0], record->id);
+        ASSERT(!cursor->next());
+    }
+
+    // There are no records past either end.
+    ASSERT(!recordStore->getCursor(opCtx.get(), true)->seek(RecordId::max()));
+    ASSERT(!recordStore->getCursor(opCtx.get(), false)->seek(RecordId::min()));
+}
+
+// Cursors which keep unowned data valid until they are saved must not invalidate the records they
+// returned earlier as they advance, in either direction.
+TEST(RecordStoreTestHarness, UnownedDataValidUntilSave) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 10;
+    std::vector<std::string> datas;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < nToInsert; i++) {
+            stringstream ss;
+            ss << "record " << i;
+            datas.push_back(ss.str());
+            ASSERT_OK(rs->insertRecord(opCtx.get(),
+                                       datas.back().c_str(),
+                                       datas.back().size() + 1,
+                                       Timestamp())
+                          .getStatus());
+        }
+        uow.commit();
+    }
+    std::sort(datas.begin(), datas.end());
+
+    for (bool forward : {true, false}) {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get(), forward);
+        if (!cursor->unownedDataValidUntilSave()) {
+            return;
+        }
+
+        std::vector<Record> records;
+        while (auto record = cursor->next()) {
+            records.push_back(*record);
+        }
+        ASSERT_EQUALS(static_cast<size_t>(nToInsert), records.size());
+
+        std::vector<std::string> found;
+        for (auto&& record : records) {
+            found.push_back(record.data.data());
+        }
+        std::sort(found.begin(), found.end());
+        ASSERT(datas == found);
+    }
+}
+
 }  // namespace
 }  // namespace mongo
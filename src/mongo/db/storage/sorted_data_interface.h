@@ -94,6 +94,23 @@ public:
                           const KeyString::Value& keyString,
                           bool dupsAllowed) = 0;
 
+    /**
+     * Inserts each of 'keyStrings' as insert() would, stopping at the first error. Callers pass
+     * the keys in ascending order so that implementations can insert them with a single pass over
+     * the index.
+     */
+    virtual Status insertBatch(OperationContext* opCtx,
+                               const std::vector<KeyString::Value>& keyStrings,
+                               bool dupsAllowed) {
+        for (const auto& keyString : keyStrings) {
+            Status status = insert(opCtx, keyString, dupsAllowed);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        return Status::OK();
+    }
+
     /**
      * Remove the entry from the index with the specified KeyString, which must have a RecordId
      * appended to the end.
@@ -263,6 +263,29 @@ Status WiredTigerIndex::insert(OperationContext* opCtx,
     return _insert(opCtx, c, keyString, dupsAllowed);
 }
 
+Status WiredTigerIndex::insertBatch(OperationContext* opCtx,
+                                    const std::vector<KeyString::Value>& keyStrings,
+                                    bool dupsAllowed) {
+    dassert(opCtx->lockState()->isWriteLocked());
+
+    // Take a single cursor for the whole batch rather than one per key.
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+
+    for (const auto& keyString : keyStrings) {
+        dassert(
+            KeyString::decodeRecordIdAtEnd(keyString.getBuffer(), keyString.getSize()).isValid());
+        TRACE_INDEX(4765008, "KeyString: {keyString}", "keyString"_attr = keyString);
+
+        Status status = _insert(opCtx, c, keyString, dupsAllowed);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
 void WiredTigerIndex::unindex(OperationContext* opCtx,
                               const KeyString::Value& keyString,
                               bool dupsAllowed) {
@@ -95,6 +95,10 @@ public:
                           const KeyString::Value& keyString,
                           bool dupsAllowed);
 
+    Status insertBatch(OperationContext* opCtx,
+                       const std::vector<KeyString::Value>& keyStrings,
+                       bool dupsAllowed) override;
+
     virtual void unindex(OperationContext* opCtx,
                          const KeyString::Value& keyString,
                          bool dupsAllowed);
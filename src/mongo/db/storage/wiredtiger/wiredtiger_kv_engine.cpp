@@ -87,6 +87,7 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/util/background.h"
 #include "mongo/util/concurrency/idle_thread_block.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/exit.h"
@@ -294,7 +295,22 @@ public:
                 return _flushJournalNow || _shuttingDown;
             });
 
+            // When a writer asked for an immediate flush, give other writers a chance to join the
+            // same flush rather than paying for one flush each. Flushes requested through
+            // triggerJournalFlush() are not delayed.
+            const auto groupCommitDelay =
+                Microseconds(gWiredTigerJournalGroupCommitDelayMicros.load());
+            if (_flushJournalNow && !_flushTriggered && !_shuttingDown &&
+                groupCommitDelay > Microseconds(0)) {
+                const auto groupDeadline = Date_t::now() + groupCommitDelay;
+                _flushJournalNowCV.wait_until(lk, groupDeadline.toSystemTimePoint(), [&] {
+                    return _shuttingDown || _flushTriggered ||
+                        _numWaitersForNextFlush >= gWiredTigerJournalGroupCommitMaxWaiters.load();
+                });
+            }
+
             _flushJournalNow = false;
+            _flushTriggered = false;
 
             if (_shuttingDown) {
                 LOGV2_DEBUG(22306, 1, "stopping {name} thread", "name"_attr = name());
@@ -308,6 +324,7 @@ public:
             // Take the next promise as current and reset the next promise.
             _currentSharedPromise =
                 std::exchange(_nextSharedPromise, std::make_unique<SharedPromise<void>>());
+            _numWaitersForNextFlush = 0;
         }
     }
 
@@ -328,8 +345,10 @@ public:
      */
     void triggerJournalFlush() {
         stdx::lock_guard<Latch> lk(_stateMutex);
-        if (!_flushJournalNow) {
+        if (!_flushTriggered) {
+            // Also ends a group commit wait that is already in progress.
             _flushJournalNow = true;
+            _flushTriggered = true;
             _flushJournalNowCV.notify_one();
         }
     }
@@ -342,7 +361,10 @@ public:
     void waitForJournalFlush() {
         auto myFuture = [&]() {
             stdx::unique_lock<Latch> lk(_stateMutex);
-            if (!_flushJournalNow) {
+            ++_numWaitersForNextFlush;
+            if (!_flushJournalNow ||
+                _numWaitersForNextFlush >= gWiredTigerJournalGroupCommitMaxWaiters.load()) {
+                // Also wake the thread when the group commit batch is full.
                 _flushJournalNow = true;
                 _flushJournalNowCV.notify_one();
             }
@@ -384,6 +406,12 @@ private:
     bool _flushJournalNow = false;
     bool _shuttingDown = false;
 
+    // Set by triggerJournalFlush() so that the next flush skips the group commit delay.
+    bool _flushTriggered = false;
+
+    // Number of waitForJournalFlush() callers waiting on _nextSharedPromise.
+    int _numWaitersForNextFlush = 0;
+
     // New callers get a future from nextSharedPromise. The JournalFlusher thread will swap that to
     // currentSharedPromise at the start of every round of flushing, and reset nextSharedPromise
     // with a new shared promise.
@@ -906,6 +934,17 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
     _sessionSweeper = std::make_unique<WiredTigerSessionSweeper>(_sessionCache.get());
     _sessionSweeper->go();
 
+    // Everything is already in memory for an ephemeral engine, so there is nothing to prefetch.
+    if (!_ephemeral && gWiredTigerPrefetchThreads > 0) {
+        ThreadPool::Options options;
+        options.poolName = "WTPrefetch";
+        options.threadNamePrefix = "WTPrefetch-";
+        options.minThreads = 0;
+        options.maxThreads = gWiredTigerPrefetchThreads;
+        _prefetchPool = std::make_unique<ThreadPool>(options);
+        _prefetchPool->startup();
+    }
+
     // Until the Replication layer installs a real callback, prevent truncating the oplog.
     setOldestActiveTransactionTimestampCallback(
         [](Timestamp) { return StatusWith(boost::make_optional(Timestamp::min())); });
@@ -976,16 +1015,12 @@ void WiredTigerKVEngine::appendGlobalStats(BSONObjBuilder& b) {
     BSONObjBuilder bb(b.subobjStart("concurrentTransactions"));
     {
         BSONObjBuilder bbb(bb.subobjStart("write"));
-        bbb.append("out", openWriteTransaction.used());
-        bbb.append("available", openWriteTransaction.available());
-        bbb.append("totalTickets", openWriteTransaction.outof());
+        openWriteTransaction.appendStats(bbb);
         bbb.done();
     }
     {
         BSONObjBuilder bbb(bb.subobjStart("read"));
-        bbb.append("out", openReadTransaction.used());
-        bbb.append("available", openReadTransaction.available());
-        bbb.append("totalTickets", openReadTransaction.outof());
+        openReadTransaction.appendStats(bbb);
         bbb.done();
     }
     bb.done();
@@ -1067,6 +1102,11 @@ void WiredTigerKVEngine::cleanShutdown() {
     }
 
     // these must be the last things we do before _conn->close();
+    if (_prefetchPool) {
+        LOGV2(4765007, "Shutting down prefetch thread pool");
+        _prefetchPool->shutdown();
+        _prefetchPool->join();
+    }
     if (_sessionSweeper) {
         LOGV2(22318, "Shutting down session sweeper thread");
         _sessionSweeper->shutdown();
@@ -1791,6 +1831,53 @@ std::list<WiredTigerCachedCursor> WiredTigerKVEngine::filterCursorsWithQueuedDro
     return toDrop;
 }
 
+void WiredTigerKVEngine::prefetchRecords(const std::string& uri, std::vector<RecordId> ids) {
+    if (!_prefetchPool || ids.empty()) {
+        return;
+    }
+
+    // Prefetching only helps while it stays ahead of the reader, so shed requests once every
+    // prefetch thread already has a backlog.
+    const int kMaxQueuedRequestsPerThread = 4;
+    if (_prefetchRequestsQueued.fetchAndAdd(1) >=
+        kMaxQueuedRequestsPerThread * gWiredTigerPrefetchThreads) {
+        _prefetchRequestsQueued.fetchAndSubtract(1);
+        return;
+    }
+
+    _prefetchPool->schedule([this, uri, ids = std::move(ids)](Status status) {
+        ON_BLOCK_EXIT([&] { _prefetchRequestsQueued.fetchAndSubtract(1); });
+        if (!status.isOK()) {
+            return;
+        }
+
+        try {
+            UniqueWiredTigerSession session = _sessionCache->getSession();
+            // Leave retrying queued drops to the sessions used by operations.
+            session->dropQueuedIdentsAtSessionEndAllowed(false);
+            WT_CURSOR* cursor = session->getNewCursor(uri, nullptr);
+            ON_BLOCK_EXIT([&] { session->closeCursor(cursor); });
+            for (const auto& id : ids) {
+                // Only reading the record's page into the cache matters, so missing records,
+                // prepare conflicts and rollbacks are all ignored.
+                cursor->set_key(cursor, id.repr());
+                if (cursor->search(cursor) == 0) {
+                    _prefetchedRecords.fetchAndAdd(1);
+                }
+            }
+        } catch (const DBException&) {
+            // The table may have been dropped or be locked by an exclusive operation.
+        }
+    });
+}
+
+long long WiredTigerKVEngine::waitForPrefetchRecords_forTest() {
+    if (_prefetchPool) {
+        _prefetchPool->waitForIdle();
+    }
+    return _prefetchedRecords.load();
+}
+
 bool WiredTigerKVEngine::haveDropsQueued() const {
     Date_t now = _clockSource->now();
     Milliseconds delta = now - _previousCheckedDropsQueued;
@@ -52,6 +52,7 @@ namespace mongo {
 
 class ClockSource;
 class JournalListener;
+class ThreadPool;
 class WiredTigerRecordStore;
 class WiredTigerSessionCache;
 class WiredTigerSizeStorer;
@@ -276,6 +277,20 @@ public:
         std::list<WiredTigerCachedCursor>* cache);
     bool haveDropsQueued() const;
 
+    /**
+     * Asynchronously reads the records with the given ids from the table 'uri' into the WiredTiger
+     * cache, so that a later seekExact() on them is less likely to wait for disk. This is only a
+     * hint: requests are dropped when prefetching is disabled or too far behind, and ids which do
+     * not exist are ignored. Only supported for tables keyed by a plain RecordId.
+     */
+    void prefetchRecords(const std::string& uri, std::vector<RecordId> ids);
+
+    /**
+     * Waits for every prefetchRecords() request scheduled so far to finish and returns the total
+     * number of records they found. For testing only.
+     */
+    long long waitForPrefetchRecords_forTest();
+
     void syncSizeInfo(bool sync) const;
 
     /*
@@ -464,6 +479,13 @@ private:
     std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;  // Depends on _sizeStorer
     std::unique_ptr<WiredTigerCheckpointThread> _checkpointThread;
 
+    // Runs prefetchRecords() requests. Null when prefetching is disabled.
+    std::unique_ptr<ThreadPool> _prefetchPool;
+    // Number of prefetchRecords() requests scheduled on '_prefetchPool' but not yet finished.
+    AtomicWord<int> _prefetchRequestsQueued{0};
+    // Number of records prefetchRecords() requests have found.
+    AtomicWord<long long> _prefetchedRecords{0};
+
     std::string _rsOptions;
     std::string _indexOptions;
 
@@ -43,24 +43,31 @@
 #include "mongo/db/repl/replication_coordinator_mock.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_test_fixture.h"
+#include "mongo/db/storage/journal_listener.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/logger/logger.h"
 #include "mongo/logv2/log.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
 #include "mongo/util/log.h"
 #include "mongo/util/log_global_settings.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 namespace {
 
 class WiredTigerKVHarnessHelper : public KVHarnessHelper, public ScopedGlobalServiceContextForTest {
 public:
-    WiredTigerKVHarnessHelper(bool forRepair = false)
-        : _dbpath("wt-kv-harness"), _forRepair(forRepair) {
+    WiredTigerKVHarnessHelper(bool forRepair = false, bool durable = false)
+        : _dbpath("wt-kv-harness"), _forRepair(forRepair), _durable(durable) {
         invariant(hasGlobalServiceContext());
         _engine.reset(makeEngine());
         repl::ReplicationCoordinator::set(
@@ -91,7 +98,7 @@ private:
                                              "",
                                              1,
                                              0,
-                                             false,
+                                             _durable,
                                              false,
                                              _forRepair,
                                              false);
@@ -104,12 +111,13 @@ private:
     unittest::TempDir _dbpath;
     std::unique_ptr<WiredTigerKVEngine> _engine;
     bool _forRepair;
+    bool _durable;
 };
 
 class WiredTigerKVEngineTest : public unittest::Test, public ScopedGlobalServiceContextForTest {
 public:
-    WiredTigerKVEngineTest(bool repair = false)
-        : _helper(repair), _engine(_helper.getWiredTigerKVEngine()) {}
+    WiredTigerKVEngineTest(bool repair = false, bool durable = false)
+        : _helper(repair, durable), _engine(_helper.getWiredTigerKVEngine()) {}
 
     std::unique_ptr<OperationContext> makeOperationContext() {
         return std::make_unique<OperationContextNoop>(_engine->newRecoveryUnit());
@@ -125,6 +133,82 @@ public:
     WiredTigerKVEngineRepairTest() : WiredTigerKVEngineTest(true /* repair */) {}
 };
 
+class WiredTigerKVEngineDurableTest : public WiredTigerKVEngineTest {
+public:
+    WiredTigerKVEngineDurableTest()
+        : WiredTigerKVEngineTest(false /* repair */, true /* durable */) {}
+};
+
+/**
+ * Counts the journal flushes so tests can tell when the journal flusher has completed a round.
+ */
+class CountingJournalListener : public JournalListener {
+public:
+    Token getToken(OperationContext* opCtx, stdx::unique_lock<Latch>& lk) override {
+        return Token();
+    }
+
+    void onDurable(const Token& token) override {
+        _numFlushes.fetchAndAdd(1);
+    }
+
+    int numFlushes() const {
+        return _numFlushes.load();
+    }
+
+private:
+    AtomicWord<int> _numFlushes{0};
+};
+
+/**
+ * Installs a CountingJournalListener and saves the journal flush settings the tests change,
+ * restoring both on destruction.
+ */
+class JournalFlushTestSettings {
+public:
+    explicit JournalFlushTestSettings(WiredTigerKVEngine* engine)
+        : _engine(engine),
+          _commitIntervalMs(storageGlobalParams.journalCommitIntervalMs.load()),
+          _groupCommitDelayMicros(gWiredTigerJournalGroupCommitDelayMicros.load()),
+          _groupCommitMaxWaiters(gWiredTigerJournalGroupCommitMaxWaiters.load()) {
+        _engine->setJournalListener(&listener);
+    }
+
+    ~JournalFlushTestSettings() {
+        _engine->setJournalListener(&NoOpJournalListener::instance);
+        storageGlobalParams.journalCommitIntervalMs.store(_commitIntervalMs);
+        gWiredTigerJournalGroupCommitDelayMicros.store(_groupCommitDelayMicros);
+        gWiredTigerJournalGroupCommitMaxWaiters.store(_groupCommitMaxWaiters);
+    }
+
+    CountingJournalListener listener;
+
+private:
+    WiredTigerKVEngine* _engine;
+    const int _commitIntervalMs;
+    const int32_t _groupCommitDelayMicros;
+    const int32_t _groupCommitMaxWaiters;
+};
+
+// Long enough that a test waiting on it would time out, so completing early proves it was skipped.
+const Seconds kLongGroupCommitDelay{10};
+const Seconds kFlushTimeout{5};
+
+// Keeps the flusher from flushing on its own schedule for the duration of a test.
+const Seconds kIdleCommitInterval{60};
+
+/**
+ * Makes the flusher idle until asked to flush, and returns once it has finished any round that
+ * was in progress.
+ */
+void quiesceJournalFlusher(WiredTigerKVEngine* engine) {
+    storageGlobalParams.journalCommitIntervalMs.store(
+        durationCount<Milliseconds>(kIdleCommitInterval));
+    gWiredTigerJournalGroupCommitDelayMicros.store(0);
+    auto opCtx = std::make_unique<OperationContextNoop>(engine->newRecoveryUnit());
+    engine->waitForJournalFlush(opCtx.get());
+}
+
 TEST_F(WiredTigerKVEngineRepairTest, OrphanedDataFilesCanBeRecovered) {
     auto opCtxPtr = makeOperationContext();
 
@@ -343,5 +427,114 @@ MONGO_INITIALIZER(RegisterKVHarnessFactory)(InitializerContext*) {
     return Status::OK();
 }
 
+TEST_F(WiredTigerKVEngineTest, PrefetchRecordsReadsExistingRecords) {
+    auto opCtxPtr = makeOperationContext();
+
+    NamespaceString nss("a.b");
+    std::string ident = "collection-prefetch";
+    CollectionOptions defaultCollectionOptions;
+    ASSERT_OK(
+        _engine->createRecordStore(opCtxPtr.get(), nss.ns(), ident, defaultCollectionOptions));
+    auto rs = _engine->getRecordStore(opCtxPtr.get(), nss.ns(), ident, defaultCollectionOptions);
+    ASSERT(rs);
+
+    std::vector<RecordId> ids;
+    {
+        WriteUnitOfWork uow(opCtxPtr.get());
+        for (int i = 0; i < 3; ++i) {
+            std::string record = str::stream() << "record" << i;
+            auto res =
+                rs->insertRecord(opCtxPtr.get(), record.c_str(), record.length() + 1, Timestamp());
+            ASSERT_OK(res.getStatus());
+            ids.push_back(res.getValue());
+        }
+        uow.commit();
+    }
+
+    // Ids which do not exist are skipped.
+    ids.push_back(RecordId(1000 * 1000));
+    auto cursor = rs->getCursor(opCtxPtr.get());
+    cursor->prefetch(ids);
+    ASSERT_EQ(3, _engine->waitForPrefetchRecords_forTest());
+
+    // Prefetching does not move the cursor.
+    auto record = cursor->seekExact(ids[1]);
+    ASSERT(record);
+    ASSERT_EQ(std::string("record1"), record->data.data());
+}
+
+// A table which does not exist makes opening the prefetch cursor fail with ENOENT.
+TEST_F(WiredTigerKVEngineTest, PrefetchRecordsIgnoresMissingTable) {
+    _engine->prefetchRecords("table:collection-missing", {RecordId(1), RecordId(2)});
+    ASSERT_EQ(0, _engine->waitForPrefetchRecords_forTest());
+}
+
+// A table locked by a bulk load makes opening the prefetch cursor fail with EBUSY.
+TEST_F(WiredTigerKVEngineTest, PrefetchRecordsIgnoresBusyTable) {
+    auto opCtxPtr = makeOperationContext();
+
+    NamespaceString nss("a.b");
+    std::string ident = "collection-prefetch-busy";
+    CollectionOptions defaultCollectionOptions;
+    ASSERT_OK(
+        _engine->createRecordStore(opCtxPtr.get(), nss.ns(), ident, defaultCollectionOptions));
+    // Nothing else may have the table open for the bulk cursor to lock it.
+    const std::string uri = "table:" + ident;
+
+    WT_CONNECTION* conn = _engine->getConnection();
+    WT_SESSION* session;
+    invariantWTOK(conn->open_session(conn, nullptr, nullptr, &session));
+    ON_BLOCK_EXIT([&] { invariantWTOK(session->close(session, nullptr)); });
+    WT_CURSOR* bulkCursor;
+    invariantWTOK(session->open_cursor(session, uri.c_str(), nullptr, "bulk", &bulkCursor));
+
+    _engine->prefetchRecords(uri, {RecordId(1), RecordId(2)});
+    ASSERT_EQ(0, _engine->waitForPrefetchRecords_forTest());
+    invariantWTOK(bulkCursor->close(bulkCursor));
+}
+
+TEST_F(WiredTigerKVEngineDurableTest, GroupCommitEndsOnceMaxWaitersAreWaiting) {
+    JournalFlushTestSettings settings(_engine);
+    quiesceJournalFlusher(_engine);
+
+    gWiredTigerJournalGroupCommitDelayMicros.store(
+        durationCount<Microseconds>(kLongGroupCommitDelay));
+    gWiredTigerJournalGroupCommitMaxWaiters.store(2);
+    const int flushesBefore = settings.listener.numFlushes();
+
+    const auto start = Date_t::now();
+    auto waitForFlush = [&] {
+        auto opCtx = makeOperationContext();
+        _engine->waitForJournalFlush(opCtx.get());
+    };
+    stdx::thread first(waitForFlush);
+    stdx::thread second(waitForFlush);
+    first.join();
+    second.join();
+
+    // The second waiter fills the group, so the flush does not wait out the delay.
+    ASSERT_LT(Date_t::now() - start, kFlushTimeout);
+    ASSERT_GT(settings.listener.numFlushes(), flushesBefore);
+}
+
+TEST_F(WiredTigerKVEngineDurableTest, TriggeredJournalFlushIsNotDelayed) {
+    JournalFlushTestSettings settings(_engine);
+    quiesceJournalFlusher(_engine);
+
+    // Only the trigger can start the next flush before the test times out.
+    gWiredTigerJournalGroupCommitDelayMicros.store(
+        durationCount<Microseconds>(kLongGroupCommitDelay));
+    gWiredTigerJournalGroupCommitMaxWaiters.store(1000);
+    const int flushesBefore = settings.listener.numFlushes();
+
+    _engine->triggerJournalFlush();
+
+    const auto deadline = Date_t::now() + kFlushTimeout;
+    while (settings.listener.numFlushes() == flushesBefore && Date_t::now() < deadline) {
+        sleepmillis(10);
+    }
+    ASSERT_GT(settings.listener.numFlushes(), flushesBefore);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -2117,6 +2117,55 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordI
     return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
 }
 
+void WiredTigerRecordStoreCursorBase::prefetchFromTable(const std::vector<RecordId>& ids) {
+    if (_rs._kvEngine) {
+        _rs._kvEngine->prefetchRecords(_rs.getURI(), ids);
+    }
+}
+
+boost::optional<Record> WiredTigerRecordStoreCursorBase::seek(const RecordId& start) {
+    invariant(_hasRestored);
+    _skipNextAdvance = false;
+    WT_CURSOR* c = _cursor->get();
+    setKey(c, start);
+
+    int cmp;
+    // Nothing after the next line can throw WCEs.
+    int seekRet = wiredTigerPrepareConflictRetry(_opCtx, [&] { return c->search_near(c, &cmp); });
+    if (seekRet != WT_NOTFOUND && (_forward ? cmp < 0 : cmp > 0)) {
+        // 'WT_CURSOR::search_near' landed on the neighbor of 'start' which comes before it in the
+        // direction of this cursor, so step past it.
+        seekRet = wiredTigerPrepareConflictRetry(
+            _opCtx, [&] { return _forward ? c->next(c) : c->prev(c); });
+    }
+    if (seekRet == WT_NOTFOUND) {
+        _eof = true;
+        return {};
+    }
+    invariantWTOK(seekRet);
+
+    RecordId id;
+    if (hasWrongPrefix(c, &id)) {
+        _eof = true;
+        return {};
+    }
+    if (!id.isValid()) {
+        id = getKey(c);
+    }
+
+    if (_oplogVisibleTs && id.repr() > *_oplogVisibleTs) {
+        _eof = true;
+        return {};
+    }
+
+    WT_ITEM value;
+    invariantWTOK(c->get_value(c, &value));
+
+    _lastReturnedId = id;
+    _eof = false;
+    return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+}
+
 
 void WiredTigerRecordStoreCursorBase::save() {
     try {
@@ -2251,6 +2300,10 @@ WiredTigerRecordStoreStandardCursor::WiredTigerRecordStoreStandardCursor(
     OperationContext* opCtx, const WiredTigerRecordStore& rs, bool forward)
     : WiredTigerRecordStoreCursorBase(opCtx, rs, forward) {}
 
+void WiredTigerRecordStoreStandardCursor::prefetch(const std::vector<RecordId>& ids) {
+    prefetchFromTable(ids);
+}
+
 void WiredTigerRecordStoreStandardCursor::setKey(WT_CURSOR* cursor, RecordId id) const {
     cursor->set_key(cursor, id.repr());
 }
@@ -445,6 +445,8 @@ public:
 
     boost::optional<Record> seekExact(const RecordId& id);
 
+    boost::optional<Record> seek(const RecordId& start);
+
     void save();
 
     void saveUnpositioned();
@@ -474,6 +476,12 @@ protected:
      */
     virtual void initCursorToBeginning() = 0;
 
+    /**
+     * Asks the storage engine to prefetch 'ids' from this record store's table. Only valid for
+     * tables keyed by a plain RecordId.
+     */
+    void prefetchFromTable(const std::vector<RecordId>& ids);
+
     const WiredTigerRecordStore& _rs;
     OperationContext* _opCtx;
     const bool _forward;
@@ -500,6 +508,8 @@ public:
                                         const WiredTigerRecordStore& rs,
                                         bool forward = true);
 
+    void prefetch(const std::vector<RecordId>& ids) override;
+
 protected:
     virtual RecordId getKey(WT_CURSOR* cursor) const override;
 
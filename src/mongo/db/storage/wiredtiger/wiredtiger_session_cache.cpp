@@ -33,6 +33,8 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
+#include <algorithm>
+#include <iterator>
 #include <memory>
 
 #include "mongo/base/error_codes.h"
@@ -119,13 +121,13 @@ WT_CURSOR* WiredTigerSession::getCachedCursor(const std::string& uri,
                                               uint64_t id,
                                               const char* config) {
     // Find the most recently used cursor
-    for (CursorCache::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-        if (i->_id == id) {
-            WT_CURSOR* c = i->_cursor;
-            _cursors.erase(i);
-            _cursorsOut++;
-            return c;
-        }
+    auto indexIt = _cursorIndex.find(id);
+    if (indexIt != _cursorIndex.end()) {
+        invariant(!indexIt->second.empty());
+        WT_CURSOR* c = indexIt->second.back()->_cursor;
+        _eraseCachedCursor(indexIt->second.back());
+        _cursorsOut++;
+        return c;
     }
 
     WT_CURSOR* cursor = nullptr;
@@ -150,13 +152,14 @@ void WiredTigerSession::releaseCursor(uint64_t id, WT_CURSOR* cursor) {
 
     // Cursors are pushed to the front of the list and removed from the back
     _cursors.push_front(WiredTigerCachedCursor(id, _cursorGen++, cursor));
+    _cursorIndex[id].push_back(_cursors.begin());
 
     // A negative value for wiredTigercursorCacheSize means to use hybrid caching.
     std::uint32_t cacheSize = abs(gWiredTigerCursorCacheSize.load());
 
     while (!_cursors.empty() && _cursorGen - _cursors.back()._gen > cacheSize) {
         cursor = _cursors.back()._cursor;
-        _cursors.pop_back();
+        _eraseCachedCursor(std::prev(_cursors.end()));
         invariantWTOK(cursor->close(cursor));
     }
 }
@@ -177,7 +180,7 @@ void WiredTigerSession::closeAllCursors(const std::string& uri) {
         WT_CURSOR* cursor = i->_cursor;
         if (cursor && (all || uri == cursor->uri)) {
             invariantWTOK(cursor->close(cursor));
-            i = _cursors.erase(i);
+            _eraseCachedCursor(i++);
         } else
             ++i;
     }
@@ -188,6 +191,9 @@ void WiredTigerSession::closeCursorsForQueuedDrops(WiredTigerKVEngine* engine) {
 
     _cursorEpoch = _cache->getCursorEpoch();
     auto toDrop = engine->filterCursorsWithQueuedDrops(&_cursors);
+    if (!toDrop.empty()) {
+        _rebuildCursorIndex();
+    }
 
     for (auto i = toDrop.begin(); i != toDrop.end(); i++) {
         WT_CURSOR* cursor = i->_cursor;
@@ -197,6 +203,26 @@ void WiredTigerSession::closeCursorsForQueuedDrops(WiredTigerKVEngine* engine) {
     }
 }
 
+void WiredTigerSession::_eraseCachedCursor(CursorCache::iterator it) {
+    auto indexIt = _cursorIndex.find(it->_id);
+    invariant(indexIt != _cursorIndex.end());
+    auto& entries = indexIt->second;
+    entries.erase(std::find(entries.begin(), entries.end(), it));
+    if (entries.empty()) {
+        _cursorIndex.erase(indexIt);
+    }
+    _cursors.erase(it);
+}
+
+void WiredTigerSession::_rebuildCursorIndex() {
+    _cursorIndex.clear();
+    // Walk from the back so that each id's entries are ordered from least to most recent.
+    for (auto it = _cursors.end(); it != _cursors.begin();) {
+        --it;
+        _cursorIndex[it->_id].push_back(it);
+    }
+}
+
 namespace {
 AtomicWord<unsigned long long> nextTableId(WiredTigerSession::kLastTableId);
 }
@@ -364,10 +390,28 @@ void WiredTigerSessionCache::notifyPreparedUnitOfWorkHasCommittedOrAborted() {
 }
 
 
+WiredTigerSessionCache::SessionPool& WiredTigerSessionCache::_getLocalPool() {
+    // Threads are assigned to pools round-robin the first time they use any session cache.
+    static AtomicWord<unsigned> nextPool{0};
+    thread_local const size_t poolIndex = nextPool.fetchAndAdd(1) % kNumSessionPools;
+    return _sessionPools[poolIndex];
+}
+
+std::vector<stdx::unique_lock<Latch>> WiredTigerSessionCache::_lockAllPools() {
+    std::vector<stdx::unique_lock<Latch>> locks;
+    locks.reserve(kNumSessionPools);
+    for (auto& pool : _sessionPools) {
+        locks.emplace_back(pool.mutex);
+    }
+    return locks;
+}
+
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
-    stdx::lock_guard<Latch> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors(uri);
+    for (auto& pool : _sessionPools) {
+        stdx::lock_guard<Latch> lock(pool.mutex);
+        for (SessionCache::iterator i = pool.sessions.begin(); i != pool.sessions.end(); i++) {
+            (*i)->closeAllCursors(uri);
+        }
     }
 }
 
@@ -375,15 +419,21 @@ void WiredTigerSessionCache::closeCursorsForQueuedDrops() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<Latch> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeCursorsForQueuedDrops(_engine);
+    for (auto& pool : _sessionPools) {
+        stdx::lock_guard<Latch> lock(pool.mutex);
+        for (SessionCache::iterator i = pool.sessions.begin(); i != pool.sessions.end(); i++) {
+            (*i)->closeCursorsForQueuedDrops(_engine);
+        }
     }
 }
 
 size_t WiredTigerSessionCache::getIdleSessionsCount() {
-    stdx::lock_guard<Latch> lock(_cacheLock);
-    return _sessions.size();
+    size_t count = 0;
+    for (auto& pool : _sessionPools) {
+        stdx::lock_guard<Latch> lock(pool.mutex);
+        count += pool.sessions.size();
+    }
+    return count;
 }
 
 void WiredTigerSessionCache::closeExpiredIdleSessions(int64_t idleTimeMillis) {
@@ -393,14 +443,14 @@ void WiredTigerSessionCache::closeExpiredIdleSessions(int64_t idleTimeMillis) {
     }
 
     auto cutoffTime = _clockSource->now() - Milliseconds(idleTimeMillis);
-    {
-        stdx::lock_guard<Latch> lock(_cacheLock);
+    for (auto& pool : _sessionPools) {
+        stdx::lock_guard<Latch> lock(pool.mutex);
         // Discard all sessions that became idle before the cutoff time
-        for (auto it = _sessions.begin(); it != _sessions.end();) {
+        for (auto it = pool.sessions.begin(); it != pool.sessions.end();) {
             auto session = *it;
             invariant(session->getIdleExpireTime() != Date_t::min());
             if (session->getIdleExpireTime() < cutoffTime) {
-                it = _sessions.erase(it);
+                it = pool.sessions.erase(it);
                 delete (session);
             } else {
                 ++it;
@@ -414,9 +464,12 @@ void WiredTigerSessionCache::closeAll() {
     SessionCache swap;
 
     {
-        stdx::lock_guard<Latch> lock(_cacheLock);
+        auto locks = _lockAllPools();
         _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
+        for (auto& pool : _sessionPools) {
+            swap.insert(swap.end(), pool.sessions.begin(), pool.sessions.end());
+            pool.sessions.clear();
+        }
     }
 
     for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
@@ -433,13 +486,17 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
-    {
-        stdx::lock_guard<Latch> lock(_cacheLock);
-        if (!_sessions.empty()) {
+    // Look in this thread's pool first, then in the others before opening a new session.
+    SessionPool& localPool = _getLocalPool();
+    const size_t localIndex = &localPool - _sessionPools.data();
+    for (size_t i = 0; i < kNumSessionPools; ++i) {
+        SessionPool& pool = _sessionPools[(localIndex + i) % kNumSessionPools];
+        stdx::lock_guard<Latch> lock(pool.mutex);
+        if (!pool.sessions.empty()) {
             // Get the most recently used session so that if we discard sessions, we're
             // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
+            WiredTigerSession* cachedSession = pool.sessions.back();
+            pool.sessions.pop_back();
             // Reset the idle time
             cachedSession->setIdleExpireTime(Date_t::min());
             return UniqueWiredTigerSession(cachedSession);
@@ -501,10 +558,11 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     session->setIdleExpireTime(_clockSource->now());
 
     if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<Latch> lock(_cacheLock);
+        SessionPool& pool = _getLocalPool();
+        stdx::lock_guard<Latch> lock(pool.mutex);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true;
-            _sessions.push_back(session);
+            pool.sessions.push_back(session);
         }
     } else
         invariant(session->_getEpoch() < currentEpoch);
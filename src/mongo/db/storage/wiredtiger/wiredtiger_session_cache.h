@@ -29,8 +29,10 @@
 
 #pragma once
 
+#include <array>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <wiredtiger.h>
 
@@ -38,6 +40,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
@@ -180,6 +183,19 @@ private:
     // The cursor cache is a list of pairs that contain an ID and cursor
     typedef std::list<WiredTigerCachedCursor> CursorCache;
 
+    // Maps a table id to its cached cursors, ordered from least to most recently released.
+    typedef stdx::unordered_map<uint64_t, std::vector<CursorCache::iterator>> CursorIndex;
+
+    /**
+     * Removes a cursor from both the cursor cache and the table id index, without closing it.
+     */
+    void _eraseCachedCursor(CursorCache::iterator it);
+
+    /**
+     * Rebuilds the table id index after cursors were removed from the cursor cache directly.
+     */
+    void _rebuildCursorIndex();
+
     // Used internally by WiredTigerSessionCache
     uint64_t _getEpoch() const {
         return _epoch;
@@ -195,6 +211,7 @@ private:
     WiredTigerSessionCache* _cache;  // not owned
     WT_SESSION* _session;            // owned
     CursorCache _cursors;            // owned
+    CursorIndex _cursorIndex;        // iterators into _cursors
     uint64_t _cursorGen;
     int _cursorsOut;
     bool _dropQueuedIdentsAtSessionEnd = true;
@@ -372,9 +389,27 @@ private:
     AtomicWord<unsigned> _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    Mutex _cacheLock = MONGO_MAKE_LATCH("WiredTigerSessionCache::_cacheLock");
     typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+
+    // Idle sessions are spread over several independently locked pools so that threads acquiring
+    // and releasing sessions concurrently rarely contend on the same mutex. A thread releases
+    // sessions into its own pool and only looks in the other pools when its own is empty.
+    struct SessionPool {
+        Mutex mutex = MONGO_MAKE_LATCH("WiredTigerSessionCache::SessionPool::mutex");
+        SessionCache sessions;
+    };
+    static constexpr size_t kNumSessionPools = 16;
+    std::array<SessionPool, kNumSessionPools> _sessionPools;
+
+    /**
+     * Returns the pool the calling thread releases sessions into and looks in first.
+     */
+    SessionPool& _getLocalPool();
+
+    /**
+     * Locks every session pool in order, e.g. to change the epoch consistently with releaseSession.
+     */
+    std::vector<stdx::unique_lock<Latch>> _lockAllPools();
 
     // Bumped when all open sessions need to be closed
     AtomicWord<unsigned long long> _epoch;  // atomic so we can check it outside of the lock
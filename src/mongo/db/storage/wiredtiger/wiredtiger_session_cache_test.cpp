@@ -35,6 +35,7 @@
 #include "mongo/base/string_data.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/system_clock_source.h"
@@ -113,4 +114,52 @@ TEST(WiredTigerSessionCacheTest, CheckSessionCacheCleanup) {
     ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
 }
 
+TEST(WiredTigerSessionCacheTest, ReusesSessionReleasedOnAnotherThread) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+
+    WiredTigerSession* released = nullptr;
+    stdx::thread([&] {
+        UniqueWiredTigerSession session = sessionCache->getSession();
+        released = session.get();
+    }).join();
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 1U);
+
+    // The session was released into another thread's pool, but is still found before a new
+    // session is opened.
+    UniqueWiredTigerSession session = sessionCache->getSession();
+    ASSERT_EQUALS(session.get(), released);
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
+}
+
+TEST(WiredTigerSessionCacheTest, CachedCursorsAreFoundByTableId) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    UniqueWiredTigerSession session = harnessHelper.getSessionCache()->getSession();
+    WT_SESSION* wtSession = session->getSession();
+    ASSERT_OK(wtRCToStatus(wtSession->create(wtSession, "table:a", "key_format=q,value_format=q")));
+    ASSERT_OK(wtRCToStatus(wtSession->create(wtSession, "table:b", "key_format=q,value_format=q")));
+    const uint64_t idA = WiredTigerSession::genTableId();
+    const uint64_t idB = WiredTigerSession::genTableId();
+
+    WT_CURSOR* a1 = session->getCachedCursor("table:a", idA, nullptr);
+    WT_CURSOR* a2 = session->getCachedCursor("table:a", idA, nullptr);
+    WT_CURSOR* b = session->getCachedCursor("table:b", idB, nullptr);
+    session->releaseCursor(idA, a1);
+    session->releaseCursor(idB, b);
+    session->releaseCursor(idA, a2);
+    ASSERT_EQUALS(session->cachedCursors(), 3);
+    ASSERT_EQUALS(session->cursorsOut(), 0);
+
+    // The most recently released cursor for a table is handed out first.
+    ASSERT_EQUALS(session->getCachedCursor("table:a", idA, nullptr), a2);
+    ASSERT_EQUALS(session->getCachedCursor("table:b", idB, nullptr), b);
+    session->releaseCursor(idA, a2);
+    session->releaseCursor(idB, b);
+
+    session->closeAllCursors("table:a");
+    ASSERT_EQUALS(session->cachedCursors(), 1);
+    ASSERT_EQUALS(session->getCachedCursor("table:b", idB, nullptr), b);
+    session->releaseCursor(idB, b);
+}
+
 }  // namespace mongo
@@ -44,14 +44,20 @@
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_local_exchange.h"
+#include "mongo/db/pipeline/document_source_parallel_collection_scan.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/pipeline/pipeline_d.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/mock_yield_policies.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/stage_builder.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/util/fail_point.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -450,5 +456,252 @@ TEST_F(DocumentSourceCursorTest, NormalCursorShouldErrorAfterBeingKilled) {
     ASSERT_THROWS_CODE(cursor->getNext().isEOF(), AssertionException, ErrorCodes::QueryPlanKilled);
 }
 
+/**
+ * Test fixture for aggregations which the planner rewrites to read the collection from several
+ * worker threads.
+ */
+class ParallelAggregationTest : public unittest::Test {
+public:
+    // Enough documents for two workers to be worth it.
+    static constexpr int kNumDocuments = 20 * 1000;
+
+    // The number of distinct values of the field 'a'.
+    static constexpr int kNumGroups = 10;
+
+    ParallelAggregationTest() {
+        DBDirectClient client(opCtx());
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < kNumDocuments; ++i) {
+            docs.push_back(BSON("_id" << i << "a" << i % kNumGroups << "b" << (i / kNumGroups) % 2
+                                      << "zero" << 0));
+        }
+        client.insert(nss.ns(), docs);
+    }
+
+    virtual ~ParallelAggregationTest() {
+        internalQueryParallelCollectionScanWorkers.store(_originalScanWorkers);
+        internalQueryLocalExchangeConsumers.store(_originalExchangeConsumers);
+        DBDirectClient client(opCtx());
+        client.dropCollection(nss.ns());
+    }
+
+protected:
+    OperationContext* opCtx() {
+        return _opCtx.get();
+    }
+
+    /**
+     * Parses 'stages' and lets the planner attach the sources reading the collection, as for an
+     * aggregate command.
+     */
+    std::unique_ptr<Pipeline, PipelineDeleter> makePipeline(const std::vector<BSONObj>& stages) {
+        intrusive_ptr<ExpressionContextForTest> expCtx =
+            new ExpressionContextForTest(opCtx(), AggregationRequest(nss, {}));
+        expCtx->tempDir = storageGlobalParams.dbpath + "/_tmp";
+        auto pipeline = Pipeline::parse(stages, expCtx);
+        pipeline->optimizePipeline();
+
+        AutoGetCollectionForRead autoColl(opCtx(), nss);
+        PipelineD::buildAndAttachInnerQueryExecutorToPipeline(
+            autoColl.getCollection(), nss, nullptr, pipeline.get());
+        return pipeline;
+    }
+
+    /**
+     * Returns a pipeline which groups the documents by 'groupBy' and counts each group.
+     */
+    std::unique_ptr<Pipeline, PipelineDeleter> makeCountPipeline(StringData groupBy) {
+        return makePipeline({BSON("$match" << BSON("a" << BSON("$gte" << 0))),
+                             BSON("$group" << BSON("_id" << groupBy << "n"
+                                                         << BSON("$sum" << 1)))});
+    }
+
+    static bool isParallelCollectionScan(const Pipeline* pipeline) {
+        return dynamic_cast<DocumentSourceParallelCollectionScan*>(
+            pipeline->getSources().front().get());
+    }
+
+    static bool isLocalExchange(const Pipeline* pipeline) {
+        return dynamic_cast<DocumentSourceLocalExchange*>(pipeline->getSources().front().get());
+    }
+
+    /**
+     * Returns all of the results of 'pipeline', sorted by _id.
+     */
+    static std::vector<Document> getAllResults(Pipeline* pipeline) {
+        std::vector<Document> results;
+        while (auto next = pipeline->getNext()) {
+            results.push_back(*next);
+        }
+        std::sort(results.begin(), results.end(), [](const Document& lhs, const Document& rhs) {
+            return ValueComparator().evaluate(lhs["_id"] < rhs["_id"]);
+        });
+        return results;
+    }
+
+    ServiceContext::UniqueOperationContext _opCtx = cc().makeOperationContext();
+
+private:
+    const int _originalScanWorkers = internalQueryParallelCollectionScanWorkers.load();
+    const int _originalExchangeConsumers = internalQueryLocalExchangeConsumers.load();
+};
+
+TEST_F(ParallelAggregationTest, GroupIsNotRewrittenWhenParallelScansAreOff) {
+    internalQueryParallelCollectionScanWorkers.store(0);
+    auto pipeline = makeCountPipeline("$a");
+    ASSERT_FALSE(isParallelCollectionScan(pipeline.get()));
+}
+
+TEST_F(ParallelAggregationTest, GroupIsNotRewrittenWhenMatchMayUseAnIndex) {
+    internalQueryParallelCollectionScanWorkers.store(2);
+    ASSERT_OK(dbtests::createIndex(opCtx(), nss.ns(), BSON("a" << 1)));
+    auto pipeline = makeCountPipeline("$a");
+    ASSERT_FALSE(isParallelCollectionScan(pipeline.get()));
+}
+
+TEST_F(ParallelAggregationTest, ParallelCollectionScanMergesPartialGroups) {
+    internalQueryParallelCollectionScanWorkers.store(2);
+    auto pipeline = makeCountPipeline("$a");
+
+    // The prefix up to the $group runs on the workers, which return partial groups merged by the
+    // $group that follows.
+    const auto& sources = pipeline->getSources();
+    ASSERT_EQ(sources.size(), 2UL);
+    ASSERT(isParallelCollectionScan(pipeline.get()));
+    ASSERT(dynamic_cast<DocumentSourceGroup*>(std::next(sources.begin())->get()));
+
+    auto results = getAllResults(pipeline.get());
+    ASSERT_EQ(results.size(), size_t(kNumGroups));
+    for (int i = 0; i < kNumGroups; ++i) {
+        ASSERT_DOCUMENT_EQ(results[i], (Document{{"_id", i}, {"n", kNumDocuments / kNumGroups}}));
+    }
+}
+
+TEST_F(ParallelAggregationTest, DisposeBeforeExhaustingParallelCollectionScanStopsWorkers) {
+    internalQueryParallelCollectionScanWorkers.store(2);
+
+    // Grouping by _id makes the workers produce more partial groups than they may buffer, so they
+    // are still running when the pipeline is disposed of. The merging $group would consume all of
+    // them, so the parallel scan is read directly.
+    auto pipeline = makeCountPipeline("$_id");
+    ASSERT(isParallelCollectionScan(pipeline.get()));
+    ASSERT(pipeline->getSources().front()->getNext().isAdvanced());
+    pipeline->dispose(opCtx());
+
+    // The workers no longer hold any lock on the collection.
+    AutoGetCollection autoColl(opCtx(), nss, MODE_X);
+}
+
+TEST_F(ParallelAggregationTest, ParallelCollectionScanReturnsWorkerErrors) {
+    internalQueryParallelCollectionScanWorkers.store(2);
+    auto pipeline = makePipeline({BSON(
+        "$group" << BSON("_id"
+                         << "$a"
+                         << "n" << BSON("$sum" << BSON("$divide" << BSON_ARRAY(1 << "$zero")))))});
+    ASSERT(isParallelCollectionScan(pipeline.get()));
+
+    // Dividing by zero fails on the workers, which compute the partial sums.
+    ASSERT_THROWS_CODE(pipeline->getNext(), AssertionException, 16608);
+    pipeline->dispose(opCtx());
+}
+
+TEST_F(ParallelAggregationTest, KillingAggregationWithParallelCollectionScanStopsWorkers) {
+    internalQueryParallelCollectionScanWorkers.store(2);
+    auto pipeline = makeCountPipeline("$a");
+    ASSERT(isParallelCollectionScan(pipeline.get()));
+
+    {
+        // The workers hang before they read any document, so the aggregation waits for them until
+        // it is killed.
+        FailPointEnableBlock failPoint("hangBeforeDocumentSourceCursorLoadBatch");
+        {
+            stdx::lock_guard<Client> lk(*opCtx()->getClient());
+            getGlobalServiceContext()->killOperation(lk, opCtx(), ErrorCodes::Interrupted);
+        }
+        ASSERT_THROWS_CODE(pipeline->getNext(), AssertionException, ErrorCodes::Interrupted);
+    }
+    pipeline->dispose(opCtx());
+    pipeline.reset();
+
+    // The fixture cleans up with an operation which is not killed.
+    _opCtx.reset();
+    _opCtx = cc().makeOperationContext();
+}
+
+TEST_F(ParallelAggregationTest, GroupIsNotRewrittenWhenLocalExchangesAreOff) {
+    internalQueryLocalExchangeConsumers.store(0);
+    auto pipeline = makeCountPipeline("$a");
+    ASSERT_FALSE(isLocalExchange(pipeline.get()));
+}
+
+TEST_F(ParallelAggregationTest, GroupWithoutFieldPathKeyIsNotRewrittenToLocalExchange) {
+    internalQueryLocalExchangeConsumers.store(2);
+    auto pipeline = makePipeline(
+        {BSON("$group" << BSON("_id" << BSON("$mod" << BSON_ARRAY("$_id" << 2)) << "n"
+                                     << BSON("$sum" << 1)))});
+    ASSERT_FALSE(isLocalExchange(pipeline.get()));
+}
+
+TEST_F(ParallelAggregationTest, LocalExchangeComputesEachGroupOnce) {
+    internalQueryLocalExchangeConsumers.store(2);
+
+    // The exchange distributes documents by the hash of 'a', so every consumer computes complete
+    // groups for the values of 'a' it receives.
+    auto pipeline = makePipeline({BSON("$group" << BSON("_id" << BSON("a"
+                                                                      << "$a"
+                                                                      << "b"
+                                                                      << "$b")
+                                                              << "n" << BSON("$sum" << 1)))});
+    ASSERT(isLocalExchange(pipeline.get()));
+    ASSERT_EQ(pipeline->getSources().size(), 1UL);
+
+    auto results = getAllResults(pipeline.get());
+    ASSERT_EQ(results.size(), size_t(2 * kNumGroups));
+    for (int i = 0; i < kNumGroups; ++i) {
+        for (int b : {0, 1}) {
+            ASSERT_DOCUMENT_EQ(results[2 * i + b],
+                               (Document{{"_id", Document{{"a", i}, {"b", b}}},
+                                         {"n", kNumDocuments / kNumGroups / 2}}));
+        }
+    }
+}
+
+TEST_F(ParallelAggregationTest, LocalExchangeGroupsMissingKeysTogether) {
+    internalQueryLocalExchangeConsumers.store(2);
+
+    // No document has the field 'missing', so all of them belong to the group null.
+    auto pipeline = makeCountPipeline("$missing");
+    ASSERT(isLocalExchange(pipeline.get()));
+    auto results = getAllResults(pipeline.get());
+    ASSERT_EQ(results.size(), 1UL);
+    ASSERT_DOCUMENT_EQ(results[0], (Document{{"_id", BSONNULL}, {"n", kNumDocuments}}));
+}
+
+TEST_F(ParallelAggregationTest, LocalExchangeReturnsConsumerErrors) {
+    internalQueryLocalExchangeConsumers.store(2);
+    auto pipeline = makePipeline({BSON(
+        "$group" << BSON("_id"
+                         << "$a"
+                         << "n" << BSON("$sum" << BSON("$divide" << BSON_ARRAY(1 << "$zero")))))});
+    ASSERT(isLocalExchange(pipeline.get()));
+
+    // Dividing by zero fails in the $group run by the consumers.
+    ASSERT_THROWS_CODE(pipeline->getNext(), AssertionException, 16608);
+    pipeline->dispose(opCtx());
+}
+
+TEST_F(ParallelAggregationTest, DisposeBeforeExhaustingLocalExchangeStopsWorkers) {
+    internalQueryLocalExchangeConsumers.store(2);
+
+    // Grouping by _id makes the consumers produce more groups than they may buffer.
+    auto pipeline = makeCountPipeline("$_id");
+    ASSERT(isLocalExchange(pipeline.get()));
+    ASSERT(pipeline->getNext());
+    pipeline->dispose(opCtx());
+
+    // The workers no longer hold any lock on the collection.
+    AutoGetCollection autoColl(opCtx(), nss, MODE_X);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -47,10 +47,12 @@
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/plan_executor.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/fail_point.h"
+#include "mongo/util/scopeguard.h"
 
 namespace query_stage_collection_scan {
 
@@ -425,4 +427,121 @@ TEST_F(QueryStageCollectionScanTest, QueryTestCollscanResumeAfterRecordIdSeekFai
     ASSERT_EQUALS(PlanStage::FAILURE, ps->work(&id));
 }
 
+// Verify that workBatch() returns the same documents in the same order as work(). Unless the
+// record store keeps unowned data valid until the scan is saved, every result handed out before
+// the last one in a batch must also own its document.
+TEST_F(QueryStageCollectionScanTest, QueryStageCollscanWorkBatchWithMatch) {
+    AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+    auto collection = ctx.getCollection();
+    const bool resultsMayBeUnowned = collection->getCursor(&_opCtx)->unownedDataValidUntilSave();
+
+    CollectionScanParams params;
+    params.direction = CollectionScanParams::FORWARD;
+    params.tailable = false;
+
+    const boost::intrusive_ptr<ExpressionContext> expCtx(
+        new ExpressionContext(&_opCtx, nullptr, nss));
+    auto statusWithMatcher =
+        MatchExpressionParser::parse(BSON("foo" << BSON("$mod" << BSON_ARRAY(2 << 0))), expCtx);
+    ASSERT_OK(statusWithMatcher.getStatus());
+    auto filterExpr = std::move(statusWithMatcher.getValue());
+
+    WorkingSet ws;
+    auto scan =
+        std::make_unique<CollectionScan>(&_opCtx, collection, params, &ws, filterExpr.get());
+
+    int count = 0;
+    PlanStage::StageState state = PlanStage::NEED_TIME;
+    while (PlanStage::IS_EOF != state) {
+        std::vector<WorkingSetID> results;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        state = scan->workBatch(7, &results, &id);
+        ASSERT_NE(PlanStage::FAILURE, state);
+        ASSERT_LTE(results.size(), 7U);
+        if (PlanStage::ADVANCED == state) {
+            ASSERT_FALSE(results.empty());
+        } else if (PlanStage::NEED_TIME == state) {
+            ASSERT_TRUE(results.empty());
+        }
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            WorkingSetMember* member = ws.get(results[i]);
+            ASSERT_TRUE(member->hasObj());
+            if (!resultsMayBeUnowned && i + 1 < results.size()) {
+                ASSERT_TRUE(member->doc.value().isOwned());
+            }
+            ASSERT_EQUALS(count * 2, member->doc.value()["foo"].getInt());
+            ws.free(results[i]);
+            ++count;
+        }
+    }
+
+    ASSERT_EQUALS(numObj() / 2, count);
+    ASSERT_EQUALS(static_cast<size_t>(numObj() / 2), scan->getCommonStats()->advanced);
+}
+
+// Verify that a PlanExecutor which pulls results in batches returns the same results as one which
+// works its root one result at a time.
+TEST_F(QueryStageCollectionScanTest, QueryStageCollscanBatchedExecution) {
+    const int originalBatchSize = internalQueryExecBatchSize.load();
+    internalQueryExecBatchSize.store(16);
+    ON_BLOCK_EXIT([&] { internalQueryExecBatchSize.store(originalBatchSize); });
+
+    ASSERT_EQUALS(numObj(), countResults(CollectionScanParams::FORWARD, BSONObj()));
+    ASSERT_EQUALS(25,
+                  countResults(CollectionScanParams::BACKWARD, BSON("foo" << BSON("$lt" << 25))));
+}
+
+// Verify that saving a PlanExecutor which pulls results in batches makes the results it has not
+// handed out yet own their documents, whether or not the scan produced them owned.
+TEST_F(QueryStageCollectionScanTest, QueryStageCollscanBatchedExecutionSaveOwnsPendingResults) {
+    const int originalBatchSize = internalQueryExecBatchSize.load();
+    internalQueryExecBatchSize.store(16);
+    ON_BLOCK_EXIT([&] { internalQueryExecBatchSize.store(originalBatchSize); });
+
+    AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+    auto collection = ctx.getCollection();
+
+    CollectionScanParams params;
+    params.direction = CollectionScanParams::FORWARD;
+    params.tailable = false;
+
+    unique_ptr<WorkingSet> ws = std::make_unique<WorkingSet>();
+    WorkingSet* workingSet = ws.get();
+    unique_ptr<PlanStage> ps =
+        std::make_unique<CollectionScan>(&_opCtx, collection, params, ws.get(), nullptr);
+    auto statusWithPlanExecutor = PlanExecutor::make(
+        &_opCtx, std::move(ws), std::move(ps), collection, PlanExecutor::NO_YIELD);
+    ASSERT_OK(statusWithPlanExecutor.getStatus());
+    auto exec = std::move(statusWithPlanExecutor.getValue());
+
+    // Pull one batch of 16 results and hand out the first of them.
+    BSONObj obj;
+    ASSERT_EQUALS(PlanExecutor::ADVANCED, exec->getNext(&obj, nullptr));
+    ASSERT_EQUALS(0, obj["foo"].numberInt());
+
+    exec->saveState();
+
+    // The batch allocated the first 16 working set members, and only the one handed out is free.
+    size_t numPending = 0;
+    for (WorkingSetID id = 0; id < 16; ++id) {
+        if (workingSet->isFree(id)) {
+            continue;
+        }
+        WorkingSetMember* member = workingSet->get(id);
+        ASSERT_TRUE(member->hasObj());
+        ASSERT_TRUE(member->doc.value().isOwned());
+        ++numPending;
+    }
+    ASSERT_EQUALS(15U, numPending);
+
+    exec->restoreState();
+    int count = 1;
+    while (PlanExecutor::ADVANCED == exec->getNext(&obj, nullptr)) {
+        ASSERT_EQUALS(count, obj["foo"].numberInt());
+        ++count;
+    }
+    ASSERT_EQUALS(numObj(), count);
+}
+
 }  // namespace query_stage_collection_scan
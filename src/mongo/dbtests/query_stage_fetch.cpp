@@ -46,7 +46,9 @@
 #include "mongo/db/exec/queued_data_stage.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/dbtests/dbtests.h"
+#include "mongo/util/scopeguard.h"
 
 namespace QueryStageFetch {
 
@@ -226,6 +228,69 @@ public:
     }
 };
 
+//
+// Test that prefetching the records of each child batch doesn't change what fetch returns.
+//
+class FetchStagePrefetch : public QueryStageFetchBase {
+public:
+    void run() {
+        const int oldMinRecords = internalQueryFetchPrefetchMinRecords.load();
+        internalQueryFetchPrefetchMinRecords.store(1);
+        ON_BLOCK_EXIT([&] { internalQueryFetchPrefetchMinRecords.store(oldMinRecords); });
+
+        dbtests::WriteContextForTests ctx(&_opCtx, ns());
+        Database* db = ctx.db();
+        Collection* coll =
+            CollectionCatalog::get(&_opCtx).lookupCollectionByNamespace(&_opCtx, nss());
+        if (!coll) {
+            WriteUnitOfWork wuow(&_opCtx);
+            coll = db->createCollection(&_opCtx, nss());
+            wuow.commit();
+        }
+
+        WorkingSet ws;
+
+        for (int i = 0; i < 5; ++i) {
+            insert(BSON("foo" << i));
+        }
+        set<RecordId> recordIds;
+        getRecordIds(&recordIds, coll);
+        ASSERT_EQUALS(size_t(5), recordIds.size());
+
+        // A record deleted after its id was produced is both prefetched and skipped.
+        remove(BSON("foo" << 2));
+
+        // Create a mock stage that returns the ids of every record, deleted or not.
+        auto mockStage = std::make_unique<QueuedDataStage>(&_opCtx, &ws);
+        for (auto&& recordId : recordIds) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* mockMember = ws.get(id);
+            mockMember->recordId = recordId;
+            ws.transitionToRecordIdAndIdx(id);
+            mockStage->pushBack(id);
+        }
+
+        auto fetchStage =
+            std::make_unique<FetchStage>(&_opCtx, &ws, std::move(mockStage), nullptr, coll);
+
+        BSONArrayBuilder foos;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (PlanStage::IS_EOF != state) {
+            std::vector<WorkingSetID> results;
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            state = fetchStage->workBatch(16, &results, &id);
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            ASSERT_NOT_EQUALS(PlanStage::NEED_YIELD, state);
+            for (auto result : results) {
+                foos.append(ws.get(result)->doc.value()["foo"].getInt());
+                ws.free(result);
+            }
+        }
+
+        ASSERT_BSONOBJ_EQ(BSON_ARRAY(0 << 1 << 3 << 4), foos.arr());
+    }
+};
+
 class All : public OldStyleSuiteSpecification {
 public:
     All() : OldStyleSuiteSpecification("query_stage_fetch") {}
@@ -233,6 +298,7 @@ public:
     void setupTests() {
         add<FetchStageAlreadyFetched>();
         add<FetchStageFilter>();
+        add<FetchStagePrefetch>();
     }
 };
 
@@ -32,6 +32,7 @@
 #ifdef _WIN32
 #include "mongo/platform/windows_basic.h"
 #else
+#include <cerrno>
 #include <pthread.h>
 #endif
 
@@ -63,6 +64,9 @@ public:
     void lock() {
         EnterCriticalSection(&_cs);
     }
+    bool try_lock() {
+        return TryEnterCriticalSection(&_cs);
+    }
     void unlock() {
         LeaveCriticalSection(&_cs);
     }
@@ -90,6 +94,12 @@ public:
         verify(pthread_mutex_lock(&_lock) == 0);
     }
 
+    bool try_lock() {
+        int ret = pthread_mutex_trylock(&_lock);
+        verify(ret == 0 || ret == EBUSY);
+        return ret == 0;
+    }
+
     void unlock() {
         verify(pthread_mutex_unlock(&_lock) == 0);
     }
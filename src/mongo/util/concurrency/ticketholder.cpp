@@ -35,12 +35,49 @@
 
 #include <iostream>
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/logv2/log.h"
 #include "mongo/util/log.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
+template <typename Wait>
+auto TicketHolder::_waitWhileQueued(Wait&& wait) {
+    _numQueued.fetchAndAdd(1);
+    Timer timer;
+    ON_BLOCK_EXIT([&] {
+        _numQueued.subtractAndFetch(1);
+        _totalQueued.fetchAndAdd(1);
+        _totalTimeQueuedMicros.fetchAndAdd(timer.micros());
+    });
+    return wait();
+}
+
+void TicketHolder::waitForTicket(OperationContext* opCtx) {
+    if (tryAcquire())
+        return;
+    _waitWhileQueued([&] { _waitForTicket(opCtx); });
+}
+
+bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
+    // Only operations that cannot get a ticket straight away count as queued.
+    if (tryAcquire())
+        return true;
+    return _waitWhileQueued([&] { return _waitForTicketUntil(opCtx, until); });
+}
+
+void TicketHolder::appendStats(BSONObjBuilder& b) const {
+    b.append("out", used());
+    b.append("available", available());
+    b.append("totalTickets", outof());
+    b.append("queued", _numQueued.load());
+    b.append("totalQueued", _totalQueued.load());
+    b.append("totalTimeQueuedMicros", _totalTimeQueuedMicros.load());
+}
+
 #if defined(__linux__)
 namespace {
 
@@ -91,11 +128,11 @@ bool TicketHolder::tryAcquire() {
     return true;
 }
 
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
-    waitForTicketUntil(opCtx, Date_t::max());
+void TicketHolder::_waitForTicket(OperationContext* opCtx) {
+    _waitForTicketUntil(opCtx, Date_t::max());
 }
 
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
+bool TicketHolder::_waitForTicketUntil(OperationContext* opCtx, Date_t until) {
     const Milliseconds intervalMs(500);
     struct timespec ts;
 
@@ -181,7 +218,7 @@ bool TicketHolder::tryAcquire() {
     return _tryAcquire();
 }
 
-void TicketHolder::waitForTicket(OperationContext* opCtx) {
+void TicketHolder::_waitForTicket(OperationContext* opCtx) {
     stdx::unique_lock<Latch> lk(_mutex);
 
     if (opCtx) {
@@ -191,7 +228,7 @@ void TicketHolder::waitForTicket(OperationContext* opCtx) {
     }
 }
 
-bool TicketHolder::waitForTicketUntil(OperationContext* opCtx, Date_t until) {
+bool TicketHolder::_waitForTicketUntil(OperationContext* opCtx, Date_t until) {
     stdx::unique_lock<Latch> lk(_mutex);
 
     if (opCtx) {
@@ -41,6 +41,8 @@
 
 namespace mongo {
 
+class BSONObjBuilder;
+
 class TicketHolder {
     TicketHolder(const TicketHolder&) = delete;
     TicketHolder& operator=(const TicketHolder&) = delete;
@@ -82,7 +84,30 @@ public:
 
     int outof() const;
 
+    /**
+     * Appends the ticket counts along with statistics about operations that had to queue for a
+     * ticket: how many are queued now, how many have queued in total, and how long they waited.
+     */
+    void appendStats(BSONObjBuilder& b) const;
+
 private:
+    /**
+     * Runs 'wait', which blocks until a ticket is acquired or times out, while counting the
+     * caller as queued. Returns the result of 'wait'.
+     */
+    template <typename Wait>
+    auto _waitWhileQueued(Wait&& wait);
+
+    void _waitForTicket(OperationContext* opCtx);
+    bool _waitForTicketUntil(OperationContext* opCtx, Date_t until);
+
+    // Number of operations currently waiting for a ticket.
+    AtomicWord<int> _numQueued;
+
+    // Number of times an operation had to wait for a ticket, and the total time spent waiting.
+    AtomicWord<long long> _totalQueued;
+    AtomicWord<long long> _totalTimeQueuedMicros;
+
 #if defined(__linux__)
     mutable sem_t _sem;
 
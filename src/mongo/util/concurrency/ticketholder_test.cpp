@@ -32,6 +32,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
@@ -72,4 +73,30 @@ TEST(TicketholderTest, BasicTimeout) {
     holder.release();
     ASSERT_EQ(holder.used(), 0);
 }
+
+TEST(TicketholderTest, QueueStats) {
+    TicketHolder holder(1);
+    auto stats = [&] {
+        BSONObjBuilder b;
+        holder.appendStats(b);
+        return b.obj();
+    };
+
+    // Acquiring an available ticket does not queue.
+    holder.waitForTicket();
+    ASSERT_EQ(stats()["out"].numberInt(), 1);
+    ASSERT_EQ(stats()["totalQueued"].numberLong(), 0);
+
+    // Timing out while waiting for a ticket still counts as having queued.
+    ASSERT_FALSE(holder.waitForTicketUntil(Date_t::now() + Milliseconds(10)));
+    auto afterTimeout = stats();
+    ASSERT_EQ(afterTimeout["queued"].numberInt(), 0);
+    ASSERT_EQ(afterTimeout["totalQueued"].numberLong(), 1);
+    ASSERT_GTE(afterTimeout["totalTimeQueuedMicros"].numberLong(), 0);
+
+    holder.release();
+    ASSERT_EQ(stats()["out"].numberInt(), 0);
+    ASSERT_EQ(stats()["available"].numberInt(), 1);
+    ASSERT_EQ(stats()["totalTickets"].numberInt(), 1);
+}
 }  // namespace